@@ -8,7 +8,7 @@
 
 #define CLIENT_VERSION_MAJOR	1
 #define CLIENT_VERSION_MINOR	5
-#define CLIENT_VERSION_PATCH	3
+#define CLIENT_VERSION_PATCH	4
 
 /*
  * This value specifys the suffix to the version info sent to the metaserver.
@@ -596,6 +596,21 @@ int recv_undef(connection_type *ct) {
 
 }
 
+/* Everything after this packet is deflated */
+int recv_compress(connection_type *ct) {
+	byte level = 0;
+
+	if (cq_scanf(&ct->rbuf, "%c", &level) < 1) return 0;
+
+	if (!conn_inflate_start(ct))
+	{
+		plog("Can't decompress server data!");
+		return -1;
+	}
+
+	return 1;
+}
+
 /* Keepalive packet "handler" */
 int recv_keepalive(connection_type *ct) {
 
@@ -1311,6 +1326,46 @@ int read_stream_char(byte st, byte addr, bool trn, bool mem, s16b y, s16b x)
 
 	return 1;
 }
+/* Read a run of "n" grids of row "y", starting at "x" */
+int read_stream_span(connection_type *ct, byte st, byte addr, s16b y)
+{
+	stream_type	*stream = &streams[st];
+	cave_view_type	tiles[256], trn[256];
+	cave_view_type	*dest = stream_cave(st, y);
+	bool	mem = !(stream->flag & SF_OVERLAYED);
+	byte	x = 0, n = 0;
+	int	i;
+
+	if (cq_scanf(&ct->rbuf, "%c%c", &x, &n) < 2) return 0;
+
+	if (verify_stream_y(st, y)) return -1;
+	if (verify_stream_x(st, x + n - 1)) return -1;
+
+	/* Decode the secondary attr/char stream */
+	if (stream->flag & SF_TRANSPARENT)
+	{
+		if (cq_scanc(&ct->rbuf, stream->rle, trn, n) < n) return 0;
+	}
+	else caveclr(trn, n);
+
+	/* Decode the attr/char stream */
+	if (cq_scanc(&ct->rbuf, stream->rle, tiles, n) < n) return 0;
+
+	/* Treat them as that many single grids */
+	for (i = 0; i < n; i++)
+	{
+		dest[x + i].a = tiles[i].a;
+		dest[x + i].c = tiles[i].c;
+
+		if (addr == NTERM_WIN_OVERHEAD)
+			show_char(y, x + i, tiles[i].a, tiles[i].c, trn[i].a, trn[i].c, mem);
+	}
+
+	if (y > last_remote_line[addr])
+		last_remote_line[addr] = y;
+
+	return 1;
+}
 int recv_stream(connection_type *ct) {
 	u16b	cols, y = 0;
 	s16b	*line;
@@ -1335,6 +1390,9 @@ int recv_stream(connection_type *ct) {
 		read_stream_char(id, addr, (stream->flag & SF_TRANSPARENT), !(stream->flag & SF_OVERLAYED),
 		((y >> 8) & 0x007F), (y & 0xFF));
 
+	/* A run of grids (see "stream_span()" on the server) */
+	if (y & 0x4000) return read_stream_span(ct, id, addr, (y & 0x3FFF));
+
 	if (verify_stream_y(id, y)) return -1;
 
 	cols = p_ptr->stream_wid[id];
@@ -1350,8 +1408,12 @@ int recv_stream(connection_type *ct) {
 	else if (stream->flag & SF_OVERLAYED)
 		caveclr(p_ptr->trn_info[y], cols);
 
-	/* Decode the attr/char stream */
-	if (cq_scanc(&ct->rbuf, stream->rle, dest, cols) < cols) return 0;
+	/* Decode the attr/char stream (as changes to what we have) */
+	if (stream->rle & RLE_DELTA)
+	{
+		if (cq_scanc_delta(&ct->rbuf, stream->rle, dest, (y ? dest - cols : NULL), cols) < cols) return 0;
+	}
+	else if (cq_scanc(&ct->rbuf, stream->rle, dest, cols) < cols) return 0;
 
 	/* Check the min/max line count */
 	if ((*line) < y)
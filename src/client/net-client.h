@@ -7,6 +7,7 @@
 	PACKET(PKT_KEEPALIVE,	"%l",   	recv_keepalive)
 	PACKET(PKT_PLAY,	"%c",   	recv_play)
 	PACKET(PKT_QUIT,	"%S",   	recv_quit)
+	PACKET(PKT_COMPRESS,	"%c",   	recv_compress)
 	PACKET(PKT_BASIC_INFO,	NULL,   	recv_basic_info)
 	PACKET(PKT_CHAR_INFO,	"%d%d%d%d",	recv_char_info)
 	PACKET(PKT_STRUCT_INFO,	NULL,   	recv_struct_info)
@@ -131,6 +131,11 @@
 
 #define MAX_FLVR_IDX	330 /* Max size for flv_x_char[]/attr[] */
 
+/*
+ * Number of 32-bit words needed to hold one bit per entity
+ */
+#define BIT_WORDS(N)	(((N) + 31) / 32)
+
 /*
  * Number of tval/min-sval/max-sval slots per ego_item
  */
@@ -207,6 +212,12 @@
  */
 #define QUARK_MAX	5656
 
+/*
+ * OPTION: Size of the "quark" hash index (see "quark_add()")
+ * Must be a power of two, and at least twice "QUARK_MAX"
+ */
+#define QUARK_HASH	16384
+
 /*
  * OPTION: Maximum number of messages to remember (see "io.c")
  * Default: assume maximal memorization of 2048 total messages
@@ -238,6 +249,7 @@
 #define RLE_CLASSIC 1
 #define RLE_LARGE 2
 #define RLE_COLOR 3
+#define RLE_DELTA 0x80	/* Flag: lines are sent as changes, see cq_printc_delta() */
 
 /*
  * Party commands
@@ -864,6 +876,8 @@
 # define MACRO_MAX	128
 # undef QUARK_MAX
 # define QUARK_MAX	128
+# undef QUARK_HASH
+# define QUARK_HASH	256
 # undef MESSAGE_MAX
 # define MESSAGE_MAX	128
 # undef MESSAGE_BUF
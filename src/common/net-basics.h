@@ -3,6 +3,7 @@
 
 #define PD_SMALL_BUFFER 	1024 * 4
 #define PD_LARGE_BUFFER 	1024 * 32
+#define PD_HIGH_WATER   	(PD_LARGE_BUFFER / 4) /* Queued output considered a backlog */
 #define MATH_MAX(A,B) (A > B ? A : B)
 
 /** Defenitions **/
@@ -23,6 +23,7 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "angband.h"
+#include "../client/lupng/miniz.h"
 
 //TODO: Wrap those into configure.ac!!
 #ifdef WINDOWS
@@ -61,6 +62,18 @@
 #define closesocket close
 #endif
 
+/* Readiness-driven polling is available */
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_EPOLL_CREATE1)
+#define USE_EPOLL
+#include <sys/epoll.h>
+#define NET_MAX_EVENTS 256
+#endif
+
+/* Host names can be resolved in the background */
+#if defined(HAVE_PTHREAD_H) && defined(HAVE_LIBPTHREAD) && !defined(WINDOWS)
+#define USE_RESOLVER_THREAD
+#include <pthread.h>
+#endif
 
 fd_set rd;
 fd_set wd;
@@ -73,8 +86,53 @@ int refds;
 fd_set* get_fd_set() { return &rd; }
 int* get_fd_counter() { return &refds; }
 
+network_stats net_stats;
+
+#ifdef USE_EPOLL
+int epoll_fd = -1;
+
+/* Ask "network_pause" to report readiness of "fd" into "ready" */
+static void net_watch(int fd, int *ready, int events) {
+	struct epoll_event ev;
+	if (epoll_fd == -1) return;
+	ev.events = events;
+	ev.data.ptr = ready;
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+	net_stats.ctls++;
+}
+/* Change which "events" are reported for "fd" */
+static void net_rewatch(int fd, int *ready, int events) {
+	struct epoll_event ev;
+	if (epoll_fd == -1) return;
+	ev.events = events;
+	ev.data.ptr = ready;
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+	net_stats.ctls++;
+}
+/* Stop reporting "fd"; must precede closing it, as a forked child
+ * holding a copy of the descriptor keeps the registration alive */
+static void net_unwatch(int fd) {
+	struct epoll_event ev;
+	if (epoll_fd == -1) return;
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+	net_stats.ctls++;
+}
+/* Without epoll, every descriptor is assumed ready on every pass */
+#define NET_READY(R, E) (epoll_fd == -1 || ((R) & ((E) | EPOLLERR | EPOLLHUP)))
+#define NET_IN EPOLLIN
+#define NET_OUT EPOLLOUT
+#else
+#define net_watch(FD, R, E)
+#define net_rewatch(FD, R, E)
+#define net_unwatch(FD)
+#define NET_READY(R, E) (TRUE)
+#define NET_IN 0
+#define NET_OUT 0
+#endif
+
 struct sender_type {
 	struct sockaddr_in addr;
+	cptr host; /* resolved again as the cached answer expires */
 	int send_fd;
 	micro interval;
 	micro delay;
@@ -86,28 +144,198 @@ struct caller_type {
 	struct sockaddr_in addr;
 	int port;
 	int caller_fd;
+	int ready;
 	int remove;
 	callback connect_cb;
 	callback failure_cb; /* return 1 to try again */
 };
 
-eptr add_sender(eptr root, char *host, int port, micro interval, callback send_cb) {
-	struct sender_type *new_s;
+/*
+ * Name resolution.
+ *
+ * Senders resolve their host on a worker thread, so a slow resolver never
+ * stalls the main loop: until the answer arrives their output just stays
+ * queued.  Answers are cached for RESOLVE_TTL seconds and then refreshed
+ * in the background, still using the old address meanwhile.  Failures are
+ * retried after RESOLVE_FAIL_TTL seconds.  Callers (whose users wait for
+ * the connection anyway) resolve on the spot, but share the cache.
+ */
+#define RESOLVE_MAX	8
+#define RESOLVE_HOST_LEN	256 /* Longest DNS name, plus the '\0' */
+#define RESOLVE_TTL	600
+#define RESOLVE_FAIL_TTL	30
+
+#define RESOLVE_PENDING	0
+#define RESOLVE_OK	1
+#define RESOLVE_FAILED	-1
+
+struct resolve_entry {
+	char host[RESOLVE_HOST_LEN];
+	struct in_addr addr;
+	int state;      /* RESOLVE_PENDING, RESOLVE_OK or RESOLVE_FAILED */
+	time_t expires; /* When to ask again */
+	time_t used;    /* Last looked up, to pick a slot to recycle */
+	int queued;     /* Waiting for the worker */
+};
+
+static struct resolve_entry resolve_cache[RESOLVE_MAX];
+static int resolve_num = 0;
+
+#ifdef USE_RESOLVER_THREAD
+static pthread_mutex_t resolve_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t resolve_wake = PTHREAD_COND_INITIALIZER;
+static int resolve_started = 0;
+#endif
+
+/* Ask the system resolver about "host" (blocking), return 1 on success */
+static int resolve_now(const char *host, struct in_addr *addr) {
+#ifdef USE_RESOLVER_THREAD
+	/* Must be thread-safe */
+	struct addrinfo hints, *res;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	if (getaddrinfo(host, NULL, &hints, &res) || !res) return 0;
+	*addr = ((struct sockaddr_in *)res->ai_addr)->sin_addr;
+	freeaddrinfo(res);
+#else
 	struct hostent *hp;
-	int senderfd;
+	if ((hp = gethostbyname(host)) == NULL) return 0;
+	memcpy(addr, hp->h_addr, sizeof(*addr));
+#endif
+	return 1;
+}
 
-	/* Resolve host into "hp" */
-	if ((hp = gethostbyname(host)) == NULL)
-	{
-		/* plog("NAME RESOLUTION FAILED") */
-		return (NULL);
+/* Remember an answer for "re" */
+static void resolve_store(struct resolve_entry *re, int ok, struct in_addr *addr) {
+	re->queued = 0;
+	if (ok) {
+		re->addr = *addr;
+		re->state = RESOLVE_OK;
+		re->expires = time(NULL) + RESOLVE_TTL;
+		return;
 	}
+	/* A failed refresh keeps the old address */
+	if (re->state != RESOLVE_OK) re->state = RESOLVE_FAILED;
+	re->expires = time(NULL) + RESOLVE_FAIL_TTL;
+}
+
+#ifdef USE_RESOLVER_THREAD
+/* Resolve queued entries, forever */
+static void *resolve_worker(void *unused) {
+	char host[RESOLVE_HOST_LEN];
+	struct in_addr addr;
+	int i, ok;
+	pthread_mutex_lock(&resolve_lock);
+	while (1) {
+		for (i = 0; i < resolve_num; i++)
+			if (resolve_cache[i].queued) break;
+		if (i == resolve_num) {
+			pthread_cond_wait(&resolve_wake, &resolve_lock);
+			continue;
+		}
+		/* Queued entries are never recycled, so "i" stays ours */
+		my_strcpy(host, resolve_cache[i].host, sizeof(host));
+		pthread_mutex_unlock(&resolve_lock);
+		ok = resolve_now(host, &addr);
+		pthread_mutex_lock(&resolve_lock);
+		resolve_store(&resolve_cache[i], ok, &addr);
+	}
+	return NULL;
+}
+#endif
+
+/* Find (or make) the cache entry for "host", NULL if the cache is busy */
+static struct resolve_entry *resolve_entry_for(const char *host) {
+	struct resolve_entry *re = NULL;
+	int i;
+	for (i = 0; i < resolve_num; i++)
+		if (!strcmp(resolve_cache[i].host, host)) return &resolve_cache[i];
+	if (resolve_num < RESOLVE_MAX) re = &resolve_cache[resolve_num++];
+	else for (i = 0; i < RESOLVE_MAX; i++) {
+		/* Recycle the least recently used idle entry */
+		if (resolve_cache[i].queued) continue;
+		if (!re || resolve_cache[i].used < re->used) re = &resolve_cache[i];
+	}
+	if (!re) return NULL;
+	WIPE(re, struct resolve_entry);
+	my_strcpy(re->host, host, sizeof(re->host));
+	return re;
+}
+
+/*
+ * Look "host" up in the cache and put its address into "addr".
+ * Return 1 when there is an address, -1 if "host" can't be resolved,
+ * 0 while waiting for the worker.  With "wait", never returns 0.
+ */
+static int resolve_host(const char *host, struct in_addr *addr, bool wait) {
+	struct resolve_entry *re;
+	struct in_addr tmp;
+	int state = RESOLVE_PENDING, stale = 1, ok;
+	time_t now = time(NULL);
+
+	/* Not a host name */
+	if (strlen(host) >= RESOLVE_HOST_LEN) return -1;
+
+#ifdef USE_RESOLVER_THREAD
+	pthread_mutex_lock(&resolve_lock);
+#endif
+	if ((re = resolve_entry_for(host)) != NULL) {
+		re->used = now;
+		stale = (re->state == RESOLVE_PENDING || now >= re->expires);
+		/* New or stale, ask again in the background */
+		if (stale && !re->queued && !wait) {
+			net_stats.resolves++;
+#ifdef USE_RESOLVER_THREAD
+			re->queued = 1;
+			if (!resolve_started) {
+				pthread_t thread;
+				if (!pthread_create(&thread, NULL, resolve_worker, NULL)) {
+					pthread_detach(thread);
+					resolve_started = 1;
+				}
+			}
+			if (resolve_started) pthread_cond_signal(&resolve_wake);
+			else
+#endif
+			resolve_store(re, resolve_now(host, &tmp), &tmp);
+		}
+		state = re->state;
+		if (state == RESOLVE_OK) *addr = re->addr;
+	}
+#ifdef USE_RESOLVER_THREAD
+	pthread_mutex_unlock(&resolve_lock);
+#endif
+
+	/* Resolve on the spot */
+	if (wait && stale) {
+		net_stats.resolves++;
+		ok = resolve_now(host, &tmp);
+#ifdef USE_RESOLVER_THREAD
+		pthread_mutex_lock(&resolve_lock);
+#endif
+		/* The entry may have been recycled meanwhile */
+		if (re && !re->queued && !strcmp(re->host, host)) resolve_store(re, ok, &tmp);
+#ifdef USE_RESOLVER_THREAD
+		pthread_mutex_unlock(&resolve_lock);
+#endif
+		if (ok) *addr = tmp;
+		/* A stale address is better than none */
+		else if (state != RESOLVE_OK) return -1;
+		return 1;
+	}
+
+	return (state == RESOLVE_OK ? 1 : (state == RESOLVE_FAILED ? -1 : 0));
+}
+
+eptr add_sender(eptr root, char *host, int port, micro interval, callback send_cb) {
+	struct sender_type *new_s;
+	int senderfd;
 
 	/* Init socket */
 	senderfd = socket(AF_INET, SOCK_DGRAM, 0);
 
 	/* Set to non-blocking. */
-	//unblockfd(callerfd);
+	unblockfd(senderfd);
 
 	/* Allocate memory */
 	new_s = (struct sender_type*) RNEW(struct sender_type);
@@ -115,7 +343,10 @@ eptr add_sender(eptr root, char *host, int port, micro interval, callback send_c
 	/* Set addr and others */
 	new_s->addr.sin_family = AF_INET;
 	new_s->addr.sin_port = htons(port);
-	memcpy (&(new_s->addr.sin_addr), hp->h_addr, sizeof(new_s->addr.sin_addr));
+	new_s->host = string_make(host);
+
+	/* Start resolving, "handle_senders" picks the answer up */
+	resolve_host(host, &new_s->addr.sin_addr, FALSE);
 
 	new_s->send_fd = senderfd;
 	new_s->send_cb = send_cb;
@@ -129,11 +360,11 @@ eptr add_sender(eptr root, char *host, int port, micro interval, callback send_c
 
 eptr add_caller(eptr root, char *host, int port, callback conn_cb, callback fail_cb) {
 	struct caller_type *new_c;
-	struct hostent *hp;
+	struct in_addr addr;
 	int callerfd;
 
 	/* Resolve addr */
-	if ((hp = gethostbyname(host)) == NULL)
+	if (resolve_host(host, &addr, TRUE) < 0)
 	{
 		/* plog("NAME RESOLUTION FAILED") */
 		return (NULL);
@@ -151,16 +382,19 @@ eptr add_caller(eptr root, char *host, int port, callback conn_cb, callback fail
 	/* Set addr and others */
 	new_c->addr.sin_family = AF_INET;
 	new_c->addr.sin_port = htons(port);
-	memcpy (&(new_c->addr.sin_addr), hp->h_addr, sizeof(new_c->addr.sin_addr));
+	new_c->addr.sin_addr = addr;
 
 	new_c->port = port;
 	new_c->connect_cb = conn_cb;
 	new_c->failure_cb = fail_cb;
 	new_c->caller_fd = callerfd;
 	new_c->remove = 0; /* important */
+	new_c->ready = 0;
 
 	crfds = MATH_MAX(crfds, callerfd);
 
+	net_watch(callerfd, &new_c->ready, NET_OUT);
+
 	/* Add to list */
 	return e_add(root, NULL, new_c);
 }
@@ -211,6 +445,9 @@ eptr add_listener(eptr root, int port, callback cb) {
 	new_l->port = port;
 	new_l->accept_cb = cb;
 	new_l->listen_fd = listenfd;
+	new_l->ready = 0;
+
+	net_watch(listenfd, &new_l->ready, NET_IN);
 
 	/* Add to list */
 	return e_add(root, NULL, new_l);
@@ -229,8 +466,19 @@ eptr add_connection(eptr root, int fd, callback read, callback close) {
 	new_c->close_cb = close;
 	new_c->close = 0;
 	new_c->uptr = NULL;
+	new_c->ready = 0;
+	new_c->wbuf_peak = 0;
+	new_c->stalled = 0;
 	cq_init(&new_c->wbuf, PD_LARGE_BUFFER);
 	cq_init(&new_c->rbuf, PD_LARGE_BUFFER);
+	new_c->zout = new_c->zin = NULL;
+	new_c->zflush = 0;
+	WIPE(&new_c->zwbuf, cq);
+	WIPE(&new_c->zrbuf, cq);
+	new_c->z_plain = new_c->z_packed = 0;
+	new_c->z_usec = 0;
+
+	net_watch(fd, &new_c->ready, NET_IN);
 
 	if (getpeername(fd, (struct sockaddr *) &sin, &len) >= 0)
 	{
@@ -261,11 +509,139 @@ eptr add_timer(eptr root, int interval, callback timeout) {
 	return e_add(root, NULL, new_t);
 }
 
+/*
+ * Compressed connections.
+ *
+ * After "conn_deflate_start", everything queued to "wbuf" is deflated
+ * into "zwbuf" on each write pass (ending with a sync flush, so the other
+ * side can decode all it has got), and "zwbuf" is what goes to the socket.
+ * The other side must call "conn_inflate_start" at the same point of the
+ * stream, after which received bytes go to "zrbuf" and are inflated into
+ * "rbuf" as there's room for them.
+ */
+bool conn_deflate_start(connection_type *ct, int level) {
+	mz_stream *zs;
+
+	if (ct->zout || ct->zin) return FALSE;
+
+	zs = RNEW(mz_stream);
+	WIPE(zs, mz_stream);
+	if (mz_deflateInit(zs, level) != MZ_OK)
+	{
+		FREE(zs);
+		return FALSE;
+	}
+	cq_init(&ct->zwbuf, PD_LARGE_BUFFER);
+
+	/* What is queued already goes out as is */
+	cq_nwrite(&ct->zwbuf, CQ_PEEK(&ct->wbuf), cq_len(&ct->wbuf));
+	CQ_CLEAR(&ct->wbuf);
+
+	ct->zout = zs;
+	return TRUE;
+}
+bool conn_inflate_start(connection_type *ct) {
+	mz_stream *zs;
+
+	if (ct->zout || ct->zin) return FALSE;
+
+	zs = RNEW(mz_stream);
+	WIPE(zs, mz_stream);
+	if (mz_inflateInit(zs) != MZ_OK)
+	{
+		FREE(zs);
+		return FALSE;
+	}
+	cq_init(&ct->zrbuf, PD_LARGE_BUFFER);
+
+	/* Whatever follows in the read buffer is deflated already */
+	cq_nwrite(&ct->zrbuf, CQ_PEEK(&ct->rbuf), cq_len(&ct->rbuf));
+	ct->rbuf.len = ct->rbuf.pos;
+
+	ct->zin = zs;
+	return TRUE;
+}
+static void conn_zip_end(connection_type *ct) {
+	if (ct->zout)
+	{
+		mz_deflateEnd(ct->zout);
+		FREE(ct->zout);
+		cq_free(&ct->zwbuf);
+	}
+	if (ct->zin)
+	{
+		mz_inflateEnd(ct->zin);
+		FREE(ct->zin);
+		cq_free(&ct->zrbuf);
+	}
+}
+/* Deflate "wbuf" into "zwbuf". Returns -1 on error */
+static int conn_deflate(connection_type *ct) {
+	mz_stream *zs = ct->zout;
+	int in, out, r;
+
+	cq_slide(&ct->zwbuf);
+	in = cq_len(&ct->wbuf);
+	out = cq_space(&ct->zwbuf);
+	if (!out) return 0;
+
+	static_timer(5);
+	zs->next_in = (unsigned char *)CQ_PEEK(&ct->wbuf);
+	zs->avail_in = in;
+	zs->next_out = (unsigned char *)&ct->zwbuf.buf[ct->zwbuf.len];
+	zs->avail_out = out;
+	r = mz_deflate(zs, MZ_SYNC_FLUSH);
+	if (r != MZ_OK && r != MZ_BUF_ERROR) return -1;
+
+	/* Ran out of room, there may be more to flush */
+	ct->zflush = (zs->avail_out ? 0 : 1);
+
+	in -= zs->avail_in;
+	out -= zs->avail_out;
+	ct->wbuf.pos += in;
+	if (ct->wbuf.pos == ct->wbuf.len) CQ_CLEAR(&ct->wbuf);
+	ct->zwbuf.len += out;
+	ct->z_plain += in;
+	ct->z_packed += out;
+	ct->z_usec += static_timer(5);
+	return out;
+}
+/* Inflate "zrbuf" into "rbuf". Returns bytes inflated, or -1 on error */
+static int conn_inflate(connection_type *ct) {
+	mz_stream *zs = ct->zin;
+	int in, out, r;
+
+	cq_slide(&ct->rbuf);
+	in = cq_len(&ct->zrbuf);
+	out = cq_space(&ct->rbuf);
+	if (!in || !out) return 0;
+
+	static_timer(5);
+	zs->next_in = (unsigned char *)CQ_PEEK(&ct->zrbuf);
+	zs->avail_in = in;
+	zs->next_out = (unsigned char *)&ct->rbuf.buf[ct->rbuf.len];
+	zs->avail_out = out;
+	r = mz_inflate(zs, MZ_SYNC_FLUSH);
+	if (r != MZ_OK && r != MZ_BUF_ERROR) return -1;
+
+	in -= zs->avail_in;
+	out -= zs->avail_out;
+	ct->zrbuf.pos += in;
+	if (ct->zrbuf.pos == ct->zrbuf.len) CQ_CLEAR(&ct->zrbuf);
+	else cq_slide(&ct->zrbuf);
+	ct->rbuf.len += out;
+	ct->z_packed += in;
+	ct->z_plain += out;
+	ct->z_usec += static_timer(5);
+	return out;
+}
+
 eptr handle_connections(eptr root) {
 	char mesg[PD_LARGE_BUFFER];
 	eptr iter;
-	int connfd, n, to_close = 0;
+	int connfd, n, z, stall, handled, to_close = 0;
 	struct connection_type *ct;
+	cq *in, *out;
 
 	for (iter=root; iter; iter=iter->next) {
 		ct = (connection_type*)iter->data2;
@@ -273,17 +649,20 @@ eptr handle_connections(eptr root) {
 
 		FD_SET(connfd, &rd);
 
-		/* /Connection is not yet closed/ */
-		if (!ct->close)
+		/* /Connection is not yet closed/ and has something for us */
+		if (!ct->close && NET_READY(ct->ready, NET_IN))
 		{
-			/* Receive */
+			ct->ready &= NET_OUT;
+			/* Receive (compressed input into its own queue) */
+			in = (ct->zin ? &ct->zrbuf : &ct->rbuf);
 			n = PD_LARGE_BUFFER;/* Paranoia */
-			n = MAX(1, MIN(cq_space(&ct->rbuf), PD_LARGE_BUFFER)); /* n = [1=>"bytes left in buffer"=>PD_LARGE_BUFFER] */
+			n = MAX(1, MIN(cq_space(in), PD_LARGE_BUFFER)); /* n = [1=>"bytes left in buffer"=>PD_LARGE_BUFFER] */
 			n = recvfrom(connfd, mesg, n, 0, NULL, 0);
+			net_stats.recvs++;
 			if (n > 0)
 			{
 				/* Got 'n' bytes */
-				n = cq_nwrite(&ct->rbuf, mesg, n);
+				n = cq_nwrite(in, mesg, n);
 				/* Error while filling buffer */
 				if (n <= 0) ct->close = 1;
 			}
@@ -291,20 +670,57 @@ eptr handle_connections(eptr root) {
 			else if (n == 0 || sockerr != EWOULDBLOCK) ct->close = 1;
 		}
 		/* Handle input */
-		if (!ct->close && cq_len(&ct->rbuf))
+		handled = 0;
+		while (!ct->close)
 		{
+			/* Inflate as much as fits */
+			z = 0;
+			if (ct->zin && (z = conn_inflate(ct)) < 0)
+			{
+				ct->close = 1;
+				break;
+			}
+			/* Nothing (new) to handle */
+			if (!cq_len(&ct->rbuf) || (handled && !z)) break;
+
 			n = ct->receive_cb(0, ct);
+			handled = 1;
 			/* Error while handling input */
 			if (n < 0) ct->close = 1;
+
+			/* Go again only if compression is on (it may have just started) */
+			if (!ct->zin) break;
 		}
-		/* Send */
-		if (cq_len(&ct->wbuf))
+		/* Deflate what's queued */
+		if (ct->zout && (cq_len(&ct->wbuf) || ct->zflush) && conn_deflate(ct) < 0) ct->close = 1;
+		out = (ct->zout ? &ct->zwbuf : &ct->wbuf);
+		/* Send (unless we're waiting for the socket to drain) */
+		if (cq_len(out) && (!ct->stalled || NET_READY(ct->ready, NET_OUT)))
 		{
-			n = cq_read(&ct->wbuf, &mesg[0], PD_LARGE_BUFFER);
-			n = sendto(connfd,mesg,n,0, NULL,0);
+			ct->ready &= ~NET_OUT;
+			ct->wbuf_peak = MAX(ct->wbuf_peak, cq_len(out));
+
+			/* Straight from the queue */
+			n = sendto(connfd, CQ_PEEK(out), cq_len(out), 0, NULL, 0);
+			net_stats.sends++;
 
+			/* Sent 'n' bytes, keep the rest for later */
+			if (n > 0)
+			{
+				out->pos += n;
+				if (out->pos == out->len) CQ_CLEAR(out);
+				else cq_slide(out);
+			}
 			/* Error while sending */
-			if (n <= 0) ct->close = 1;
+			else if (n == 0 || sockerr != EWOULDBLOCK) ct->close = 1;
+
+			/* Anything left must wait until kernel wants more */
+			stall = (cq_len(out) ? 1 : 0);
+			if (stall != ct->stalled)
+			{
+				net_rewatch(connfd, &ct->ready, NET_IN | (stall ? NET_OUT : 0));
+				ct->stalled = stall;
+			}
 		}
 
 		/* Done for? */
@@ -316,9 +732,11 @@ eptr handle_connections(eptr root) {
 				ct = (connection_type*)iter->data2;
 				if (ct->close)
 				{
+					net_unwatch(ct->conn_fd);
 					closesocket(ct->conn_fd);
 					FD_CLR(ct->conn_fd, &rd);
 					ct->close_cb(0, ct);
+					conn_zip_end(ct);
 					cq_free(&ct->rbuf);
 					cq_free(&ct->wbuf);
 					FREE(ct);
@@ -355,6 +773,7 @@ eptr handle_callers(eptr root) {
 		FD_SET(callerfd, &wd);
 		n = connect(callerfd, (struct sockaddr *)&ct->addr, sizeof(ct->addr));
 		err = sockerr;
+		net_stats.connects++;
 		#ifdef WINDOWS
 		if (err == EINVAL) {
 			int errVal;
@@ -368,13 +787,18 @@ eptr handle_callers(eptr root) {
 		}
 		#endif
 		if (n == 0 || err == EISCONN)
+		{
+			/* Descriptor is about to become a connection */
+			net_unwatch(callerfd);
 			ct->connect_cb(callerfd, (data)ct);
+		}
 		else if (err == EALREADY) continue;
 		else if (err == EINPROGRESS) continue;
 		else if (err == EWOULDBLOCK) continue;
 		else {
 			n = ct->failure_cb(callerfd, (data)ct);
 			if (n) continue;
+			net_unwatch(callerfd);
 			closesocket(callerfd);
 		}
 
@@ -418,7 +842,11 @@ eptr handle_listeners(eptr root) {
 		FD_SET (listenfd, &rd);
 		lnfds = MATH_MAX(listenfd, lnfds);
 
+		if (!NET_READY(lt->ready, NET_IN)) continue;
+		lt->ready = 0;
+
 		connfd = accept(listenfd,(struct sockaddr *)&cliaddr,&clilen);
+		net_stats.accepts++;
 		if (connfd == -1) continue;
 
 		unblockfd(connfd);
@@ -437,7 +865,7 @@ eptr handle_listeners(eptr root) {
 
 /* Returns microseconds since last time this function was called */
 micro static_timer(int id) {
-	static micro times[5] = { 0, 0, 0, 0, 0 };
+	static micro times[6] = { 0, 0, 0, 0, 0, 0 };
 
 	micro passed;
 #ifndef WINDOWS /* TODO: HAVE_GETTIMEOFDAY */
@@ -475,6 +903,8 @@ eptr handle_senders(eptr root, micro microsec) {
 		sender->delay -= microsec;
 		while (sender->delay <= 0) {
 			sender->delay += sender->interval;
+			/* Anything still unsent is stale by now */
+			cq_clear(&sender->wbuf);
 			n = sender->send_cb((int)TV_SEC(sender->interval), &sender->wbuf);
 			if (!n) {
 				cq_clear(&sender->wbuf);
@@ -483,14 +913,22 @@ eptr handle_senders(eptr root, micro microsec) {
 			} else if (n != 2) 
 				sender->delay = sender->interval;
 		}
-		/* Send */
-		if (cq_len(&sender->wbuf))
+		/* Send, once we know where to */
+		if (cq_len(&sender->wbuf) &&
+			(n = resolve_host(sender->host, &sender->addr.sin_addr, FALSE)) != 0)
 		{
+			/* Nowhere to send it */
+			if (n < 0) {
+				cq_clear(&sender->wbuf);
+				continue;
+			}
+
 			n = cq_read(&sender->wbuf, &mesg[0], PD_SMALL_BUFFER);
 			n = sendto(sender->send_fd,mesg,n,0,(struct sockaddr *)&sender->addr,sizeof(struct sockaddr));
+			net_stats.sends++;
 
 			/* Error while sending */
-			if (n <= 0) {
+			if (n <= 0 && sockerr != EWOULDBLOCK) {
 				sender->interval = 0;
 				to_close++;
 			}
@@ -503,6 +941,7 @@ eptr handle_senders(eptr root, micro microsec) {
 			{
 				closesocket(sender->send_fd);
 				cq_free(&sender->wbuf);
+				string_free(sender->host);
 				FREE(sender);
 				e_del(&root, iter);
 				to_close--;
@@ -544,6 +983,38 @@ eptr handle_timers(eptr root, micro microsec) {
 	return root;
 }
 
+/* Return "timeout", or less if some timer in "root" is due sooner */
+micro timers_delay(eptr root, micro timeout) {
+	eptr iter;
+	for (iter=root; iter; iter=iter->next) {
+		struct timer_type *timer = (struct timer_type *)iter->data2;
+		if (timer->delay < timeout) timeout = timer->delay;
+	}
+	return MAX(0, timeout);
+}
+
+/* Return "timeout", or less if some sender in "root" is due sooner */
+micro senders_delay(eptr root, micro timeout) {
+	eptr iter;
+	for (iter=root; iter; iter=iter->next) {
+		struct sender_type *sender = (struct sender_type *)iter->data2;
+		if (sender->delay < timeout) timeout = sender->delay;
+	}
+	return MAX(0, timeout);
+}
+
+/* See if any connection in "root" has output we could send right now */
+int connections_pending(eptr root) {
+	eptr iter;
+	for (iter=root; iter; iter=iter->next) {
+		struct connection_type *ct = (struct connection_type *)iter->data2;
+		if ((cq_len(&ct->wbuf) && !ct->stalled) || ct->close) return 1;
+		/* Deflated output not all written out yet */
+		if ((cq_len(&ct->zwbuf) || ct->zflush) && !ct->stalled) return 1;
+	}
+	return 0;
+}
+
 void network_reset() {
 #ifdef WINDOWS
 	WSADATA wsadata;
@@ -555,6 +1026,29 @@ void network_reset() {
 	FD_ZERO (&rd);
 	FD_ZERO (&wd);
 	nfds = cnfds = lnfds = crfds = refds = 0;
+
+#ifdef USE_EPOLL
+	/* Not inherited by anything we exec */
+	if (epoll_fd == -1) epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+#endif
+	WIPE(&net_stats, network_stats);
+}
+
+/* In a forked child: let go of every descriptor without disturbing the
+ * parent, which shares them.  Nothing is unwatched (the epoll instance
+ * is shared too) and no peer notices, as the parent keeps them open. */
+void network_forget(eptr listeners, eptr connections, eptr senders) {
+	eptr iter;
+#ifdef USE_EPOLL
+	if (epoll_fd != -1) close(epoll_fd);
+	epoll_fd = -1;
+#endif
+	for (iter = listeners; iter; iter = iter->next)
+		closesocket(((struct listener_type *)iter->data2)->listen_fd);
+	for (iter = connections; iter; iter = iter->next)
+		closesocket(((connection_type *)iter->data2)->conn_fd);
+	for (iter = senders; iter; iter = iter->next)
+		closesocket(((struct sender_type *)iter->data2)->send_fd);
 }
 
 void network_done() {
@@ -563,10 +1057,49 @@ void network_done() {
 #endif
 }
 
+/* Name of the facility used by "network_pause" */
+cptr network_backend() {
+#ifdef USE_EPOLL
+	if (epoll_fd != -1) return "epoll";
+#endif
+#ifdef HAVE_SELECT
+	return "select";
+#else
+	return "usleep";
+#endif
+}
+
+/* Sleep until some descriptor becomes ready, or "timeout" microseconds pass */
 void network_pause(micro timeout) {
+#ifdef USE_EPOLL
+	struct epoll_event events[NET_MAX_EVENTS];
+	int i;
+#endif
+	int n;
+
+	net_stats.loops++;
+
+#ifdef USE_EPOLL
+	if (epoll_fd != -1)
+	{
+		/* Round up, so we don't wake before the deadline and spin */
+		n = epoll_wait(epoll_fd, events, NET_MAX_EVENTS, (int)((timeout + 999) / 1000));
+		net_stats.polls++;
+
+		/* Flag descriptors for the next round of "handle_" functions */
+		for (i = 0; i < n; i++)
+		{
+			*(int*)events[i].data.ptr |= events[i].events;
+		}
+		if (n > 0) net_stats.events += n;
+		return;
+	}
+#endif
+
 #ifndef HAVE_SELECT
 	usleep(timeout);
 #else
+  {
 	struct timeval tv = { 0, 0 };
 
 	TV_SET(tv, timeout); /* 200000 = 0.2 seconds */
@@ -575,7 +1108,10 @@ void network_pause(micro timeout) {
 	nfds = MATH_MAX(nfds, crfds);
 	nfds = MATH_MAX(nfds, refds);
 
-	select(nfds + 1, &rd, &wd, NULL, &tv);
+	n = select(nfds + 1, &rd, &wd, NULL, &tv);
+	net_stats.polls++;
+	if (n > 0) net_stats.events += n;
+  }
 #endif
 }
 
@@ -3,40 +3,68 @@
 
 #define TV_SEC(A) (A / 1000000)
 #define TV_MSEC(A) (A / 1000)
-#define TV_SET(A,B) {A.tv_sec = 0;A.tv_usec=B;}
+#define TV_SET(A,B) {A.tv_sec = TV_SEC(B);A.tv_usec = (B) % 1000000;}
 
 /* struct sender_type -- see imps.c */
 /* struct caller_type -- see imps.c */
 typedef struct listener_type listener_type;
 typedef struct connection_type connection_type;
 typedef struct timer_type timer_type;
+typedef struct network_stats network_stats;
 struct listener_type {
 	int port;
 	int listen_fd;	
+	int ready; /* Readiness reported by network_pause */
 	callback accept_cb;
 };
 struct connection_type {
 	int conn_fd;
+	int ready; /* Readiness reported by network_pause */
 	callback receive_cb; /* return -1 if you disliked his input */
 	callback close_cb;
 	int close;
 	char host_addr[24];
 	cq rbuf;
 	cq wbuf;
+	int wbuf_peak; /* Most output ever queued at once (high-water mark) */
+	int stalled; /* Output is waiting for the socket to become writable */
 	int user; /* User-defined data, unused by us */
 	data uptr;
+	struct mz_stream_s *zout; /* Deflating our output (see "conn_deflate_start") */
+	struct mz_stream_s *zin; /* Inflating our input (see "conn_inflate_start") */
+	int zflush; /* Deflater still holds output for "zwbuf" */
+	cq zwbuf; /* Deflated output waiting for the socket */
+	cq zrbuf; /* Deflated input waiting to be inflated */
+	u32b z_plain; /* Bytes before deflating (or after inflating) */
+	u32b z_packed; /* Bytes that went over the wire */
+	micro z_usec; /* Time spent (de)compressing */
 };
 struct timer_type {
 	micro interval;
 	micro delay;
 	callback timeout_cb; /* return 1 for infinite, 0 for one-shot, 2 for smooth */
 };
+/* Syscall counters, see "network_pause" */
+struct network_stats {
+	u32b loops;    /* calls to network_pause */
+	u32b polls;    /* select/epoll_wait calls */
+	u32b events;   /* descriptors reported ready */
+	u32b ctls;     /* epoll_ctl calls */
+	u32b accepts;
+	u32b connects;
+	u32b recvs;
+	u32b sends;
+	u32b resolves; /* host name lookups started */
+};
+extern network_stats net_stats;
 
 extern eptr add_sender(eptr root, char *host, int port, micro interval, callback send_cb);
 extern eptr add_caller(eptr root, char *addr, int port, callback conn_cb, callback fail_cb);
 extern eptr add_listener(eptr root, int port, callback cb);
 extern eptr add_timer(eptr root, int interval, callback timeout);
 extern eptr add_connection(eptr root, int fd, callback read, callback close);
+extern bool conn_deflate_start(connection_type *ct, int level);
+extern bool conn_inflate_start(connection_type *ct);
 
 extern eptr handle_senders(eptr root, micro microsec);
 extern eptr handle_listeners(eptr root);
@@ -44,9 +72,14 @@ extern eptr handle_connections(eptr root);
 extern eptr handle_callers(eptr root);
 extern eptr handle_timers(eptr root, long microsec);
 extern micro static_timer(int id);
+extern micro timers_delay(eptr root, micro timeout);
+extern micro senders_delay(eptr root, micro timeout);
+extern int connections_pending(eptr root);
 
 extern void network_reset();
+extern void network_forget(eptr listeners, eptr connections, eptr senders);
 extern void network_pause(long timeout);
+extern cptr network_backend();
 extern void denaglefd(int fd);
 extern  int islocalfd(int fd);
 extern  int fillhostname(char *str, int len);
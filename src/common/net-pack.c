@@ -249,6 +249,153 @@ int cq_printf(cq *charq, char *str, ...) {
 	return bytes;
 }
 
+/*
+ * Fixed-shape encoders.
+ *
+ * Each of those writes exactly the same bytes "cq_printf" would for the
+ * format it is named after, but does not have to walk a format string
+ * or a va_list.  They are meant for the packets sent many times per
+ * turn (map tiles, cursor, messages, indicators); everything else should
+ * keep using "cq_printf".  Like "cq_printf", they return the number of
+ * bytes written, or 0 on error (with charq->err set).
+ */
+#define PK_BEGIN(CQ, SIZE)	PACK_INIT(CQ); \
+							if (WPTRN + (SIZE) > WENDN) return cq_pack_error(CQ, SIZE)
+static int cq_pack_error(cq *charq, int size)
+{
+	charq->err = 2;
+	plog_fmt("Error in cq_pack: %s [%d.%d]", pf_errors[2], size, charq->len);
+	return 0;
+}
+
+/* "%c" */
+int cq_pack_c(cq *charq, byte b)
+{
+	int bytes;
+	PACK_DEF
+	PK_BEGIN(charq, 1);
+	PACK_8(b);
+	PACK_FIN_R(charq, bytes);
+	return bytes;
+}
+
+/* "%d" or "%ud" */
+int cq_pack_d(cq *charq, u16b d)
+{
+	int bytes;
+	PACK_DEF
+	PK_BEGIN(charq, 2);
+	PACK_16(d);
+	PACK_FIN_R(charq, bytes);
+	return bytes;
+}
+
+/* "%l" or "%ul" */
+int cq_pack_l(cq *charq, u32b l)
+{
+	int bytes;
+	PACK_DEF
+	PK_BEGIN(charq, 4);
+	PACK_32(l);
+	PACK_FIN_R(charq, bytes);
+	return bytes;
+}
+
+/* "%s" (max = MAX_CHARS) or "%S" (max = MSG_LEN) */
+int cq_pack_s(cq *charq, cptr text, int max)
+{
+	int bytes, str_size = strlen(text) + 1;
+	PACK_DEF
+	if (str_size > max)
+	{
+		plog_fmt("Truncating string '%s', size=%d exceeds %d", text, str_size, max);
+		str_size = max;
+	}
+	PK_BEGIN(charq, str_size);
+	str_size--;
+	PACK_NSTR(text, str_size);
+	PACK_8('\0');
+	PACK_FIN_R(charq, bytes);
+	return bytes;
+}
+
+/* "%c%ud" */
+int cq_pack_c_ud(cq *charq, byte pkt, u16b d)
+{
+	int bytes;
+	PACK_DEF
+	PK_BEGIN(charq, 3);
+	PACK_8(pkt);
+	PACK_16(d);
+	PACK_FIN_R(charq, bytes);
+	return bytes;
+}
+
+/* "%c%c%c%c" */
+int cq_pack_c_c_c_c(cq *charq, byte pkt, byte b1, byte b2, byte b3)
+{
+	int bytes;
+	PACK_DEF
+	PK_BEGIN(charq, 4);
+	PACK_8(pkt);
+	PACK_8(b1);
+	PACK_8(b2);
+	PACK_8(b3);
+	PACK_FIN_R(charq, bytes);
+	return bytes;
+}
+
+/* "%c%ud%c%c" */
+int cq_pack_c_ud_c_c(cq *charq, byte pkt, u16b d, byte b1, byte b2)
+{
+	int bytes;
+	PACK_DEF
+	PK_BEGIN(charq, 5);
+	PACK_8(pkt);
+	PACK_16(d);
+	PACK_8(b1);
+	PACK_8(b2);
+	PACK_FIN_R(charq, bytes);
+	return bytes;
+}
+
+/* "%c%ud%c%c%c%c" */
+int cq_pack_c_ud_c_c_c_c(cq *charq, byte pkt, u16b d, byte b1, byte b2, byte b3, byte b4)
+{
+	int bytes;
+	PACK_DEF
+	PK_BEGIN(charq, 7);
+	PACK_8(pkt);
+	PACK_16(d);
+	PACK_8(b1);
+	PACK_8(b2);
+	PACK_8(b3);
+	PACK_8(b4);
+	PACK_FIN_R(charq, bytes);
+	return bytes;
+}
+
+/* "%c%ud%S" */
+int cq_pack_c_ud_S(cq *charq, byte pkt, u16b d, cptr text)
+{
+	int bytes, str_size = strlen(text) + 1;
+	PACK_DEF
+	if (str_size > MSG_LEN)
+	{
+		plog_fmt("Truncating string '%s', size=%d exceeds MSG_LEN=%d", text, str_size, MSG_LEN);
+		str_size = MSG_LEN;
+	}
+	PK_BEGIN(charq, str_size + 3);
+	PACK_8(pkt);
+	PACK_16(d);
+	str_size--;
+	PACK_NSTR(text, str_size);
+	PACK_8('\0');
+	PACK_FIN_R(charq, bytes);
+	return bytes;
+}
+#undef PK_BEGIN
+
 int cq_scanf(cq *charq, char *str, ...) {
 	int error = 0, found = 0, str_size = 0;
 	va_list marker;
@@ -880,6 +1027,7 @@ cvcb cave_codecs[MAX_CAVE_CODECS][2] = {
 
 int cq_printc(cq *charq, unsigned int mode, cave_view_type *from, int len) {
 	int n = 0;
+	mode &= ~RLE_DELTA; /* Only whole lines are deltas */
 	if (mode < MAX_CAVE_CODECS) 
 	{
 		n = (cave_codecs[mode][CV_ENCODE]) (from, charq, len);
@@ -889,6 +1037,7 @@ int cq_printc(cq *charq, unsigned int mode, cave_view_type *from, int len) {
 
 int cq_scanc(cq *charq, unsigned int mode, cave_view_type *to, int len) {
 	int n = 0;
+	mode &= ~RLE_DELTA; /* Only whole lines are deltas */
 	if (mode < MAX_CAVE_CODECS) 
 	{
 		n = (cave_codecs[mode][CV_DECODE]) (to, charq, len);
@@ -896,6 +1045,108 @@ int cq_scanc(cq *charq, unsigned int mode, cave_view_type *to, int len) {
 	return n;
 }
 
+/*
+ * Delta lines (RLE_DELTA).
+ *
+ * A line is sent as a list of runs, each starting with one byte:
+ *  0xxxxxxx  (x+1) grids follow, encoded with the stream's own RLE mode
+ *  10xxxxxx  (x+1) grids are the same as the receiver already has there
+ *  11xxxxxx  (x+1) grids are the same as in the line above
+ * When only a few grids of a line changed, or it looks much like the
+ * line above, this is a lot shorter than the whole line.  "ref" is what
+ * the receiver has for this line, "up" what it has for the line above
+ * (NULL for the topmost line).
+ */
+#define DELTA_COPY	0x00
+#define DELTA_SKIP	0x80
+#define DELTA_UP	0xC0
+#define DELTA_MAX_COPY	128
+#define DELTA_MAX_RUN	64
+#define cv_same(A, B) ((A).a == (B).a && (A).c == (B).c)
+int cq_printc_delta(cq *charq, unsigned int mode, cave_view_type *from, cave_view_type *ref, cave_view_type *up, int len) {
+	int i = 0, j, s, u, n, bytes = 0;
+
+	mode &= ~RLE_DELTA;
+	if (mode >= MAX_CAVE_CODECS) return 0;
+
+	while (i < len)
+	{
+		/* Measure both kinds of unchanged run */
+		for (s = 0; i + s < len && s < DELTA_MAX_RUN && cv_same(from[i + s], ref[i + s]); s++) ;
+		for (u = 0; up && i + u < len && u < DELTA_MAX_RUN && cv_same(from[i + u], up[i + u]); u++) ;
+
+		/* Worth a run (a single grid is too, at the end of the line) */
+		if (s >= 2 || u >= 2 || (s && i + s == len) || (u && i + u == len))
+		{
+			if (charq->len + 1 > charq->max) { charq->err = 2; return 0; }
+			if (s >= u)
+			{
+				charq->buf[charq->len++] = (char)(DELTA_SKIP | (s - 1));
+				n = s;
+			}
+			else
+			{
+				charq->buf[charq->len++] = (char)(DELTA_UP | (u - 1));
+				n = u;
+			}
+			bytes++;
+			i += n;
+			continue;
+		}
+
+		/* Changed grids, up to the next run of unchanged ones */
+		for (n = 1; i + n < len && n < DELTA_MAX_COPY; n++)
+		{
+			j = i + n;
+			if (j + 1 < len && cv_same(from[j], ref[j]) && cv_same(from[j + 1], ref[j + 1])) break;
+			if (up && j + 1 < len && cv_same(from[j], up[j]) && cv_same(from[j + 1], up[j + 1])) break;
+			if (j + 1 == len && (cv_same(from[j], ref[j]) || (up && cv_same(from[j], up[j])))) break;
+		}
+		if (charq->len + 1 > charq->max) { charq->err = 2; return 0; }
+		charq->buf[charq->len++] = (char)(DELTA_COPY | (n - 1));
+		bytes++;
+		if (!(j = (cave_codecs[mode][CV_ENCODE]) (&from[i], charq, n))) return 0;
+		bytes += j;
+		i += n;
+	}
+	return bytes;
+}
+
+/* Note: "to" must hold what was there before, it is updated in place */
+int cq_scanc_delta(cq *charq, unsigned int mode, cave_view_type *to, cave_view_type *up, int len) {
+	int i = 0, j, n;
+	byte k;
+
+	mode &= ~RLE_DELTA;
+	if (mode >= MAX_CAVE_CODECS) return 0;
+
+	while (i < len)
+	{
+		if (charq->pos + 1 > charq->len) { charq->err = 2; return 0; }
+		k = (byte)charq->buf[charq->pos++];
+
+		if (!(k & DELTA_SKIP))
+		{
+			n = (k & 0x7F) + 1;
+			if (i + n > len) { charq->err = 9; return 0; }
+			if ((cave_codecs[mode][CV_DECODE]) (&to[i], charq, n) < n) return 0;
+		}
+		else
+		{
+			n = (k & 0x3F) + 1;
+			if (i + n > len) { charq->err = 9; return 0; }
+			if ((k & DELTA_UP) == DELTA_UP)
+			{
+				if (!up) { charq->err = 9; return 0; }
+				for (j = i; j < i + n; j++) to[j] = up[j];
+			}
+		}
+		i += n;
+	}
+	return len;
+}
+#undef cv_same
+
 /* Sometimes, cave view is stored in a pair of attr/char arrays. 
  * For such cases, we copy them to temporary cave_view_type buffers
  * and call the regular function on them. This is much less optiomal
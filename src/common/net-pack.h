@@ -3,9 +3,20 @@
 
 extern int cq_printf(cq *charq, char *str, ...);
 extern int cq_copyf(cq *src, const char *str, cq *dst);
+extern int cq_pack_c(cq *charq, byte b);
+extern int cq_pack_d(cq *charq, u16b d);
+extern int cq_pack_l(cq *charq, u32b l);
+extern int cq_pack_s(cq *charq, cptr text, int max);
+extern int cq_pack_c_ud(cq *charq, byte pkt, u16b d);
+extern int cq_pack_c_c_c_c(cq *charq, byte pkt, byte b1, byte b2, byte b3);
+extern int cq_pack_c_ud_c_c(cq *charq, byte pkt, u16b d, byte b1, byte b2);
+extern int cq_pack_c_ud_c_c_c_c(cq *charq, byte pkt, u16b d, byte b1, byte b2, byte b3, byte b4);
+extern int cq_pack_c_ud_S(cq *charq, byte pkt, u16b d, cptr text);
 extern int cq_scanf(cq *charq, char *str, ...);
 extern int cq_printc(cq *charq, unsigned int mode, cave_view_type *from, int len);
 extern int cq_scanc(cq *charq, unsigned int mode, cave_view_type *to, int len);
+extern int cq_printc_delta(cq *charq, unsigned int mode, cave_view_type *from, cave_view_type *ref, cave_view_type *up, int len);
+extern int cq_scanc_delta(cq *charq, unsigned int mode, cave_view_type *to, cave_view_type *up, int len);
 extern int cq_printac(cq *charq, unsigned int mode, byte *a, char *c, int len);
 extern int cq_scanac(cq *charq, unsigned int mode, byte *a, char *c, int len);
 extern const char* cq_error(cq *charq);
@@ -16,6 +16,7 @@
 #define PKT_TALK        	9
 
 #define PKT_OPTION      	10
+#define PKT_COMPRESS    	11
 
 #define PKT_KEEPALIVE   	12
 #define PKT_STRUCT_INFO 	13
@@ -93,14 +93,21 @@ struct cave_type
 
 	s16b m_idx;		/* Monster index (in m_list) or zero */
 				/* or negative if a player */
+};
 
-#ifdef MONSTER_FLOW
 
-	byte cost;		/* Hack -- cost of flowing */
-	byte when;		/* Hack -- when cost was computed */
+/*
+ * Distance (in steps) from every grid of a level to the nearest
+ * player on it, shared by all the monsters there (see "update_flow()")
+ */
+typedef struct flow_type flow_type;
 
-#endif
+struct flow_type
+{
+	byte cost[MAX_HGT][MAX_WID];	/* Steps + 1, or zero if out of reach */
 
+	u32b key;		/* Player positions it was computed for */
+	bool stale;		/* Terrain changed since */
 };
 
 
@@ -346,6 +353,7 @@ typedef struct player_race player_race;
 typedef struct player_class player_class;
 typedef struct hist_type hist_type;
 typedef struct player_other player_other;
+typedef struct player_equip_bonus player_equip_bonus;
 typedef struct player_type player_type;
 typedef struct start_item start_item;
 typedef struct flavor_type flavor_type;
@@ -409,6 +417,9 @@ struct header
 	char *text_ptr;
 
 	parse_info_txt_func parse_info_txt;
+
+	s16b error_idx;			/* Record being parsed */
+	s16b error_line;		/* Line being parsed */
 };
 
 
@@ -822,6 +833,9 @@ struct object_type
 	s16b next_o_idx;		/* Next object in stack (if any) */
 	s16b held_m_idx;		/* Monster holding us (if any) */
 
+	s16b next_lvl_idx;		/* Next object on this level */
+	s16b prev_lvl_idx;		/* Previous object on this level */
+
 	byte origin;        /* How this item was found */
 	byte origin_depth;  /* What depth the item was found at */
 	u16b origin_xtra;   /* Extra information about origin */
@@ -847,6 +861,9 @@ struct monster_type
 
 	s16b dun_depth;			/* Level of the dungeon */
 
+	s16b next_m_idx;		/* Next monster on this level */
+	s16b prev_m_idx;		/* Previous monster on this level */
+
 	s16b hp;			/* Current Hit points */
 	s16b maxhp;			/* Max Hit points */
 
@@ -893,6 +910,9 @@ struct monster_type
  * Pass 1 is determined from allocation information
  * Pass 2 is determined from allocation restriction
  * Pass 3 is determined from allocation calculation
+ *
+ * The "total" field holds the running sum of pass 2 up to and including
+ * this entry, so that an entry can be picked with a binary search.
  */
 
 struct alloc_entry
@@ -904,7 +924,7 @@ struct alloc_entry
 	byte prob2;		/* Probability, pass 2 */
 	byte prob3;		/* Probability, pass 3 */
 
-	u16b total;		/* Unused for now */
+	u32b total;		/* Running total of pass 2 */
 };
 
 
@@ -1178,6 +1198,37 @@ struct player_other
 };
 
 
+/*
+ * What the worn equipment adds to the player, as summed up by
+ * "calc_bonuses()".  Kept around so that changes which do not
+ * touch the equipment (timed effects, stats, weight) can skip
+ * the walk over it.
+ */
+struct player_equip_bonus
+{
+	s16b stat_add[A_CAP];	/* Modifiers to stat values */
+
+	s16b skill_stl;		/* Stealth */
+	s16b skill_srh;		/* Searching ability */
+	s16b skill_fos;		/* Searching frequency */
+	s16b skill_dig;		/* Digging */
+	s16b see_infra;		/* Infravision */
+	s16b pspeed;		/* Speed */
+
+	s16b extra_blows;	/* Bonus blows */
+	s16b extra_shots;	/* Bonus shots */
+
+	s16b ac, dis_ac;	/* Base ac (real/known) */
+	s16b to_a, dis_to_a;	/* Bonus to ac (real/known) */
+	s16b to_h, dis_to_h;	/* Bonus to hit (real/known), bow and weapon excluded */
+	s16b to_d, dis_to_d;	/* Bonus to dam (real/known), bow and weapon excluded */
+
+	byte lite;		/* Number of items with TR3_LITE */
+
+	u32b f1, f2, f3;	/* All the item flags, or-ed together */
+};
+
+
 /*
  * Most of the "player" information goes here.
  *
@@ -1298,6 +1349,11 @@ struct player_type
 	s16b px;
 	s16b dun_depth;		/* Player depth -- wilderness level offset */
 
+	bool on_roster;		/* Is he on a level roster? */
+	s16b roster_depth;	/* The level whose roster he is on */
+	player_type *roster_next;	/* Next player on that level */
+	player_type *roster_prev;	/* Previous player on that level */
+
 	s16b cur_hgt;		/* Height and width of their dungeon level */
 	s16b cur_wid;
 
@@ -1348,16 +1404,17 @@ struct player_type
 
 	byte cave_flag[MAX_HGT][MAX_WID]; /* Can the player see this grid? */
 
-	bool mon_hrt[MAX_M_IDX]; /* Have this player hurt these monsters? */
+	/* Note: the "bit" arrays hold one bit per entity, see "bit_has()" */
+	u32b mon_hrt[BIT_WORDS(MAX_M_IDX)]; /* Have this player hurt these monsters? */
 
-	bool mon_vis[MAX_M_IDX];  /* Can this player see these monsters? */
-	bool mon_los[MAX_M_IDX];
+	u32b mon_vis[BIT_WORDS(MAX_M_IDX)];  /* Can this player see these monsters? */
+	u32b mon_los[BIT_WORDS(MAX_M_IDX)];
 	byte mon_det[MAX_M_IDX]; /* Were these monsters detected by this player? */
 
-	bool obj_vis[MAX_O_IDX];  /* Can this player see these objcets? */
+	u32b obj_vis[BIT_WORDS(MAX_O_IDX)];  /* Can this player see these objcets? */
 
-	bool play_vis[MAX_PLAYERS];	/* Can this player see these players? */
-	bool play_los[MAX_PLAYERS];
+	u32b play_vis[BIT_WORDS(MAX_PLAYERS)];	/* Can this player see these players? */
+	u32b play_los[BIT_WORDS(MAX_PLAYERS)];
 	byte play_det[MAX_PLAYERS]; /* Were these players detected by this player? */
 
 	bool *kind_aware; /* Is the player aware of this obj kind? */
@@ -1409,6 +1466,14 @@ struct player_type
 				/* What he should be seeing */
 	cave_view_type scr_info[MAX_HGT][MAX_WID];
 	cave_view_type trn_info[MAX_HGT][MAX_WID];
+	u32b scr_dirty[MAX_HGT][BIT_WORDS(MAX_WID)];	/* Grids changed since last sent */
+	u32b scr_dirty_row[BIT_WORDS(MAX_HGT)];	/* Rows with grids changed */
+	u32b map_turns;		/* Game turns the map counters below cover */
+	u32b map_tile_marks;	/* Grids changed by "lite_spot()" */
+	u32b map_tile_bytes;	/* Bytes those would take as single grid packets */
+	u32b map_packets;	/* Packets sent by "stream_flush_tiles()" */
+	u32b map_bytes;		/* Bytes sent by "stream_flush_tiles()" */
+	cave_view_type sent_info[MAX_HGT][MAX_WID];	/* Dungeon view as the client has it (RLE_DELTA) */
 	cave_view_type info[MAX_TXT_INFO][MAX_WID];
 	cave_view_type file[MAX_TXT_INFO][MAX_WID];
 	s16b last_info_line; /* (number of lines - 1) */
@@ -1537,6 +1602,10 @@ struct player_type
 	bool heavy_shoot;	/* Heavy shooter */
 	bool icky_wield;	/* Icky weapon */
 
+	u32b bonus_hash[2];	/* Inputs to the last "calc_bonuses()" (0 if none) */
+	u32b equip_hash[2];	/* Equipment "equip_bonus" was summed up for */
+	player_equip_bonus equip_bonus;	/* What the equipment adds */
+
 	s16b cur_lite;		/* Radius of lite (if any) */
 	s16b noise;		/* Timed -- Noise level (for stealth checks) */
 
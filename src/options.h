@@ -396,11 +396,10 @@
 
 
 /*
- * OPTION: Allow use of the "flow_by_smell" and "flow_by_sound"
- * software options, which enable "monster flowing".
- * --broken in mangband.
+ * OPTION: Allow monsters to "flow" towards the players on their level,
+ * along the shortest path, instead of stepping in a straight line.
  */
-/* #define MONSTER_FLOW */
+#define MONSTER_FLOW
 
 
 /*
@@ -1009,7 +1009,8 @@ void player_setup(player_type *p_ptr)
 
 	/* Don't allow placement inside a shop if someone is shopping or 
 	 * if we don't own it (anti-exploit) */
-	for (i = 0; i < num_houses; i++)
+	for (i = find_house(Depth, p_ptr->px, p_ptr->py, 0); i >= 0;
+		i = find_house(Depth, p_ptr->px, p_ptr->py, i + 1))
 	{
 		/* Are we inside this house? */
 		if (house_inside(p_ptr, i))
@@ -31,6 +31,26 @@ int distance(int y1, int x1, int y2, int x2)
 }
 
 
+/*
+ * Precomputed paths
+ *
+ * The grids "los()" and "projectable()" look at only depend on the offset
+ * between the two ends, so for every offset up to MAX_SIGHT we find them
+ * once (see "init_los_table()"), and later only check them for walls.
+ *
+ * The offsets are stored with a bias of MAX_SIGHT, to fit in bytes.
+ */
+#define PATH_SIDE	(MAX_SIGHT * 2 + 1)
+#define PATH_NONE	255	/* Projection never arrives */
+
+static u16b los_first[PATH_SIDE][PATH_SIDE];
+static byte los_count[PATH_SIDE][PATH_SIDE];
+static u16b proj_first[PATH_SIDE][PATH_SIDE];
+static byte proj_count[PATH_SIDE][PATH_SIDE];
+static byte *path_y;
+static byte *path_x;
+
+
 /*
  * A simple, fast, integer-based line-of-sight algorithm.  By Joseph Hall,
  * 4116 Brewster Drive, Raleigh NC 27606.  Email to jnh@ecemwl.ncsu.edu.
@@ -65,12 +85,15 @@ int distance(int y1, int x1, int y2, int x2)
  * Use the "projectable()" routine to test "spell/missile line of sight".
  *
  * Use the "update_view()" function to determine player line-of-sight.
+ *
+ * This function only lists the grids to check, as offsets from (y1,x1),
+ * in the order they should be checked.  See "los()" below.
  */
-bool los(int Depth, int y1, int x1, int y2, int x2)
-{
-	/* Delta */
-	int dx, dy;
+#define los_step(Y,X) \
+    (gy[n] = (Y), gx[n] = (X), n++)
 
+static int los_steps(int dy, int dx, s16b *gy, s16b *gx)
+{
 	/* Absolute */
 	int ax, ay;
 
@@ -89,10 +112,9 @@ bool los(int Depth, int y1, int x1, int y2, int x2)
 	/* Slope, or 1/Slope, of LOS */
 	int m;
 
+	/* Grids found */
+	int n = 0;
 
-	/* Extract the offset */
-	dy = y2 - y1;
-	dx = x2 - x1;
 
 	/* Extract the absolute offset */
 	ay = ABS(dy);
@@ -100,85 +122,45 @@ bool los(int Depth, int y1, int x1, int y2, int x2)
 
 
 	/* Handle adjacent (or identical) grids */
-	if ((ax < 2) && (ay < 2)) return (TRUE);
+	if ((ax < 2) && (ay < 2)) return (0);
 
 
-	/* Paranoia -- require "safe" origin */
-	/* if (!in_bounds(y1, x1)) return (FALSE); */
+	/* Extract some signs */
+	sx = (dx < 0) ? -1 : 1;
+	sy = (dy < 0) ? -1 : 1;
 
 
 	/* Directly South/North */
 	if (!dx)
 	{
-		/* South -- check for walls */
-		if (dy > 0)
-		{
-			for (ty = y1 + 1; ty < y2; ty++)
-			{
-				if (!cave_floor_bold(Depth, ty, x1)) return (FALSE);
-			}
-		}
+		for (ty = sy; ty != dy; ty += sy) los_step(ty, 0);
 
-		/* North -- check for walls */
-		else
-		{
-			for (ty = y1 - 1; ty > y2; ty--)
-			{
-				if (!cave_floor_bold(Depth, ty, x1)) return (FALSE);
-			}
-		}
-
-		/* Assume los */
-		return (TRUE);
+		return (n);
 	}
 
 	/* Directly East/West */
 	if (!dy)
 	{
-		/* East -- check for walls */
-		if (dx > 0)
-		{
-			for (tx = x1 + 1; tx < x2; tx++)
-			{
-				if (!cave_floor_bold(Depth, y1, tx)) return (FALSE);
-			}
-		}
+		for (tx = sx; tx != dx; tx += sx) los_step(0, tx);
 
-		/* West -- check for walls */
-		else
-		{
-			for (tx = x1 - 1; tx > x2; tx--)
-			{
-				if (!cave_floor_bold(Depth, y1, tx)) return (FALSE);
-			}
-		}
-
-		/* Assume los */
-		return (TRUE);
+		return (n);
 	}
 
 
-	/* Extract some signs */
-	sx = (dx < 0) ? -1 : 1;
-	sy = (dy < 0) ? -1 : 1;
-
-
-	/* Vertical "knights" */
-	if (ax == 1)
+	/* Vertical "knights" only need the grid next to the origin */
+	if ((ax == 1) && (ay == 2))
 	{
-		if (ay == 2)
-		{
-			if (cave_floor_bold(Depth, y1 + sy, x1)) return (TRUE);
-		}
+		los_step(sy, 0);
+
+		return (n);
 	}
 
 	/* Horizontal "knights" */
-	else if (ay == 1)
+	if ((ay == 1) && (ax == 2))
 	{
-		if (ax == 2)
-		{
-			if (cave_floor_bold(Depth, y1, x1 + sx)) return (TRUE);
-		}
+		los_step(0, sx);
+
+		return (n);
 	}
 
 
@@ -196,24 +178,24 @@ bool los(int Depth, int y1, int x1, int y2, int x2)
 		qy = ay * ay;
 		m = qy << 1;
 
-		tx = x1 + sx;
+		tx = sx;
 
 		/* Consider the special case where slope == 1. */
 		if (qy == f2)
 		{
-			ty = y1 + sy;
+			ty = sy;
 			qy -= f1;
 		}
 		else
 		{
-			ty = y1;
+			ty = 0;
 		}
 
 		/* Note (below) the case (qy == f2), where */
 		/* the LOS exactly meets the corner of a tile. */
-		while (x2 - tx)
+		while (dx - tx)
 		{
-			if (!cave_floor_bold(Depth, ty, tx)) return (FALSE);
+			los_step(ty, tx);
 
 			qy += m;
 
@@ -224,7 +206,7 @@ bool los(int Depth, int y1, int x1, int y2, int x2)
 			else if (qy > f2)
 			{
 				ty += sy;
-				if (!cave_floor_bold(Depth, ty, tx)) return (FALSE);
+				los_step(ty, tx);
 				qy -= f1;
 				tx += sx;
 			}
@@ -244,23 +226,23 @@ bool los(int Depth, int y1, int x1, int y2, int x2)
 		qx = ax * ax;
 		m = qx << 1;
 
-		ty = y1 + sy;
+		ty = sy;
 
 		if (qx == f2)
 		{
-			tx = x1 + sx;
+			tx = sx;
 			qx -= f1;
 		}
 		else
 		{
-			tx = x1;
+			tx = 0;
 		}
 
 		/* Note (below) the case (qx == f2), where */
 		/* the LOS exactly meets the corner of a tile. */
-		while (y2 - ty)
+		while (dy - ty)
 		{
-			if (!cave_floor_bold(Depth, ty, tx)) return (FALSE);
+			los_step(ty, tx);
 
 			qx += m;
 
@@ -271,7 +253,7 @@ bool los(int Depth, int y1, int x1, int y2, int x2)
 			else if (qx > f2)
 			{
 				tx += sx;
-				if (!cave_floor_bold(Depth, ty, tx)) return (FALSE);
+				los_step(ty, tx);
 				qx -= f1;
 				ty += sy;
 			}
@@ -284,6 +266,130 @@ bool los(int Depth, int y1, int x1, int y2, int x2)
 		}
 	}
 
+	/* Done */
+	return (n);
+}
+
+
+/*
+ * Find the grids a projection passes through, up to and including
+ * the destination, or return PATH_NONE if it never gets there.
+ * See "projectable()".
+ */
+static int proj_steps(int dy, int dx, s16b *gy, s16b *gx)
+{
+	int dist, y = 0, x = 0, n = 0;
+
+	/* Already there */
+	if (!dy && !dx) return (0);
+
+	for (dist = 1; dist <= MAX_RANGE; dist++)
+	{
+		/* Calculate the new location */
+		mmove2(&y, &x, 0, 0, dy, dx);
+		los_step(y, x);
+
+		/* Arrived */
+		if ((y == dy) && (x == dx)) return (n);
+	}
+
+	/* Out of range */
+	return (PATH_NONE);
+}
+
+
+/*
+ * Prepare the path tables
+ */
+void init_los_table(void)
+{
+	s16b gy[MAX_SIGHT * 2], gx[MAX_SIGHT * 2];
+	int dy, dx, n, i, k, total = 0;
+
+	/* Count the grids */
+	for (dy = -MAX_SIGHT; dy <= MAX_SIGHT; dy++)
+	{
+		for (dx = -MAX_SIGHT; dx <= MAX_SIGHT; dx++)
+		{
+			total += los_steps(dy, dx, gy, gx);
+			n = proj_steps(dy, dx, gy, gx);
+			if (n != PATH_NONE) total += n;
+		}
+	}
+
+	/* Allocate them */
+	C_MAKE(path_y, total, byte);
+	C_MAKE(path_x, total, byte);
+
+	/* Fill them in */
+	for (k = 0, dy = -MAX_SIGHT; dy <= MAX_SIGHT; dy++)
+	{
+		for (dx = -MAX_SIGHT; dx <= MAX_SIGHT; dx++)
+		{
+			n = los_steps(dy, dx, gy, gx);
+			los_first[dy + MAX_SIGHT][dx + MAX_SIGHT] = k;
+			los_count[dy + MAX_SIGHT][dx + MAX_SIGHT] = n;
+			for (i = 0; i < n; i++, k++)
+			{
+				path_y[k] = gy[i] + MAX_SIGHT;
+				path_x[k] = gx[i] + MAX_SIGHT;
+			}
+
+			n = proj_steps(dy, dx, gy, gx);
+			proj_first[dy + MAX_SIGHT][dx + MAX_SIGHT] = k;
+			proj_count[dy + MAX_SIGHT][dx + MAX_SIGHT] = n;
+			if (n == PATH_NONE) continue;
+			for (i = 0; i < n; i++, k++)
+			{
+				path_y[k] = gy[i] + MAX_SIGHT;
+				path_x[k] = gx[i] + MAX_SIGHT;
+			}
+		}
+	}
+}
+
+
+/*
+ * Check the line of sight, using the path table when possible
+ */
+bool los(int Depth, int y1, int x1, int y2, int x2)
+{
+	s16b gy[MAX_HGT + MAX_WID], gx[MAX_HGT + MAX_WID];
+	byte *py, *px;
+	int dy = y2 - y1;
+	int dx = x2 - x1;
+	int i, n;
+
+	/* Look up the path to a nearby grid */
+	if ((ABS(dy) <= MAX_SIGHT) && (ABS(dx) <= MAX_SIGHT))
+	{
+		i = los_first[dy + MAX_SIGHT][dx + MAX_SIGHT];
+		n = los_count[dy + MAX_SIGHT][dx + MAX_SIGHT];
+		py = &path_y[i];
+		px = &path_x[i];
+
+		/* All the grids in between must be floors */
+		y1 -= MAX_SIGHT;
+		x1 -= MAX_SIGHT;
+		for (i = 0; i < n; i++)
+		{
+			if (!cave_floor_bold(Depth, y1 + py[i], x1 + px[i])) return (FALSE);
+		}
+
+		/* Assume los */
+		return (TRUE);
+	}
+
+	/* Paranoia -- not on the same level */
+	if ((ABS(dy) >= MAX_HGT) || (ABS(dx) >= MAX_WID)) return (FALSE);
+
+	/* Trace the line to a distant grid */
+	n = los_steps(dy, dx, gy, gx);
+	for (i = 0; i < n; i++)
+	{
+		if (!cave_floor_bold(Depth, y1 + gy[i], x1 + gx[i])) return (FALSE);
+	}
+
 	/* Assume los */
 	return (TRUE);
 }
@@ -1204,7 +1310,7 @@ void map_info(player_type *p_ptr, int y, int x, byte *ap, char *cp, byte *tap, c
 
 		/* Memorized objects */
 		/* Hack -- the dungeon master knows where everything is */
-		if ((p_ptr->obj_vis[c_ptr->o_idx]) || (p_ptr->dm_flags & DM_SEE_LEVEL))
+		if ((bit_has(p_ptr->obj_vis, c_ptr->o_idx)) || (p_ptr->dm_flags & DM_SEE_LEVEL))
 		{
 			/* Normal char */
 			(*cp) = object_char_p(p_ptr, o_ptr);
@@ -1231,7 +1337,7 @@ void map_info(player_type *p_ptr, int y, int x, byte *ap, char *cp, byte *tap, c
 		monster_type *m_ptr = &m_list[c_ptr->m_idx];
 
 		/* Visible monster */
-		if (p_ptr->mon_vis[c_ptr->m_idx])
+		if (bit_has(p_ptr->mon_vis, c_ptr->m_idx))
 		{
 			monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
@@ -1339,7 +1445,7 @@ void map_info(player_type *p_ptr, int y, int x, byte *ap, char *cp, byte *tap, c
 	if (c_ptr->m_idx < 0)
 	{
 		/* Is that player visible? */
-		if (p_ptr->play_vis[0 - c_ptr->m_idx])
+		if (bit_has(p_ptr->play_vis, 0 - c_ptr->m_idx))
 		{
 			int p = player_pict(p_ptr, Players[0 - c_ptr->m_idx]);
 			a = PICT_A(p);
@@ -1395,13 +1501,13 @@ void note_spot(player_type *p_ptr, int y, int x)
 	if (c_ptr->o_idx)
 	{
 		/* Only memorize once */
-		if (!(p_ptr->obj_vis[c_ptr->o_idx]))
+		if (!(bit_has(p_ptr->obj_vis, c_ptr->o_idx)))
 		{
 			/* Memorize visible objects */
 			if (player_can_see_bold(p_ptr, y, x))
 			{
 				/* Memorize */
-				p_ptr->obj_vis[c_ptr->o_idx] = TRUE;
+				bit_on(p_ptr->obj_vis, c_ptr->o_idx);
 
 				/* Schedule list redraw */
 				p_ptr->window |= (PW_ITEMLIST);
@@ -1441,32 +1547,95 @@ void note_spot(player_type *p_ptr, int y, int x)
 }
 
 
+/*
+ * Every player in the game is kept on the roster of the level he is on,
+ * so that the functions which notify "everyone on a level" do not have
+ * to look at the whole "Players[]" array.
+ *
+ * Code which changes "dun_depth" of a player in the game must call
+ * "player_roster_sync()" afterwards.
+ */
+void player_roster_add(player_type *p_ptr)
+{
+	player_type *next;
+
+	/* Already there */
+	if (p_ptr->on_roster) return;
+
+	/* Place at the head of the level roster */
+	next = p_on_depth[p_ptr->dun_depth];
+	p_ptr->roster_prev = NULL;
+	p_ptr->roster_next = next;
+	if (next) next->roster_prev = p_ptr;
+	p_on_depth[p_ptr->dun_depth] = p_ptr;
+
+	p_ptr->roster_depth = p_ptr->dun_depth;
+	p_ptr->on_roster = TRUE;
+}
+
+/*
+ * Remove a player from the roster of his level.
+ */
+void player_roster_remove(player_type *p_ptr)
+{
+	if (!p_ptr->on_roster) return;
+
+	if (p_ptr->roster_prev) p_ptr->roster_prev->roster_next = p_ptr->roster_next;
+	else p_on_depth[p_ptr->roster_depth] = p_ptr->roster_next;
+
+	if (p_ptr->roster_next) p_ptr->roster_next->roster_prev = p_ptr->roster_prev;
+
+	p_ptr->roster_prev = p_ptr->roster_next = NULL;
+	p_ptr->on_roster = FALSE;
+}
+
+/*
+ * Move a player to the roster of his (new) level.
+ */
+void player_roster_sync(player_type *p_ptr)
+{
+	if (!p_ptr->on_roster || (p_ptr->roster_depth == p_ptr->dun_depth)) return;
+
+	player_roster_remove(p_ptr);
+	player_roster_add(p_ptr);
+}
+
+/*
+ * Return the first player on a level, for a loop over everyone there.
+ */
+player_type *player_roster(int Depth)
+{
+	/* Count the work (see "console_debug()") */
+	perf_fanouts++;
+	perf_fanout_scan += NumPlayers;
+
+	return (p_on_depth[Depth]);
+}
+
+
 void note_spot_depth(int Depth, int y, int x)
 {
-	int i;
+	player_type *p_ptr;
 
-	for (i = 1; i <= NumPlayers; i++)
+	for (p_ptr = player_roster(Depth); p_ptr; p_ptr = p_ptr->roster_next)
 	{
-		if (Players[i]->dun_depth == Depth)
-		{
-			note_spot(Players[i], y, x);
-		}
+		perf_fanout_players++;
+
+		note_spot(p_ptr, y, x);
 	}
 }
 
 void everyone_lite_spot(int Depth, int y, int x)
 {
-	int i;
+	player_type *p_ptr;
 
-	/* Check everyone */
-	for (i = 1; i <= NumPlayers; i++)
+	/* Check everyone here */
+	for (p_ptr = player_roster(Depth); p_ptr; p_ptr = p_ptr->roster_next)
 	{
-		/* If he's not here, skip him */
-		if (Players[i]->dun_depth != Depth)
-			continue;
+		perf_fanout_players++;
 
 		/* Actually lite that spot for that player */
-		lite_spot(Players[i], y, x);
+		lite_spot(p_ptr, y, x);
 	}
 }
 
@@ -1475,17 +1644,15 @@ void everyone_lite_spot(int Depth, int y, int x)
  */
 void everyone_forget_spot(int Depth, int y, int x)
 {
-	int i;
+	player_type *p_ptr;
 
-	/* Check everyone */
-	for (i = 1; i <= NumPlayers; i++)
+	/* Check everyone here */
+	for (p_ptr = player_roster(Depth); p_ptr; p_ptr = p_ptr->roster_next)
 	{
-		/* If he's not here, skip him */
-		if (Players[i]->dun_depth != Depth)
-			continue;
+		perf_fanout_players++;
 
 		/* Forget the spot */
-		Players[i]->cave_flag[y][x] &= ~CAVE_MARK;
+		p_ptr->cave_flag[y][x] &= ~CAVE_MARK;
 	}
 }
 
@@ -1534,8 +1701,11 @@ void lite_spot(player_type *p_ptr, int y, int x)
 			p_ptr->trn_info[dispy][dispx].c = tc;
 			p_ptr->trn_info[dispy][dispx].a = ta;
 
-			/* Tell client to redraw this grid */
-			Stream_tile_p(p_ptr, dispy, dispx);
+			/* Tell client to redraw this grid (see "stream_flush_tiles()") */
+			bit_on(p_ptr->scr_dirty[dispy], dispx);
+			bit_on(p_ptr->scr_dirty_row, dispy);
+			p_ptr->map_tile_marks++;
+			p_ptr->map_tile_bytes += (streams[DUNGEON_STREAM_p(p_ptr)].flag & SF_TRANSPARENT) ? 7 : 5;
 
 			/* Mark player */
 			if (is_player)
@@ -1557,13 +1727,12 @@ void lite_spot(player_type *p_ptr, int y, int x)
 
 void spot_updates(int Depth, int y, int x, u32b updates)
 {
-	int i;
+	player_type *p_ptr;
 
 	/* Check every player on this depth */
-	for (i = 1; i <= NumPlayers; i++)
+	for (p_ptr = player_roster(Depth); p_ptr; p_ptr = p_ptr->roster_next)
 	{
-		player_type *p_ptr = Players[i];
-		if (p_ptr->dun_depth != Depth) continue;
+		perf_fanout_players++;
 
 		/* Feature is in direct view */
 		if (player_has_los_bold(p_ptr, y, x))
@@ -1616,6 +1785,9 @@ void cave_set_feat(int Depth, int y, int x, int feat)
 		/* Finally, update view region for affected players */
 		spot_updates(Depth, y, x, (PU_VIEW | PU_LITE | PU_MONSTERS | PU_DISTANCE));
 	}
+
+	/* Monsters need to find new paths */
+	forget_flow(Depth);
 }
 
 
@@ -1636,9 +1808,20 @@ void prt_map(player_type *p_ptr)
 	/* Make sure he didn't just change depth */
 	if (p_ptr->new_level_flag) return;
 
+	/* Client is not keeping up, try again later */
+	if (stream_congested(p_ptr))
+	{
+		p_ptr->redraw |= (PR_MAP);
+		return;
+	}
+
 	/* Hack -- reseed hallucinaton */
 	image_rng_flush(p_ptr);
 
+	/* Whole lines supersede any changed grids */
+	C_WIPE(p_ptr->scr_dirty, MAX_HGT * BIT_WORDS(MAX_WID), u32b);
+	C_WIPE(p_ptr->scr_dirty_row, BIT_WORDS(MAX_HGT), u32b);
+
 	/* Dump the map */
 	for (y = p_ptr->panel_row_min; y <= p_ptr->panel_row_max; y++)
 	{
@@ -2281,16 +2464,16 @@ void update_player_lite(player_type *p_ptr, int y, int x)
  * quickly.
  *
  *
- * The current "update_view()" algorithm uses the "CAVE_XTRA" flag as a
- * temporary internal flag to mark those grids which are not only in view,
- * but which are also "easily" in line of sight of the player.  This flag
- * is always cleared when we are done.
+ * The current "update_view()" algorithm uses the "view_easy" bitset to
+ * mark those grids which are not only in view, but which are also "easily"
+ * in line of sight of the player, and the "view_old" and "view_new" bitsets
+ * to find the grids whose "CAVE_VIEW" flag changed, which allows us to
+ * optimize the "screen updates".  These are always cleared when we are done.
  *
  *
- * The current "update_lite()" and "update_view()" algorithms use the
- * "CAVE_TEMP" flag, and the array of grids which are marked as "CAVE_TEMP",
- * to keep track of which grids were previously marked as "CAVE_LITE" or
- * "CAVE_VIEW", which allows us to optimize the "screen updates".
+ * The current "update_lite()" algorithm uses the "CAVE_TEMP" flag, and
+ * the array of grids which are marked as "CAVE_TEMP", to keep track of
+ * which grids were previously marked as "CAVE_LITE", for the same reason.
  *
  * The "CAVE_TEMP" flag, and the array of "CAVE_TEMP" grids, is also used
  * for various other purposes, such as spreading lite or darkness during
@@ -2750,6 +2933,25 @@ void forget_view(player_type *p_ptr)
 
 
 
+/*
+ * Scratch bitsets for "update_view()", one bit per grid, so the old and
+ * new "view" can be compared a word (32 grids) at a time.  They are only
+ * used during a single call, and left empty afterwards.
+ *
+ * "view_easy" replaces the old use of CAVE_XTRA in the (shared) cave.
+ */
+#define VIEW_WORDS	((MAX_WID + 31) / 32)
+static u32b view_old[MAX_HGT][VIEW_WORDS];
+static u32b view_new[MAX_HGT][VIEW_WORDS];
+static u32b view_easy[MAX_HGT][VIEW_WORDS];
+
+#define view_bit(B,Y,X) \
+    ((B)[Y][(X) >> 5] & (1UL << ((X) & 31)))
+
+#define view_set(B,Y,X) \
+    ((B)[Y][(X) >> 5] |= (1UL << ((X) & 31)))
+
+
 /*
  * This macro allows us to efficiently add a grid to the "view" array,
  * note that we are never called for illegal grids, or for grids which
@@ -2760,6 +2962,7 @@ void forget_view(player_type *p_ptr)
  */
 #define cave_view_hack(W,Y,X) \
     (*(W)) |= CAVE_VIEW; \
+    view_set(view_new, Y, X); \
     p_ptr->view_y[p_ptr->view_n] = (Y); \
     p_ptr->view_x[p_ptr->view_n] = (X); \
     p_ptr->view_n++
@@ -2776,8 +2979,8 @@ void forget_view(player_type *p_ptr)
  * Grid (y1,x1) is on the "diagonal" between (py,px) and (y,x)
  * Grid (y2,x2) is "adjacent", also between (py,px) and (y,x).
  *
- * Note that we are using the "CAVE_XTRA" field for marking grids as
- * "easily viewable".  This bit is cleared at the end of "update_view()".
+ * Note that we are using the "view_easy" bitset for marking grids as
+ * "easily viewable".  It is cleared at the end of "update_view()".
  *
  * This function adds (y,x) to the "viewable set" if necessary.
  *
@@ -2833,13 +3036,13 @@ static bool update_view_aux(player_type *p_ptr, int y, int x, int y1, int x1, in
 
 
 	/* Check the "ease" of visibility */
-	z1 = (v1 && (g1_c_ptr->info & CAVE_XTRA));
-	z2 = (v2 && (g2_c_ptr->info & CAVE_XTRA));
+	z1 = (v1 && view_bit(view_easy, y1, x1));
+	z2 = (v2 && view_bit(view_easy, y2, x2));
 
 	/* Hack -- "easy" plus "easy" yields "easy" */
 	if (z1 && z2)
 	{
-		c_ptr->info |= CAVE_XTRA;
+		view_set(view_easy, y, x);
 
 		cave_view_hack(w_ptr, y, x);
 
@@ -2858,7 +3061,7 @@ static bool update_view_aux(player_type *p_ptr, int y, int x, int y1, int x1, in
 	/* Hack -- "view" plus "view" yields "view" */
 	if (v1 && v2)
 	{
-		/* c_ptr->info |= CAVE_XTRA; */
+		/* view_set(view_easy, y, x); */
 
 		cave_view_hack(w_ptr, y, x);
 
@@ -3005,6 +3208,10 @@ void update_view(player_type *p_ptr)
 	int y_max = p_ptr->cur_hgt - 1;
 	int x_max = p_ptr->cur_wid - 1;
 
+	int y1 = MAX_HGT, y2 = -1;
+	int x1 = MAX_WID, x2 = -1;
+	u32b gone, seen;
+
 	cave_type *c_ptr;
 	byte *w_ptr;
 
@@ -3041,19 +3248,19 @@ void update_view(player_type *p_ptr)
 		x = p_ptr->view_x[n];
 
 		/* Access the grid */
-		c_ptr = &cave[Depth][y][x];
 		w_ptr = &p_ptr->cave_flag[y][x];
 
 		/* Mark the grid as not in "view" */
 		*w_ptr &= ~(CAVE_VIEW);
 
 		/* Mark the grid as "seen" */
-		c_ptr->info |= CAVE_TEMP;
+		view_set(view_old, y, x);
 
-		/* Add it to the "seen" set */
-		p_ptr->temp_y[p_ptr->temp_n] = y;
-		p_ptr->temp_x[p_ptr->temp_n] = x;
-		p_ptr->temp_n++;
+		/* Track the bounds */
+		if (y < y1) y1 = y;
+		if (y > y2) y2 = y;
+		if (x < x1) x1 = x;
+		if (x > x2) x2 = x;
 	}
 
 	/* Start over with the "view" array */
@@ -3071,7 +3278,7 @@ void update_view(player_type *p_ptr)
 	w_ptr = &p_ptr->cave_flag[y][x];
 
 	/* Assume the player grid is easily viewable */
-	c_ptr->info |= CAVE_XTRA;
+	view_set(view_easy, y, x);
 
 	/* Assume the player grid is viewable */
 	cave_view_hack(w_ptr, y, x);
@@ -3088,7 +3295,7 @@ void update_view(player_type *p_ptr)
 		/*if (y + d > 65) break;*/
 		c_ptr = &cave[Depth][y+d][x+d];
 		w_ptr = &p_ptr->cave_flag[y+d][x+d];
-		c_ptr->info |= CAVE_XTRA;
+		view_set(view_easy, y+d, x+d);
 		cave_view_hack(w_ptr, y+d, x+d);
 		if (!cave_floor_grid(c_ptr)) break;		
 	}
@@ -3099,7 +3306,7 @@ void update_view(player_type *p_ptr)
 		/*if (y + d > 65) break;*/
 		c_ptr = &cave[Depth][y+d][x-d];
 		w_ptr = &p_ptr->cave_flag[y+d][x-d];
-		c_ptr->info |= CAVE_XTRA;
+		view_set(view_easy, y+d, x-d);
 		cave_view_hack(w_ptr, y+d, x-d);
 		if (!cave_floor_grid(c_ptr)) break;
 	}
@@ -3110,7 +3317,7 @@ void update_view(player_type *p_ptr)
 		/*if (d > y) break;*/
 		c_ptr = &cave[Depth][y-d][x+d];
 		w_ptr = &p_ptr->cave_flag[y-d][x+d];
-		c_ptr->info |= CAVE_XTRA;
+		view_set(view_easy, y-d, x+d);
 		cave_view_hack(w_ptr, y-d, x+d);
 		if (!cave_floor_grid(c_ptr)) break;
 	}
@@ -3121,7 +3328,7 @@ void update_view(player_type *p_ptr)
 		/*if (d > y) break;*/
 		c_ptr = &cave[Depth][y-d][x-d];
 		w_ptr = &p_ptr->cave_flag[y-d][x-d];
-		c_ptr->info |= CAVE_XTRA;
+		view_set(view_easy, y-d, x-d);
 		cave_view_hack(w_ptr, y-d, x-d);
 		if (!cave_floor_grid(c_ptr)) break;
 	}
@@ -3135,7 +3342,7 @@ void update_view(player_type *p_ptr)
 		/*if (y + d > 65) break;*/
 		c_ptr = &cave[Depth][y+d][x];
 		w_ptr = &p_ptr->cave_flag[y+d][x];
-		c_ptr->info |= CAVE_XTRA;
+		view_set(view_easy, y+d, x);
 		cave_view_hack(w_ptr, y+d, x);
 		if (!cave_floor_grid(c_ptr)) break;
 	}
@@ -3149,7 +3356,7 @@ void update_view(player_type *p_ptr)
 		/*if (d > y) break;*/
 		c_ptr = &cave[Depth][y-d][x];
 		w_ptr = &p_ptr->cave_flag[y-d][x];
-		c_ptr->info |= CAVE_XTRA;
+		view_set(view_easy, y-d, x);
 		cave_view_hack(w_ptr, y-d, x);
 		if (!cave_floor_grid(c_ptr)) break;
 	}
@@ -3162,7 +3369,7 @@ void update_view(player_type *p_ptr)
 	{
 		c_ptr = &cave[Depth][y][x+d];
 		w_ptr = &p_ptr->cave_flag[y][x+d];
-		c_ptr->info |= CAVE_XTRA;
+		view_set(view_easy, y, x+d);
 		cave_view_hack(w_ptr, y, x+d);
 		if (!cave_floor_grid(c_ptr)) break;
 	}
@@ -3175,7 +3382,7 @@ void update_view(player_type *p_ptr)
 	{
 		c_ptr = &cave[Depth][y][x-d];
 		w_ptr = &p_ptr->cave_flag[y][x-d];
-		c_ptr->info |= CAVE_XTRA;
+		view_set(view_easy, y, x-d);
 		cave_view_hack(w_ptr, y, x-d);
 		if (!cave_floor_grid(c_ptr)) break;
 	}
@@ -3442,50 +3649,44 @@ void update_view(player_type *p_ptr)
 
 	/*** Step 5 -- Complete the algorithm ***/
 
-	/* Update all the new grids */
-	for (n = 0; n < p_ptr->view_n; n++)
-	{
-		y = p_ptr->view_y[n];
-		x = p_ptr->view_x[n];
-
-		/* Access the grid */
-		c_ptr = &cave[Depth][y][x];
-
-		/* Clear the "CAVE_XTRA" flag */
-		c_ptr->info &= ~CAVE_XTRA;
-
-		/* Update only newly viewed grids */
-		if (c_ptr->info & CAVE_TEMP) continue;
-
-		/* Note */
-		note_spot(p_ptr, y, x);
+	/* Area that can hold old or new grids */
+	y1 = MIN(y1, MAX(p_ptr->py - full, 0));
+	y2 = MAX(y2, MIN(p_ptr->py + full, MAX_HGT - 1));
+	x1 = MIN(x1, MAX(p_ptr->px - full, 0)) / 32;
+	x2 = MAX(x2, MIN(p_ptr->px + full, MAX_WID - 1)) / 32;
 
-		/* Redraw */
-		lite_spot(p_ptr, y, x);
-	}
-
-	/* Wipe the old grids, update as needed */
-	for (n = 0; n < p_ptr->temp_n; n++)
+	/* Compare the old and new "view", one word at a time */
+	for (y = y1; y <= y2; y++)
 	{
-		y = p_ptr->temp_y[n];
-		x = p_ptr->temp_x[n];
+		for (k = x1; k <= x2; k++)
+		{
+			/* Grids which left or entered the view */
+			gone = view_old[y][k] & ~view_new[y][k];
+			seen = view_new[y][k] & ~view_old[y][k];
 
-		/* Access the grid */
-		c_ptr = &cave[Depth][y][x];
-		w_ptr = &p_ptr->cave_flag[y][x];
+			/* Leave the bitsets empty */
+			view_old[y][k] = view_new[y][k] = view_easy[y][k] = 0;
 
-		/* No longer in the array */
-		c_ptr->info &= ~CAVE_TEMP;
+			for (x = k * 32; gone || seen; x++, gone >>= 1, seen >>= 1)
+			{
+				/* Update newly viewed grids */
+				if (seen & 1)
+				{
+					/* Note */
+					note_spot(p_ptr, y, x);
 
-		/* Update only non-viewable grids */
-		if (*w_ptr & CAVE_VIEW) continue;
+					/* Redraw */
+					lite_spot(p_ptr, y, x);
+				}
 
-		/* Redraw */
-		lite_spot(p_ptr, y, x);
+				/* Redraw non-viewable grids */
+				else if (gone & 1)
+				{
+					lite_spot(p_ptr, y, x);
+				}
+			}
+		}
 	}
-
-	/* None left */
-	p_ptr->temp_n = 0;
 }
 
 
@@ -3494,183 +3695,177 @@ void update_view(player_type *p_ptr)
 
 
 /*
- * Hack -- provide some "speed" for the "flow" code
- * This entry is the "current index" for the "when" field
- * Note that a "when" value of "zero" means "not used".
- *
- * Note that the "cost" indexes from 1 to 127 are for
- * "old" data, and from 128 to 255 are for "new" data.
- *
- * This means that as long as the player does not "teleport",
- * then any monster up to 128 + MONSTER_FLOW_DEPTH will be
- * able to track down the player, and in general, will be
- * able to track down either the player or a position recently
- * occupied by the player.
+ * Monster "flow"
+ *
+ * Every level with players on it can have a flow field: the number of
+ * steps from each grid to the nearest player, found by a breadth-first
+ * search out to MONSTER_FLOW_DEPTH steps.  All the monsters on the level
+ * share it (see "get_moves_aux()" in "melee2.c").
+ *
+ * The field is computed lazily, when a monster asks for it, and only
+ * if the players have moved (their positions are hashed into a key)
+ * or the terrain has changed (see "forget_flow()") since last time.
+ * It is then rebuilt whole: one search per level costs less than
+ * keeping it up to date incrementally as several sources move.
  */
-/*static int flow_n = 0;*/
+
+/* Breadth-first search queue (large enough to never wrap onto itself) */
+#define FLOW_QUEUE	16384
+static byte flow_y[FLOW_QUEUE];
+static byte flow_x[FLOW_QUEUE];
 
 
 /*
- * Hack -- forget the "flow" information
+ * Hack -- forget the "flow" information (terrain changed)
  */
-void forget_flow(void)
+void forget_flow(int Depth)
 {
-
 #ifdef MONSTER_FLOW
-
-	int x, y;
-
-	/* Nothing to forget */
-	if (!flow_n) return;
-
-	/* Check the entire dungeon */
-	for (y = 0; y < cur_hgt; y++)
-	{
-		for (x = 0; x < cur_wid; x++)
-		{
-			/* Forget the old data */
-			cave[y][x].cost = 0;
-			cave[y][x].when = 0;
-		}
-	}
-
-	/* Start over */
-	flow_n = 0;
-
+	if (level_flow[Depth]) level_flow[Depth]->stale = TRUE;
 #endif
-
 }
 
 
-#ifdef MONSTER_FLOW
-
 /*
- * Hack -- Allow us to treat the "seen" array as a queue
+ * Free the "flow" information of a level
  */
-static int flow_head = 0;
-static int flow_tail = 0;
+void wipe_flow(int Depth)
+{
+	if (level_flow[Depth]) KILL(level_flow[Depth]);
+}
 
 
 /*
- * Take note of a reachable grid.  Assume grid is legal.
+ * Players the monsters go after (the same ones "process_monsters()" picks)
  */
-static void update_flow_aux(int y, int x, int n)
+static bool flow_source(player_type *p_ptr, int Depth)
 {
-	cave_type *c_ptr;
-
-	int old_head = flow_head;
-
-
-	/* Get the grid */
-	c_ptr = &cave[y][x];
-
-	/* Ignore "pre-stamped" entries */
-	if (c_ptr->when == flow_n) return;
+	if (p_ptr->dun_depth != Depth) return (FALSE);
 
-	/* Ignore "walls" and "rubble" */
-	if (c_ptr->feat >= FEAT_RUBBLE) return;
+	/* Hack -- notice death or departure */
+	if (!p_ptr->alive || p_ptr->death || p_ptr->new_level_flag) return (FALSE);
 
-	/* Save the time-stamp */
-	c_ptr->when = flow_n;
+	/* Shopping, or invisible to monsters */
+	if (p_ptr->store_num != -1) return (FALSE);
+	if (p_ptr->dm_flags & DM_MONSTER_FRIEND) return (FALSE);
 
-	/* Save the flow cost */
-	c_ptr->cost = n;
+	return (TRUE);
+}
 
-	/* Hack -- limit flow depth */
-	if (n == MONSTER_FLOW_DEPTH) return;
 
-	/* Enqueue that entry */
-	temp_y[flow_head] = y;
-	temp_x[flow_head] = x;
+/*
+ * Grids monsters walk, open or bash their way through (the floors, in the
+ * wilderness too, and the doors; see "process_monster()")
+ */
+static bool flow_passable(int Depth, int y, int x)
+{
+	byte feat = cave[Depth][y][x].feat;
 
-	/* Advance the queue */
-	if (++flow_head == TEMP_MAX) flow_head = 0;
+	if (cave_floor_bold(Depth, y, x)) return (TRUE);
+	if ((feat >= FEAT_DOOR_HEAD) && (feat <= FEAT_DOOR_TAIL)) return (TRUE);
+	if (feat == FEAT_SECRET) return (TRUE);
 
-	/* Hack -- notice overflow by forgetting new entry */
-	if (flow_head == flow_tail) flow_head = old_head;
+	return (FALSE);
 }
 
-#endif
-
 
 /*
- * Hack -- fill in the "cost" field of every grid that the player
- * can "reach" with the number of steps needed to reach that grid.
- * This also yields the "distance" of the player from every grid.
- *
- * In addition, mark the "when" of the grids that can reach
- * the player with the incremented value of "flow_n".
- *
- * Hack -- use the "seen" array as a "circular queue".
+ * Fill in the "cost" of every grid that the players on the level can
+ * "reach" with the number of steps needed to reach that grid (plus one).
+ * Returns NULL if flowing is disabled or nobody is there.
  *
  * We do not need a priority queue because the cost from grid
  * to grid is always "one" and we process them in order.
  */
-void update_flow(void)
+flow_type *update_flow(int Depth)
 {
-
 #ifdef MONSTER_FLOW
 
-	int x, y, d;
-
-	/* Hack -- disabled */
-	if (!flow_by_sound) return;
+	flow_type *f_ptr = level_flow[Depth];
+	int head = 0, tail = 0;
+	int i, d, y, x, num = 0;
+	u32b key = 0;
+	byte cost;
 
-	/* Paranoia -- make sure the array is empty */
-	if (temp_n) return;
-
-	/* Cycle the old entries (once per 128 updates) */
-	if (flow_n == 255)
+	/* Hash the player positions */
+	for (i = 1; i <= NumPlayers; i++)
 	{
-		/* Rotate the time-stamps */
-		for (y = 0; y < cur_hgt; y++)
-		{
-			for (x = 0; x < cur_wid; x++)
-			{
-				int w = cave[y][x].when;
-				cave[y][x].when = (w > 128) ? (w - 128) : 0;
-			}
-		}
-
-		/* Restart */
-		flow_n = 127;
+		player_type *p_ptr = Players[i];
+		if (!flow_source(p_ptr, Depth)) continue;
+		key = key * 31 + (p_ptr->py << 8) + p_ptr->px + 1;
+		num++;
 	}
 
-	/* Start a new flow (never use "zero") */
-	flow_n++;
+	/* Nobody to flow towards */
+	if (!num || !cave[Depth]) return (NULL);
 
+	/* Still good */
+	if (f_ptr && !f_ptr->stale && f_ptr->key == key) return (f_ptr);
 
-	/* Reset the "queue" */
-	flow_head = flow_tail = 0;
+	/* Allocate */
+	if (!f_ptr) MAKE(level_flow[Depth], flow_type);
+	f_ptr = level_flow[Depth];
 
-	/* Add the player's grid to the queue */
-	update_flow_aux(py, px, 0);
+	/* Start over */
+	C_WIPE(f_ptr->cost, MAX_HGT * MAX_WID, byte);
+	f_ptr->key = key;
+	f_ptr->stale = FALSE;
+
+	/* Every player is a source */
+	for (i = 1; i <= NumPlayers; i++)
+	{
+		player_type *p_ptr = Players[i];
+		if (!flow_source(p_ptr, Depth)) continue;
+		if (f_ptr->cost[p_ptr->py][p_ptr->px]) continue;
+
+		f_ptr->cost[p_ptr->py][p_ptr->px] = 1;
+		flow_y[head] = p_ptr->py;
+		flow_x[head] = p_ptr->px;
+		head = (head + 1) % FLOW_QUEUE;
+	}
 
 	/* Now process the queue */
-	while (flow_head != flow_tail)
+	while (head != tail)
 	{
 		/* Extract the next entry */
-		y = temp_y[flow_tail];
-		x = temp_x[flow_tail];
+		y = flow_y[tail];
+		x = flow_x[tail];
+		tail = (tail + 1) % FLOW_QUEUE;
 
-		/* Forget that entry */
-		if (++flow_tail == TEMP_MAX) flow_tail = 0;
+		/* Hack -- limit flow depth */
+		cost = f_ptr->cost[y][x];
+		if (cost > MONSTER_FLOW_DEPTH) continue;
 
 		/* Add the "children" */
 		for (d = 0; d < 8; d++)
 		{
-			/* Add that child if "legal" */
-			update_flow_aux(y+ddy_ddd[d], x+ddx_ddd[d], cave[y][x].cost+1);
+			int ny = y + ddy_ddd[d];
+			int nx = x + ddx_ddd[d];
+
+			if (!in_bounds2(Depth, ny, nx)) continue;
+
+			/* Ignore "pre-stamped" entries */
+			if (f_ptr->cost[ny][nx]) continue;
+
+			/* Ignore "walls", "rubble" and "trees" */
+			if (!flow_passable(Depth, ny, nx)) continue;
+
+			/* Save the flow cost, and enqueue that entry */
+			f_ptr->cost[ny][nx] = cost + 1;
+			flow_y[head] = ny;
+			flow_x[head] = nx;
+			head = (head + 1) % FLOW_QUEUE;
 		}
 	}
 
-	/* Forget the flow info */
-	flow_head = flow_tail = 0;
+	return (f_ptr);
 
-#endif
+#else
 
-}
+	return (NULL);
 
+#endif
+}
 
 
 
@@ -3715,10 +3910,10 @@ void wiz_lite(player_type *p_ptr)
 			if (c_ptr->o_idx)
 			{
 				/* Wasn't seen, schedule list redraw */
-				if (!p_ptr->obj_vis[c_ptr->o_idx]) p_ptr->window |= (PW_ITEMLIST);
+				if (!bit_has(p_ptr->obj_vis, c_ptr->o_idx)) p_ptr->window |= (PW_ITEMLIST);
 
 				/* Memorize */
-				p_ptr->obj_vis[c_ptr->o_idx]= TRUE;
+				bit_on(p_ptr->obj_vis, c_ptr->o_idx);
 			}
 
 			/* Process all non-walls */
@@ -3791,10 +3986,10 @@ void wiz_dark(player_type *p_ptr)
 			if (c_ptr->o_idx)
 			{
 				/* Was known, schedule list redraw */
-				if (p_ptr->obj_vis[c_ptr->o_idx]) p_ptr->window |= (PW_ITEMLIST);
+				if (bit_has(p_ptr->obj_vis, c_ptr->o_idx)) p_ptr->window |= (PW_ITEMLIST);
 
 				/* Forget the object */
-				p_ptr->obj_vis[c_ptr->o_idx] = FALSE;
+				bit_off(p_ptr->obj_vis, c_ptr->o_idx);
 			}
 		}
 	}
@@ -3928,27 +4123,31 @@ void mmove2(int *y, int *x, int y1, int x1, int y2, int x2)
  */
 bool projectable(int Depth, int y1, int x1, int y2, int x2)
 {
-	int dist, y, x;
-
-	/* Start at the initial location */
-	y = y1, x = x1;
-
-	/* See "project()" */
-	for (dist = 0; dist <= MAX_RANGE; dist++)
+	int dy = y2 - y1;
+	int dx = x2 - x1;
+	int i, n;
+	byte *py, *px;
+
+	/* Too far to arrive */
+	if ((ABS(dy) > MAX_SIGHT) || (ABS(dx) > MAX_SIGHT)) return (FALSE);
+
+	/* Look up the path (see "project()") */
+	i = proj_first[dy + MAX_SIGHT][dx + MAX_SIGHT];
+	n = proj_count[dy + MAX_SIGHT][dx + MAX_SIGHT];
+	if (n == PATH_NONE) return (FALSE);
+	py = &path_y[i];
+	px = &path_x[i];
+
+	/* Never pass through walls (including the final target) */
+	y1 -= MAX_SIGHT;
+	x1 -= MAX_SIGHT;
+	for (i = 0; i < n; i++)
 	{
-		/* Never pass through walls */
-		if (dist && !cave_floor_bold(Depth, y, x)) break;
-
-		/* Check for arrival at "final target" */
-		if ((x == x2) && (y == y2)) return (TRUE);
-
-		/* Calculate the new location */
-		mmove2(&y, &x, y1, x1, y2, x2);
+		if (!cave_floor_bold(Depth, y1 + py[i], x1 + px[i])) return (FALSE);
 	}
 
-
-	/* Assume obstruction */
-	return (FALSE);
+	/* Arrived */
+	return (TRUE);
 }
 
 
@@ -3956,29 +4155,35 @@ bool projectable(int Depth, int y1, int x1, int y2, int x2)
  * Used by monsters... otherwise player ghosts would be safe from monster spells! */
 bool projectable_wall(int Depth, int y1, int x1, int y2, int x2)
 {
-	int dist, y, x;
-
-	/* Start at the initial location */
-	y = y1, x = x1;
-
-	/* See "project()" */
-	for (dist = 0; dist <= MAX_RANGE; dist++)
+	int dy = y2 - y1;
+	int dx = x2 - x1;
+	int i, n;
+	byte *py, *px;
+
+	/* Too far to arrive */
+	if ((ABS(dy) > MAX_SIGHT) || (ABS(dx) > MAX_SIGHT)) return (FALSE);
+
+	/* Look up the path (see "project()") */
+	i = proj_first[dy + MAX_SIGHT][dx + MAX_SIGHT];
+	n = proj_count[dy + MAX_SIGHT][dx + MAX_SIGHT];
+	if (n == PATH_NONE) return (FALSE);
+	py = &path_y[i];
+	px = &path_x[i];
+
+	/* Check the grids before the final target */
+	y1 -= MAX_SIGHT;
+	x1 -= MAX_SIGHT;
+	for (i = 0; i < n - 1; i++)
 	{
-		/* Check for arrival at "final target" */
-		if ((x == x2) && (y == y2)) return (TRUE);
-
 		/* HACK -- Never go through walls -- ARENA WALLS */
-		if (dist && cave[Depth][y][x].feat ==  FEAT_PVP_ARENA) break;
+		if (cave[Depth][y1 + py[i]][x1 + px[i]].feat == FEAT_PVP_ARENA) return (FALSE);
 
 		/* Never go through walls */
-		if (dist && !cave_floor_bold(Depth, y, x)) break;
-
-		/* Calculate the new location */
-		mmove2(&y, &x, y1, x1, y2, x2);
+		if (!cave_floor_bold(Depth, y1 + py[i], x1 + px[i])) return (FALSE);
 	}
 
-	/* Assume obstruction */
-	return (FALSE);
+	/* Arrived */
+	return (TRUE);
 }
 
 
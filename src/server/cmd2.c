@@ -97,6 +97,7 @@ void do_cmd_go_up(player_type *p_ptr)
 
 	/* And another player has entered this depth */
 	players_on_depth[p_ptr->dun_depth]++;
+	player_roster_sync(p_ptr);
 
 	p_ptr->new_level_flag = TRUE;
 
@@ -198,6 +199,7 @@ void do_cmd_go_down(player_type *p_ptr)
 
 	/* Another player has entered this depth */
 	players_on_depth[p_ptr->dun_depth]++;
+	player_roster_sync(p_ptr);
 
 	p_ptr->new_level_flag = TRUE;
 
@@ -436,6 +438,180 @@ static void chest_trap(player_type *p_ptr, int y, int x, object_type *o_ptr)
 }
 
 
+/*
+ * House index.
+ *
+ * Houses are looked up by door grid, by a grid they cover and by owner,
+ * and a wilderness server may have thousands of them.  Instead of walking
+ * the whole houses[] array every lookup walks a short hash chain:
+ *
+ *   door chains are keyed on the door grid,
+ *   cell chains are keyed on a coarse grid cell, and each house is linked
+ *   into every cell its walls overlap,
+ *   depth chains link all the houses on a level,
+ *   owner chains are keyed on the owner's name.
+ *
+ * Chain links hold "index + 1" so that 0 ends a chain, and every chain is
+ * kept in index order, so the first match is the one a linear scan found.
+ */
+#define HOUSE_HASH_SIZE	2048
+#define HOUSE_CELL_HGT	16
+#define HOUSE_CELL_WID	32
+#define HOUSE_CELL_ROWS	((MAX_HGT + HOUSE_CELL_HGT - 1) / HOUSE_CELL_HGT)
+#define HOUSE_CELL_COLS	((MAX_WID + HOUSE_CELL_WID - 1) / HOUSE_CELL_WID)
+#define HOUSE_CELLS	(HOUSE_CELL_ROWS * HOUSE_CELL_COLS)
+
+static s16b house_door_head[HOUSE_HASH_SIZE];
+static s16b house_door_next[MAX_HOUSES];
+static s16b house_depth_head[HOUSE_HASH_SIZE];
+static s16b house_depth_next[MAX_HOUSES];
+static s16b house_owner_head[HOUSE_HASH_SIZE];
+static s16b house_owner_next[MAX_HOUSES];
+
+/* Cell links are "house * HOUSE_CELLS + cell + 1" */
+static s32b house_cell_head[HOUSE_HASH_SIZE];
+static s32b house_cell_next[MAX_HOUSES * HOUSE_CELLS];
+
+/*
+ * Hash a grid (or a cell) on a level
+ */
+static int house_grid_hash(int Depth, int y, int x)
+{
+	u32b h = (u32b)Depth * 0x9E3779B1UL;
+
+	h ^= ((u32b)y << 8 | (u32b)x) * 0x85EBCA6BUL;
+	h ^= h >> 15;
+
+	return (h & (HOUSE_HASH_SIZE - 1));
+}
+
+/*
+ * Hash an owner's name
+ */
+static int house_owner_hash(cptr name)
+{
+	u32b h = 5381;
+
+	while (*name) h = h * 33 + (byte)*name++;
+
+	return (h & (HOUSE_HASH_SIZE - 1));
+}
+
+/*
+ * Link a house into a chain, keeping the chain in index order
+ */
+static void house_link(s16b *link, s16b *next, int house)
+{
+	while (*link && *link - 1 < house) link = &next[*link - 1];
+
+	next[house] = *link;
+	*link = house + 1;
+}
+
+/*
+ * Unlink a house from a chain
+ */
+static void house_unlink(s16b *link, s16b *next, int house)
+{
+	while (*link && *link - 1 != house) link = &next[*link - 1];
+
+	if (*link) *link = next[house];
+	next[house] = 0;
+}
+
+/*
+ * Link or unlink a house in the cell chains of every cell it overlaps
+ */
+static void house_cells(int house, bool add)
+{
+	house_type *h_ptr = &houses[house];
+	int y1, x1, y2, x2, cy, cx;
+
+	/* The walls are part of the house */
+	y1 = MAX(h_ptr->y_1 - 1, 0) / HOUSE_CELL_HGT;
+	x1 = MAX(h_ptr->x_1 - 1, 0) / HOUSE_CELL_WID;
+	y2 = MIN(h_ptr->y_2 + 1, MAX_HGT - 1) / HOUSE_CELL_HGT;
+	x2 = MIN(h_ptr->x_2 + 1, MAX_WID - 1) / HOUSE_CELL_WID;
+
+	for (cy = y1; cy <= y2; cy++)
+	{
+		for (cx = x1; cx <= x2; cx++)
+		{
+			s32b e = house * HOUSE_CELLS + cy * HOUSE_CELL_COLS + cx;
+			s32b *link = &house_cell_head[house_grid_hash(h_ptr->depth, cy, cx)];
+
+			if (add)
+			{
+				while (*link && *link - 1 < e) link = &house_cell_next[*link - 1];
+				house_cell_next[e] = *link;
+				*link = e + 1;
+			}
+			else
+			{
+				while (*link && *link - 1 != e) link = &house_cell_next[*link - 1];
+				if (*link) *link = house_cell_next[e];
+				house_cell_next[e] = 0;
+			}
+		}
+	}
+}
+
+/*
+ * Add a house to the index.  Called once the house is counted in
+ * num_houses and has its position, depth and door filled in.
+ */
+void house_index_add(int house)
+{
+	house_type *h_ptr = &houses[house];
+
+	house_link(&house_door_head[house_grid_hash(h_ptr->depth, h_ptr->door_y, h_ptr->door_x)],
+		house_door_next, house);
+	house_link(&house_depth_head[house_grid_hash(h_ptr->depth, 0, 0)],
+		house_depth_next, house);
+	house_cells(house, TRUE);
+
+	if (house_owned(house))
+	{
+		house_link(&house_owner_head[house_owner_hash(h_ptr->owned)],
+			house_owner_next, house);
+	}
+}
+
+/*
+ * Rebuild the whole house index, e.g. after the houses were loaded
+ */
+void house_index_rebuild(void)
+{
+	int i;
+
+	C_WIPE(house_door_head, HOUSE_HASH_SIZE, s16b);
+	C_WIPE(house_depth_head, HOUSE_HASH_SIZE, s16b);
+	C_WIPE(house_owner_head, HOUSE_HASH_SIZE, s16b);
+	C_WIPE(house_cell_head, HOUSE_HASH_SIZE, s32b);
+
+	for (i = 0; i < num_houses; i++)
+	{
+		house_index_add(i);
+	}
+}
+
+/*
+ * Move the door of a house
+ */
+void set_house_door(int house, int y, int x)
+{
+	house_type *h_ptr = &houses[house];
+
+	house_unlink(&house_door_head[house_grid_hash(h_ptr->depth, h_ptr->door_y, h_ptr->door_x)],
+		house_door_next, house);
+
+	h_ptr->door_y = y;
+	h_ptr->door_x = x;
+
+	house_link(&house_door_head[house_grid_hash(h_ptr->depth, y, x)],
+		house_door_next, house);
+}
+
 /*
  * Return the index of a house given an coordinate pair
  */
@@ -443,14 +619,14 @@ int pick_house(int Depth, int y, int x)
 {
 	int i;
 
-	/* Check each house */
-	for (i = 0; i < num_houses; i++)
+	/* Check each house with a door hashed here */
+	for (i = house_door_head[house_grid_hash(Depth, y, x)]; i; i = house_door_next[i - 1])
 	{
 		/* Check this one */
-		if (houses[i].door_x == x && houses[i].door_y == y && houses[i].depth == Depth)
+		if (houses[i - 1].door_x == x && houses[i - 1].door_y == y && houses[i - 1].depth == Depth)
 		{
 			/* Return */
-			return i;
+			return i - 1;
 		}
 	}
 
@@ -458,6 +634,25 @@ int pick_house(int Depth, int y, int x)
 	return -1;
 }
 
+/*
+ * Determine if there is an owned house on the given level
+ */
+bool level_has_owned_house(int Depth)
+{
+	int i;
+
+	/* Check each house hashed to this level */
+	for (i = house_depth_head[house_grid_hash(Depth, 0, 0)]; i; i = house_depth_next[i - 1])
+	{
+		if (houses[i - 1].depth == Depth && house_owned(i - 1))
+		{
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
 /*
  * Determine if the player is inside the house
  */
@@ -507,6 +702,26 @@ bool house_owned_by(player_type *p_ptr, int house)
 	return FALSE;
 }
 
+/*
+ * Return the next house after the given one owned by the player, or -1.
+ * Start with house -1 to get the first one.
+ */
+int next_house_owned(player_type *p_ptr, int house)
+{
+	int i;
+
+	/* Check each house with an owner hashed like this player */
+	for (i = house_owner_head[house_owner_hash(p_ptr->name)]; i; i = house_owner_next[i - 1])
+	{
+		if (i - 1 > house && house_owned_by(p_ptr, i - 1))
+		{
+			return i - 1;
+		}
+	}
+
+	return -1;
+}
+
 /*
  * Return the number of houses owned by the player
  */
@@ -515,10 +730,10 @@ int houses_owned(player_type *p_ptr)
 	int i;
 	int owned = 0;
 
-	/* Check each house */
-	for (i = 0; i < num_houses; i++)
+	/* Check each house with an owner hashed like this player */
+	for (i = house_owner_head[house_owner_hash(p_ptr->name)]; i; i = house_owner_next[i - 1])
 	{
-		if (house_owned_by(p_ptr, i))
+		if (house_owned_by(p_ptr, i - 1))
 		{
 			owned++;
 		}
@@ -534,17 +749,29 @@ int houses_owned(player_type *p_ptr)
  */
 int find_house(int Depth, int x, int y, int offset)
 {
-	int i;
-	
-	for (i = offset; i < num_houses; i++)
+	int i, cell;
+
+	/* Paranoia */
+	if (y < 0 || y >= MAX_HGT || x < 0 || x >= MAX_WID) return -1;
+
+	cell = (y / HOUSE_CELL_HGT) * HOUSE_CELL_COLS + (x / HOUSE_CELL_WID);
+
+	/* Check each house overlapping a cell hashed like this one */
+	for (i = house_cell_head[house_grid_hash(Depth, y / HOUSE_CELL_HGT, x / HOUSE_CELL_WID)];
+		i; i = house_cell_next[i - 1])
 	{
+		int h = (i - 1) / HOUSE_CELLS;
+
+		/* Skip other cells and earlier houses */
+		if ((i - 1) % HOUSE_CELLS != cell || h < offset) continue;
+
 		/* Check the house position *including* the walls */
-		if (houses[i].depth == Depth
-			&& x >= houses[i].x_1-1 && x <= houses[i].x_2+1
-			&& y >= houses[i].y_1-1 && y <= houses[i].y_2+1)
+		if (houses[h].depth == Depth
+			&& x >= houses[h].x_1-1 && x <= houses[h].x_2+1
+			&& y >= houses[h].y_1-1 && y <= houses[h].y_2+1)
 		{
 			/* We found the house this section of wall belongs to */
-			return i;
+			return h;
 		}
 	}
 	return -1;
@@ -635,8 +862,7 @@ bool create_house_door(player_type *p_ptr, int x, int y)
 		if(houses[house].door_y == 0 && houses[house].door_x == 0)
 		{
 			/* No door, so create one! */
-			houses[house].door_y = y;
-			houses[house].door_x = x;
+			set_house_door(house, y, x);
 			c_ptr = &cave[p_ptr->dun_depth][y][x];
 			c_ptr->feat = FEAT_HOME_HEAD;
 			everyone_lite_spot(p_ptr->dun_depth, y, x);
@@ -831,8 +1057,10 @@ bool create_house(player_type *p_ptr)
 	houses[num_houses].depth = p_ptr->dun_depth;
 	houses[num_houses].door_y = 0;
 	houses[num_houses].door_x = 0;
-	set_house_owner(p_ptr, num_houses);
+	houses[num_houses].owned[0] = '\0';
+	house_index_add(num_houses);
 	num_houses++;
+	set_house_owner(p_ptr, num_houses - 1);
 
 	/* Render into the terrain */
 	for (y = y1; y <= y2; y++)
@@ -888,6 +1116,8 @@ bool set_house_owner(player_type *p_ptr, int house)
 
 	/* Set the player as the owner */
 	my_strcpy(houses[house].owned, p_ptr->name, MAX_NAME_LEN+1);
+	house_link(&house_owner_head[house_owner_hash(houses[house].owned)],
+		house_owner_next, house);
 
 	return TRUE;
 }
@@ -903,8 +1133,15 @@ void disown_house(int house)
 	if (house >= 0 && house < num_houses)
 	{
 		Depth = houses[house].depth;
+		if (house_owned(house))
+		{
+			house_unlink(&house_owner_head[house_owner_hash(houses[house].owned)],
+				house_owner_next, house);
+		}
 		houses[house].owned[0] = '\0';
 		houses[house].strength = 0;
+		/* Nothing keeps an empty level around any more */
+		if (!players_on_depth[Depth]) note_level_left(Depth);
 		/* Remove all players from the house */
 		for (i = 1; i <= NumPlayers; i++)
 		{
@@ -3749,7 +3986,7 @@ void do_cmd_fire(player_type *p_ptr, int item, int dir)
 			}
 
 			/* Check the visibility */
-			visible = p_ptr->play_vis[0 - c_ptr->m_idx];
+			visible = bit_has(p_ptr->play_vis, 0 - c_ptr->m_idx);
 
 			/* Note the collision */
 			hit_body = TRUE;
@@ -3810,7 +4047,7 @@ void do_cmd_fire(player_type *p_ptr, int item, int dir)
 			monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 			/* Check the visibility */
-			visible = p_ptr->mon_vis[c_ptr->m_idx];
+			visible = bit_has(p_ptr->mon_vis, c_ptr->m_idx);
 
 			/* Note the collision */
 			hit_body = TRUE;
@@ -3860,7 +4097,7 @@ void do_cmd_fire(player_type *p_ptr, int item, int dir)
 				}
 
 				/* Apply special damage XXX XXX XXX */
-				tdam = tot_dam_aux(p_ptr, o_ptr, tdam, m_ptr, p_ptr->mon_vis[c_ptr->m_idx]);
+				tdam = tot_dam_aux(p_ptr, o_ptr, tdam, m_ptr, bit_has(p_ptr->mon_vis, c_ptr->m_idx));
 				tdam = critical_shot(p_ptr, o_ptr->weight, o_ptr->to_h, tdam);
 
 				/* No negative damage */
@@ -4185,7 +4422,7 @@ void do_cmd_throw(player_type *p_ptr, int item, int dir)
 			q_ptr = Players[0 - c_ptr->m_idx];
 
 			/* Check the visibility */
-			visible = p_ptr->play_vis[0 - c_ptr->m_idx];
+			visible = bit_has(p_ptr->play_vis, 0 - c_ptr->m_idx);
 
 			/* Note the collision */
 			hit_body = TRUE;
@@ -4256,7 +4493,7 @@ void do_cmd_throw(player_type *p_ptr, int item, int dir)
 			monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
 			/* Check the visibility */
-			visible = p_ptr->mon_vis[c_ptr->m_idx];
+			visible = bit_has(p_ptr->mon_vis, c_ptr->m_idx);
 
 			/* Note the collision */
 			hit_body = TRUE;
@@ -4306,7 +4543,7 @@ void do_cmd_throw(player_type *p_ptr, int item, int dir)
 				}
 
 				/* Apply special damage XXX XXX XXX */
-				tdam = tot_dam_aux(p_ptr, o_ptr, tdam, m_ptr, p_ptr->mon_vis[c_ptr->m_idx]);
+				tdam = tot_dam_aux(p_ptr, o_ptr, tdam, m_ptr, bit_has(p_ptr->mon_vis, c_ptr->m_idx));
 				tdam = critical_shot(p_ptr, o_ptr->weight, o_ptr->to_h, tdam);
 
 				/* No negative damage */
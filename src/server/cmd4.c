@@ -258,23 +258,20 @@ void display_houses(player_type *p_ptr, char query)
 	text_out("\n");
 	text_out("\n");
 
-	for (i = 0; i < num_houses; i++) 
+	for (i = next_house_owned(p_ptr, -1); i >= 0; i = next_house_owned(p_ptr, i))
 	{
-		if (house_owned_by(p_ptr, i))
-		{
-			if (j++ < p_ptr->interactive_line) continue;
-			
-			dpt[0] = '\0';
-			wild_cat_depth(houses[i].depth, &dpt[0]);
-			
-			sx = (houses[i].x_1 / SCREEN_WID) * 2;
-			sy = (houses[i].y_1 / SCREEN_HGT) * 2;
-			
-			sprintf(buf, "  %c) House %d %s %s, sector [%d,%d]", index_to_label(j-1), j, 
-					(!houses[i].depth ? "in" : "at"), dpt, sy, sx);
-			text_out(buf);
-			text_out("\n");
-		}
+		if (j++ < p_ptr->interactive_line) continue;
+		
+		dpt[0] = '\0';
+		wild_cat_depth(houses[i].depth, &dpt[0]);
+		
+		sx = (houses[i].x_1 / SCREEN_WID) * 2;
+		sy = (houses[i].y_1 / SCREEN_HGT) * 2;
+		
+		sprintf(buf, "  %c) House %d %s %s, sector [%d,%d]", index_to_label(j-1), j, 
+				(!houses[i].depth ? "in" : "at"), dpt, sy, sx);
+		text_out(buf);
+		text_out("\n");
 	}
 	if (!j)
 		text_out("You do not own any.\n");
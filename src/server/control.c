@@ -238,21 +238,156 @@ static void console_conn(connection_type* ct, char *useless)
 
 	for (iter = first_connection; iter; iter = iter->next)
 	{
-		char buf[80];
+		char buf[120];
 		connection_type* c_ptr = iter->data2; 
 		j++;
-		sprintf(buf, "Connection %d - %s\n", j, c_ptr->host_addr);
+		sprintf(buf, "Connection %d - %s (queued %d, peak %d bytes%s)\n", j, c_ptr->host_addr,
+			cq_len(&c_ptr->wbuf), c_ptr->wbuf_peak, c_ptr->stalled ? ", stalled" : "");
 		cq_printf(&ct->wbuf, "%T", buf);
+		if (c_ptr->zout)
+		{
+			sprintf(buf, "  deflated %lu to %lu bytes (%lu%%) in %ld usec\n",
+				(unsigned long)c_ptr->z_plain, (unsigned long)c_ptr->z_packed,
+				(unsigned long)(c_ptr->z_plain ? (double)c_ptr->z_packed * 100 / c_ptr->z_plain : 0),
+				(long)c_ptr->z_usec);
+			cq_printf(&ct->wbuf, "%T", buf);
+		}
 	}
 }
 
 /*
- * Utility function, change locally as required when testing
+ * Report network syscall counters, and reset them
+ */
+static void console_netstat(connection_type* ct, char *useless)
+{
+	u32b loops = MAX(1, net_stats.loops);
+
+	cq_printf(&ct->wbuf, "%T", format("Backend: %s, %lu loops\n",
+		network_backend(), (unsigned long)net_stats.loops));
+	cq_printf(&ct->wbuf, "%T", format("Per loop: %.2f polls, %.2f events, %.2f ctls\n",
+		(double)net_stats.polls / loops, (double)net_stats.events / loops,
+		(double)net_stats.ctls / loops));
+	cq_printf(&ct->wbuf, "%T", format("Per loop: %.2f accepts, %.2f connects, %.2f recvs, %.2f sends\n",
+		(double)net_stats.accepts / loops, (double)net_stats.connects / loops,
+		(double)net_stats.recvs / loops, (double)net_stats.sends / loops));
+	cq_printf(&ct->wbuf, "%T", format("Host name lookups: %lu\n",
+		(unsigned long)net_stats.resolves));
+
+	WIPE(&net_stats, network_stats);
+}
+
+/*
+ * Report (and reset) the per-turn work counters
  */
 static void console_debug(connection_type* ct, char *useless)
 {
-	return;
+	u32b turns = MAX(1, perf_turns);
+	int i;
+
+	cq_printf(&ct->wbuf, "%T", format("Turns: %lu, %lu usec per turn\n",
+		(unsigned long)perf_turns, (unsigned long)(perf_turn_usec / turns)));
+	cq_printf(&ct->wbuf, "%T", format("Per turn: %.1f monsters processed, %.1f monsters updated\n",
+		(double)perf_mon_process / turns, (double)perf_mon_updates / turns));
+	cq_printf(&ct->wbuf, "%T", format("Per turn: %.1f objects processed, %.2f levels checked, %d levels active\n",
+		(double)perf_obj_process / turns, (double)perf_lvl_checks / turns, num_active_depths));
+	cq_printf(&ct->wbuf, "%T", format("Per turn: %.1f level broadcasts, %.1f players visited (%.1f by a full scan)\n",
+		(double)perf_fanouts / turns, (double)perf_fanout_players / turns, (double)perf_fanout_scan / turns));
+	for (i = 1; i <= NumPlayers; i++)
+	{
+		player_type *p_ptr = Players[i];
+		u32b pturns = MAX(1, p_ptr->map_turns);
+
+		cq_printf(&ct->wbuf, "%T", format("Map updates for %s: %lu packets, %lu bytes (%lu packets, %lu bytes one grid at a time)\n",
+			p_ptr->name, (unsigned long)p_ptr->map_packets, (unsigned long)p_ptr->map_bytes,
+			(unsigned long)p_ptr->map_tile_marks, (unsigned long)p_ptr->map_tile_bytes));
+		cq_printf(&ct->wbuf, "%T", format("  per turn: %.3f packets, %.2f bytes (%.3f packets, %.2f bytes)\n",
+			(double)p_ptr->map_packets / pturns, (double)p_ptr->map_bytes / pturns,
+			(double)p_ptr->map_tile_marks / pturns, (double)p_ptr->map_tile_bytes / pturns));
+
+		p_ptr->map_turns = p_ptr->map_tile_marks = p_ptr->map_tile_bytes = 0;
+		p_ptr->map_packets = p_ptr->map_bytes = 0;
+	}
+	cq_printf(&ct->wbuf, "%T", format("Monsters: %ld live, %ld free, %ld max; objects: %ld live, %ld free, %ld max\n",
+		(long)m_top, (long)m_free_num, (long)m_max, (long)o_top, (long)o_free_num, (long)o_max));
+	cq_printf(&ct->wbuf, "%T", format("Bonus updates: %lu skipped, %lu reused the equipment, %lu full\n",
+		(unsigned long)perf_bonus_hits, (unsigned long)perf_bonus_partial, (unsigned long)perf_bonus_misses));
+	cq_printf(&ct->wbuf, "%T", format("Pathfinding: %lu queries, %lu grids expanded\n",
+		(unsigned long)perf_path_queries, (unsigned long)perf_path_nodes));
+
+	perf_turns = perf_turn_usec = 0;
+	perf_mon_process = perf_mon_updates = 0;
+	perf_obj_process = perf_lvl_checks = 0;
+	perf_fanouts = perf_fanout_players = perf_fanout_scan = 0;
+	perf_bonus_hits = perf_bonus_partial = perf_bonus_misses = 0;
+	perf_path_queries = perf_path_nodes = 0;
+}
+
+#ifdef DEBUG
+/*
+ * Compare text and binary savefiles: write the server state and every
+ * online player in both formats, then parse/load them back.
+ */
+static void console_save_test(connection_type* ct, char *useless)
+{
+	char path[1024];
+	player_type *q_ptr;
+	hostile_type *h_ptr;
+	u32b records, bytes, total;
+	micro save_time, load_time;
+	int binary, i, num;
+	cptr fmt_name[2] = { "text", "binary" };
+
+	for (binary = 0; binary < 2; binary++)
+	{
+		/* Server state (parsed only, loading it would replace the world) */
+		path_build(path, 1024, ANGBAND_DIR_SAVE, "server.test");
+		static_timer(2);
+		if (!save_server_as(path, binary))
+		{
+			cq_printf(&ct->wbuf, "%T", format("Can't write %s\n", path));
+			return;
+		}
+		save_time = static_timer(2);
+		scan_savefile(path, &records, &bytes);
+		load_time = static_timer(2);
+		file_delete(path);
+
+		cq_printf(&ct->wbuf, "%T", format("%s server: %lu bytes, %lu records, save %ld usec, parse %ld usec\n",
+			fmt_name[binary], (unsigned long)bytes, (unsigned long)records, (long)save_time, (long)load_time));
+
+		/* Players (loaded into a scratch player) */
+		path_build(path, 1024, ANGBAND_DIR_SAVE, "player.test");
+		save_time = load_time = 0;
+		total = num = 0;
+		for (i = 1; i <= NumPlayers; i++)
+		{
+			static_timer(2);
+			if (!save_player_as(Players[i], path, binary)) continue;
+			save_time += static_timer(2);
+
+			scan_savefile(path, &records, &bytes);
+			total += bytes;
+
+			q_ptr = player_alloc();
+			my_strcpy(q_ptr->savefile, path, sizeof(q_ptr->savefile));
+			static_timer(2);
+			if (!rd_savefile_new(q_ptr)) num++;
+			load_time += static_timer(2);
+
+			while ((h_ptr = q_ptr->hostile))
+			{
+				q_ptr->hostile = h_ptr->next;
+				KILL(h_ptr);
+			}
+			player_free(q_ptr);
+		}
+		file_delete(path);
+
+		cq_printf(&ct->wbuf, "%T", format("%s players: %d loaded, %lu bytes, save %ld usec, load %ld usec\n",
+			fmt_name[binary], num, (unsigned long)total, (long)save_time, (long)load_time));
+	}
 }
+#endif /* DEBUG */
 
 /*
  * Start listening to game server messages
@@ -491,6 +626,474 @@ static void console_dng_test(connection_type* ct, char *params)
 	cq_printf(&ct->wbuf, "%T", "Done\n");
 }
 
+#ifdef DEBUG
+/*
+ * Levels generated by "test_levels_make()"
+ */
+static bool test_level_made[MAX_DEPTH];
+
+/*
+ * Parse the "[LEVELS] [N]" of a benchmark command, and make sure dungeon
+ * levels 1 to LEVELS exist, generating the missing ones.  Returns the
+ * number of levels, or 0 if the test can't run (the console is told).
+ */
+static int test_levels_make(connection_type* ct, cptr name, char *params, int levels, int *n)
+{
+	int Depth;
+
+	char *param1 = strtok(params, " ");
+	char *param2 = strtok(NULL, " ");
+	if (param1) levels = atoi(param1);
+	if (param2) *n = atoi(param2);
+	if (levels < 1 || levels >= MAX_DEPTH) levels = MAX_DEPTH - 1;
+	if (*n < 1) *n = 1;
+
+	/* Notify */
+	if (NumPlayers > 0)
+	{
+		cq_printf(&ct->wbuf, "%T", format("Can't perform %s with players online!\n", name));
+		return (0);
+	}
+
+	for (Depth = 1; Depth <= levels; Depth++)
+	{
+		test_level_made[Depth] = (cave[Depth] == NULL);
+		if (!test_level_made[Depth]) continue;
+
+		alloc_dungeon_level(Depth);
+		generate_cave(0, Depth, TRUE);
+	}
+
+	return (levels);
+}
+
+/*
+ * Free the levels "test_levels_make()" generated, and only those
+ */
+static void test_levels_free(int levels)
+{
+	int Depth;
+
+	for (Depth = 1; Depth <= levels; Depth++)
+	{
+		if (!test_level_made[Depth]) continue;
+		test_level_made[Depth] = FALSE;
+
+		if (cave[Depth] && !check_special_level(Depth)) dealloc_dungeon_level(Depth);
+	}
+}
+
+/*
+ * Populate N dungeon levels and time monster processing on them.
+ */
+static void console_mon_test(connection_type* ct, char *params)
+{
+	int levels;
+	int turns = 100;
+	int Depth, i, num = 0;
+	micro process_time, update_time;
+
+	if (!(levels = test_levels_make(ct, "montest", params, 16, &turns))) return;
+
+	/* Count the monsters */
+	for (Depth = 1; Depth <= levels; Depth++)
+	{
+		for (i = m_on_depth[Depth]; i; i = m_list[i].next_m_idx) num++;
+	}
+
+	/* Nobody is there, so this should cost (almost) nothing */
+	static_timer(2);
+	for (i = 0; i < turns; i++) process_monsters();
+	process_time = static_timer(2);
+
+	/* What a player on each level would pay to look around */
+	for (i = 0; i < turns; i++)
+	{
+		for (Depth = 1; Depth <= levels; Depth++) update_monsters(Depth, TRUE);
+	}
+	update_time = static_timer(2);
+
+	cq_printf(&ct->wbuf, "%T", format("%d levels, %d monsters, %d turns\n", levels, num, turns));
+	cq_printf(&ct->wbuf, "%T", format("process_monsters: %ld usec per turn\n", (long)(process_time / turns)));
+	cq_printf(&ct->wbuf, "%T", format("update_monsters: %ld usec per turn (all levels)\n", (long)(update_time / turns)));
+
+	/* Clean up */
+	test_levels_free(levels);
+}
+#endif /* DEBUG */
+
+#ifdef DEBUG
+/*
+ * Walk a player around N dungeon levels and time his view updates.
+ */
+static void console_view_test(connection_type* ct, char *params)
+{
+	int levels;
+	int moves = 1000;
+	int Depth, i, j, d, y, x, num = 0, seen = 0, hit = 0;
+	micro view_time = 0, los_time = 0, proj_time = 0;
+	player_type *p_ptr;
+	byte *pos_y, *pos_x;
+
+	if (!(levels = test_levels_make(ct, "viewtest", params, 4, &moves))) return;
+
+	/* A fake player, who never has anything on screen */
+	MAKE(p_ptr, player_type);
+	p_ptr->conn = -1;
+	p_ptr->cur_hgt = MAX_HGT;
+	p_ptr->cur_wid = MAX_WID;
+	p_ptr->panel_row_min = p_ptr->panel_col_min = 1;
+	p_ptr->panel_row_max = p_ptr->panel_col_max = 0;
+
+	C_MAKE(pos_y, moves, byte);
+	C_MAKE(pos_x, moves, byte);
+
+	for (Depth = 1; Depth <= levels; Depth++)
+	{
+		p_ptr->dun_depth = Depth;
+
+		/* Record a walk, with an occasional "teleport" */
+		y = x = 0;
+		for (i = 0; i < moves; i++)
+		{
+			if (!(i % 50) || !cave_floor_bold(Depth, y, x))
+			{
+				do
+				{
+					y = rand_range(1, MAX_HGT - 2);
+					x = rand_range(1, MAX_WID - 2);
+				}
+				while (!cave_floor_bold(Depth, y, x));
+			}
+			else
+			{
+				d = ddd[rand_int(8)];
+				if (cave_floor_bold(Depth, y + ddy[d], x + ddx[d]))
+				{
+					y += ddy[d];
+					x += ddx[d];
+				}
+			}
+			pos_y[i] = y;
+			pos_x[i] = x;
+		}
+
+		/* Replay it */
+		static_timer(2);
+		for (i = 0; i < moves; i++)
+		{
+			p_ptr->py = pos_y[i];
+			p_ptr->px = pos_x[i];
+			update_view(p_ptr);
+			num += p_ptr->view_n;
+		}
+		view_time += static_timer(2);
+		forget_view(p_ptr);
+		static_timer(2);
+
+		/* Look at random nearby grids from the same spots */
+		for (i = 0; i < moves; i++)
+		{
+			for (j = 0; j < 16; j++)
+			{
+				y = pos_y[i] + rand_spread(0, MAX_SIGHT / 2);
+				x = pos_x[i] + rand_spread(0, MAX_SIGHT / 2);
+				if (!in_bounds(Depth, y, x)) continue;
+				if (los(Depth, pos_y[i], pos_x[i], y, x)) seen++;
+			}
+		}
+		los_time += static_timer(2);
+
+		/* And fire bolts at them */
+		for (i = 0; i < moves; i++)
+		{
+			for (j = 0; j < 16; j++)
+			{
+				y = pos_y[i] + rand_spread(0, MAX_SIGHT / 2);
+				x = pos_x[i] + rand_spread(0, MAX_SIGHT / 2);
+				if (!in_bounds(Depth, y, x)) continue;
+				if (projectable(Depth, pos_y[i], pos_x[i], y, x)) hit++;
+			}
+		}
+		proj_time += static_timer(2);
+	}
+
+	cq_printf(&ct->wbuf, "%T", format("%d levels, %d moves, %d grids in view on average\n", levels, moves, num / (levels * moves)));
+	cq_printf(&ct->wbuf, "%T", format("update_view: %ld nsec per call\n", (long)(view_time * 1000 / (levels * moves))));
+	cq_printf(&ct->wbuf, "%T", format("los: %ld nsec per call (%d%% visible)\n", (long)(los_time * 1000 / (levels * moves * 16)), seen * 100 / (levels * moves * 16)));
+	cq_printf(&ct->wbuf, "%T", format("projectable: %ld nsec per call (%d%% arrive)\n", (long)(proj_time * 1000 / (levels * moves * 16)), hit * 100 / (levels * moves * 16)));
+
+	/* Clean up */
+	FREE(pos_y);
+	FREE(pos_x);
+	KILL(p_ptr);
+	test_levels_free(levels);
+}
+#endif /* DEBUG */
+
+#ifdef DEBUG
+/*
+ * Inscribe N items with M different inscriptions, the way loading them does.
+ */
+static void console_quark_test(connection_type* ct, char *params)
+{
+	int items = 50000;
+	int distinct = 2000;
+	int i, j, fail = 0, found = 0;
+	micro hash_time, scan_time;
+	char buf[32];
+
+	char *param1 = strtok(params, " ");
+	char *param2 = strtok(NULL, " ");
+	if (param1) items = atoi(param1);
+	if (param2) distinct = atoi(param2);
+	if (items < 1) items = 1;
+	if (distinct < 1) distinct = 1;
+
+	/* Inscribe */
+	static_timer(2);
+	for (i = 0; i < items; i++)
+	{
+		strnfmt(buf, sizeof(buf), "@q%d !k #test", i % distinct);
+		if (!quark_add(buf)) fail++;
+	}
+	hash_time = static_timer(2);
+
+	/* What a linear search of the table would have cost */
+	for (i = 0; i < items; i++)
+	{
+		strnfmt(buf, sizeof(buf), "@q%d !k #test", i % distinct);
+		for (j = 1; j < quark__num; j++)
+		{
+			if (quark__str[j] && streq(quark__str[j], buf)) break;
+		}
+		if (j < quark__num) found++;
+	}
+	scan_time = static_timer(2);
+
+	cq_printf(&ct->wbuf, "%T", format("%d items, %d inscriptions, %d quarks in use, %d failed\n", items, distinct, quark__num - 1 - quark__free_num, fail));
+	cq_printf(&ct->wbuf, "%T", format("quark_add: %ld nsec per call\n", (long)(hash_time * 1000 / items)));
+	cq_printf(&ct->wbuf, "%T", format("linear search: %ld nsec per call (%d found)\n", (long)(scan_time * 1000 / items), found));
+
+	/* Nothing holds them, so they should all go */
+	static_timer(2);
+	i = quark_compact();
+	cq_printf(&ct->wbuf, "%T", format("quark_compact: freed %d quarks in %ld usec\n", i, (long)static_timer(2)));
+}
+#endif /* DEBUG */
+
+#ifdef DEBUG
+static void console_pack_test(connection_type* ct, char *params)
+{
+	int packets = 100000;
+	int i;
+	micro printf_time, pack_time;
+	cq a, b;
+	char *param1 = strtok(params, " ");
+	if (param1) packets = atoi(param1);
+	if (packets < 1) packets = 1;
+
+	/* Keep the buffers below 16 megabytes each */
+	if (packets > 250000) packets = 250000;
+
+	/* Room for one packet of each kind per iteration */
+	cq_init(&a, packets * 64);
+	cq_init(&b, packets * 64);
+
+	static_timer(2);
+	for (i = 0; i < packets; i++)
+	{
+		cq_printf(&a, "%c%ud%c%c", PKT_CHAR, (u16b)(0x8000 | i), TERM_WHITE, '#');
+		cq_printf(&a, "%c%ud%c%c%c%c", PKT_CHAR, (u16b)(0x8000 | i), TERM_WHITE, '#', TERM_L_DARK, '.');
+		cq_printf(&a, "%c" "%c%c%c", PKT_CURSOR, 1, i, i >> 8);
+		cq_printf(&a, "%c%ud%S", PKT_MESSAGE, (u16b)i, "You hit the kobold.");
+		cq_printf(&a, "%c%d", PKT_MESSAGE_REPEAT, (s16b)i);
+		cq_printf(&a, "%l", (s32b)i);
+	}
+	printf_time = static_timer(2);
+	for (i = 0; i < packets; i++)
+	{
+		cq_pack_c_ud_c_c(&b, PKT_CHAR, (u16b)(0x8000 | i), TERM_WHITE, '#');
+		cq_pack_c_ud_c_c_c_c(&b, PKT_CHAR, (u16b)(0x8000 | i), TERM_WHITE, '#', TERM_L_DARK, '.');
+		cq_pack_c_c_c_c(&b, PKT_CURSOR, 1, i, i >> 8);
+		cq_pack_c_ud_S(&b, PKT_MESSAGE, (u16b)i, "You hit the kobold.");
+		cq_pack_c_ud(&b, PKT_MESSAGE_REPEAT, (u16b)i);
+		cq_pack_l(&b, (u32b)i);
+	}
+	pack_time = static_timer(2);
+
+	cq_printf(&ct->wbuf, "%T", format("%d x 6 packets, %d bytes, output %s\n", packets, a.len,
+		(a.len == b.len && !memcmp(a.buf, b.buf, a.len)) ? "identical" : "DIFFERS"));
+	cq_printf(&ct->wbuf, "%T", format("cq_printf: %ld nsec per packet\n", (long)(printf_time * 1000 / (packets * 6))));
+	cq_printf(&ct->wbuf, "%T", format("cq_pack_*: %ld nsec per packet\n", (long)(pack_time * 1000 / (packets * 6))));
+
+	cq_free(&a);
+	cq_free(&b);
+}
+#endif /* DEBUG */
+
+#ifdef DEBUG
+static void console_scroll_test(connection_type* ct, char *params)
+{
+	static cave_view_type frame[MAX_HGT][MAX_WID], client[MAX_HGT][MAX_WID];
+	int steps = 64;
+	int i, y, x, st, rle, hgt, wid, row, col, dir = 1, bad = 0;
+	long plain = 0, delta = 0;
+	player_type *p_ptr;
+	cq buf;
+
+	char *param1 = strtok(params, " ");
+	if (param1) steps = atoi(param1);
+	if (steps < 1) steps = 1;
+
+	/* Notify */
+	if (NumPlayers < 1 || !IS_PLAYING(Players[1]))
+	{
+		cq_printf(&ct->wbuf, "%T", "Can't perform scrolltest without a player online!\n");
+		return;
+	}
+	p_ptr = Players[1];
+	st = DUNGEON_STREAM_p(p_ptr);
+	rle = streams[st].rle;
+	hgt = MIN(p_ptr->screen_hgt, MAX_HGT);
+	wid = MIN(p_ptr->screen_wid, MAX_WID);
+
+	cq_init(&buf, MAX_WID * 8);
+	C_WIPE(client, MAX_HGT * MAX_WID, cave_view_type);
+
+	/* Sweep the player's level in half-screen steps, like running would */
+	row = col = 0;
+	for (i = 0; i < steps; i++)
+	{
+		for (y = 0; y < hgt; y++)
+		{
+			for (x = 0; x < wid; x++)
+			{
+				byte ta;
+				char tc;
+				frame[y][x].a = frame[y][x].c = 0;
+				if (row + y >= MAX_HGT || col + x >= MAX_WID) continue;
+				map_info(p_ptr, row + y, col + x, &frame[y][x].a, &frame[y][x].c, &ta, &tc, FALSE);
+			}
+
+			/* Whole line, as before (3 bytes of header each) */
+			cq_clear(&buf);
+			plain += 3 + cq_printc(&buf, rle, frame[y], wid);
+
+			/* Changes to what the client has */
+			cq_clear(&buf);
+			delta += 3 + cq_printc_delta(&buf, rle, frame[y], client[y], (y ? client[y - 1] : NULL), wid);
+
+			/* Decode it the way the client would */
+			if (cq_scanc_delta(&buf, rle, client[y], (y ? client[y - 1] : NULL), wid) < wid) bad++;
+			else for (x = 0; x < wid; x++) if (client[y][x].a != frame[y][x].a || client[y][x].c != frame[y][x].c) { bad++; break; }
+		}
+
+		/* Next panel */
+		col += dir * wid / 2;
+		if (col < 0 || col + wid > MAX_WID + wid / 2)
+		{
+			dir = -dir;
+			col += dir * wid / 2;
+			row += hgt / 2;
+			if (row + hgt > MAX_HGT + hgt / 2) row = 0;
+		}
+	}
+	cq_free(&buf);
+
+	cq_printf(&ct->wbuf, "%T", format("%d panels of %dx%d: %ld bytes as lines, %ld bytes as deltas (%ld%%), %d bad lines\n",
+		steps, wid, hgt, plain, delta, plain ? delta * 100 / plain : 0, bad));
+}
+#endif /* DEBUG */
+
+#ifdef DEBUG
+/*
+ * Grids the "pathtest" queries may walk through
+ */
+static bool path_test_pass(void *data, int Depth, int y, int x)
+{
+	return (cave_floor_bold(Depth, y, x));
+}
+
+/*
+ * Compare "path_find()" with the old relaxation pathfinder on
+ * random queries over generated levels.
+ */
+static void console_path_test(connection_type* ct, char *params)
+{
+	int levels;
+	int queries = 1000;
+	int Depth, i, k, y, x, y1, x1, y2, x2, n1, n2;
+	int found = 0, steps = 0, shorter = 0, longer = 0, bad = 0;
+	u32b nodes_new = 0, nodes_old = 0;
+	micro time_new = 0, time_old = 0;
+	byte path[MAX_PF_LENGTH], old_path[MAX_PF_LENGTH];
+
+	if (!(levels = test_levels_make(ct, "pathtest", params, 4, &queries))) return;
+
+	for (Depth = 1; Depth <= levels; Depth++)
+	{
+		for (i = 0; i < queries; i++)
+		{
+			/* Random start, random goal nearby */
+			do
+			{
+				y1 = rand_range(1, MAX_HGT - 2);
+				x1 = rand_range(1, MAX_WID - 2);
+			}
+			while (!cave_floor_bold(Depth, y1, x1));
+			do
+			{
+				y2 = y1 + rand_spread(0, MAX_PF_RADIUS / 2 - 2);
+				x2 = x1 + rand_spread(0, MAX_PF_RADIUS / 2 - 2);
+			}
+			while (!in_bounds(Depth, y2, x2) || !cave_floor_bold(Depth, y2, x2));
+
+			perf_path_nodes = 0;
+			static_timer(2);
+			n1 = path_find(Depth, y1, x1, y2, x2, path_test_pass, NULL, path, MAX_PF_LENGTH - 1);
+			time_new += static_timer(2);
+			nodes_new += perf_path_nodes;
+
+			perf_path_nodes = 0;
+			static_timer(2);
+			n2 = path_find_naive(Depth, y1, x1, y2, x2, path_test_pass, NULL, old_path, MAX_PF_LENGTH - 1);
+			time_old += static_timer(2);
+			nodes_old += perf_path_nodes;
+
+			if (n1 >= 0)
+			{
+				found++;
+				steps += n1;
+
+				/* Walk it */
+				for (y = y1, x = x1, k = 0; k < n1; k++)
+				{
+					y += ddy[path[k]];
+					x += ddx[path[k]];
+					if (!cave_floor_bold(Depth, y, x)) break;
+				}
+				if ((k < n1) || (y != y2) || (x != x2)) bad++;
+			}
+			if ((n1 >= 0) && ((n2 < 0) || (n1 < n2))) shorter++;
+			if ((n2 >= 0) && ((n1 < 0) || (n2 < n1))) longer++;
+		}
+	}
+
+	queries *= levels;
+	cq_printf(&ct->wbuf, "%T", format("%d queries, %d found, %d steps on average\n", queries, found, steps / MAX(1, found)));
+	cq_printf(&ct->wbuf, "%T", format("path_find: %ld nsec, %lu grids expanded per query\n",
+		(long)(time_new * 1000 / queries), (unsigned long)(nodes_new / queries)));
+	cq_printf(&ct->wbuf, "%T", format("old pathfinder: %ld nsec, %lu grids relaxed per query\n",
+		(long)(time_old * 1000 / queries), (unsigned long)(nodes_old / queries)));
+	cq_printf(&ct->wbuf, "%T", format("%d paths shorter than the old ones, %d longer, %d bad\n", shorter, longer, bad));
+
+	/* Clean up */
+	perf_path_nodes = perf_path_queries = 0;
+	test_levels_free(levels);
+}
+#endif /* DEBUG */
+
 static void console_reload(connection_type* ct, char *mod)
 {
 	bool done = FALSE;
@@ -603,6 +1206,7 @@ console_command_ops console_commands[] = {
 	{ "listen",    console_listen,      0, "[CHANNEL]\nAttach self to #public or specified"   },
 	{ "who",       console_who,         0, "\nList players"                                   },
 	{ "conn",      console_conn,        0, "\nList connections"                               },
+	{ "netstat",   console_netstat,     0, "\nReport and reset network syscall counters"      },
 	{ "shutdown",  console_shutdown,    0, "[TIME|NOW]\nKill server in TIME minutes or 'NOW'" },
 	{ "msg",       console_message,     1, "MESSAGE\nBroadcast a message"                     },
 	{ "kick",      console_kick_player, 1, "PLAYERNAME\nKick player from the game"            },
@@ -610,8 +1214,15 @@ console_command_ops console_commands[] = {
 	{ "whois",     console_whois,       1, "PLAYERNAME\nDetailed player information"          },
 	{ "rngtest",   console_rng_test,    0, "\nPerform RNG test"                               },
 #ifdef DEBUG
+	{ "savetest",  console_save_test,   0, "\nTime text and binary savefiles"                 },
 	{ "dngtest",   console_dng_test,    2, "[N] [DEPTH]\nGenerate dungeon N times"            },
+	{ "montest",   console_mon_test,    0, "[LEVELS] [TURNS]\nTime monster processing"        },
+	{ "viewtest",  console_view_test,   0, "[LEVELS] [MOVES]\nTime player view updates"       },
+	{ "quarktest", console_quark_test,  0, "[ITEMS] [DISTINCT]\nTime inscription lookups"     },
+	{ "packtest",  console_pack_test,   0, "[PACKETS]\nTime packet encoding"               },
+	{ "scrolltest", console_scroll_test, 0, "[PANELS]\nMeasure map bytes of a panel-scroll replay" },
+	{ "pathtest",  console_path_test,   0, "[LEVELS] [QUERIES]\nCompare pathfinders on random routes" },
 #endif
-	{ "debug",     console_debug,       0, "\nUnused"                                         },
+	{ "debug",     console_debug,       0, "\nReport and reset per-turn work counters"       },
 };
 int command_len = sizeof(console_commands) / sizeof(console_command_ops);
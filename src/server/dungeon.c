@@ -63,6 +63,61 @@ int count_players(int Depth)
 	return count;
 }
 
+/*
+ * Levels which may have just been left empty, see "note_level_left()"
+ */
+static s16b level_checks[MAX_DEPTH + MAX_WILD];
+static int num_level_checks;
+static bool level_check_world[MAX_DEPTH + MAX_WILD];
+
+/*
+ * Ask "dungeon()" to check whether a level can be deallocated.
+ *
+ * Called whenever a level may have lost its last player, or its last
+ * reason to stay static, so that the whole depth range doesn't have
+ * to be scanned every turn.
+ */
+void note_level_left(int Depth)
+{
+	if (level_check_world[Depth + MAX_WILD]) return;
+
+	level_check_world[Depth + MAX_WILD] = TRUE;
+	level_checks[num_level_checks++] = Depth;
+}
+
+/*
+ * Rebuild the (sorted) list of levels with players on them, and
+ * note the levels which were dropped from it since the last time.
+ */
+static void update_active_depths(void)
+{
+	s16b old_depths[MAX_PLAYERS];
+	int i, j, k, old_num = num_active_depths;
+
+	for (i = 0; i < old_num; i++) old_depths[i] = active_depths[i];
+
+	/* Collect the levels (insertion sort, no duplicates) */
+	num_active_depths = 0;
+	for (i = 1; i <= NumPlayers; i++)
+	{
+		int Depth = Players[i]->dun_depth;
+
+		for (k = num_active_depths; k > 0 && active_depths[k - 1] > Depth; k--) /* loop */;
+		if (k > 0 && active_depths[k - 1] == Depth) continue;
+
+		for (j = num_active_depths++; j > k; j--) active_depths[j] = active_depths[j - 1];
+		active_depths[k] = Depth;
+	}
+
+	/* Notice the levels everybody has left */
+	for (i = 0, k = 0; i < old_num; i++)
+	{
+		while (k < num_active_depths && active_depths[k] < old_depths[i]) k++;
+		if (k < num_active_depths && active_depths[k] == old_depths[i]) continue;
+		note_level_left(old_depths[i]);
+	}
+}
+
 /*
  * Return a "feeling" (or NULL) about an item.  Method 1 (Heavy).
  */
@@ -381,19 +436,17 @@ static void regenmana(player_type *p_ptr, int percent)
  */
 static void regen_monsters(void)
 {
-	int i, frac;
+	int i, k, frac;
 	int time, timefactor;
 
-	/* Regenerate everyone */
-	for (i = 1; i < m_max; i++)
+	/* Regenerate everyone (on levels with players) */
+	for (k = 0; k < num_active_depths; k++)
+	for (i = m_on_depth[active_depths[k]]; i; i = m_list[i].next_m_idx)
 	{
 		/* Check the i'th monster */
 		monster_type *m_ptr = &m_list[i];
 		monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-		/* Skip dead monsters */
-		if (!m_ptr->r_idx) continue;
-
 		/* Check if it's time to regenerate */
 
 		/* Determine basic frequency of regen in game turns */
@@ -434,7 +487,7 @@ static void regen_monsters(void)
 		else
 		{
 			for (frac = 1; frac <= NumPlayers; frac++)
-				Players[frac]->mon_hrt[i] = FALSE;
+				bit_off(Players[frac]->mon_hrt, i);
 		}
 	}
 }
@@ -806,7 +859,7 @@ static int auto_retaliate(player_type *p_ptr)
 			if (c_ptr->m_idx < 0)
 			{
 				/* Skip players we cannot see */
-				if (!p_ptr->play_vis[0 - c_ptr->m_idx]) continue;
+				if (!bit_has(p_ptr->play_vis, 0 - c_ptr->m_idx)) continue;
 
 				/* If they are hostile, they are a fair target */
 				if (pvp_okay(p_ptr, Players[0 - c_ptr->m_idx], 1))
@@ -825,7 +878,7 @@ static int auto_retaliate(player_type *p_ptr)
 			else if(c_ptr->m_idx)
 			{
 				/* Make sure that the player can see this monster */
-				if (!p_ptr->mon_vis[c_ptr->m_idx]) continue;
+				if (!bit_has(p_ptr->mon_vis, c_ptr->m_idx)) continue;
 				
 				targetlist[targets++] = i;
 				if(p_ptr->health_who == c_ptr->m_idx)
@@ -1710,6 +1763,7 @@ static void process_player_end(player_type *p_ptr)
 
 				/* One more person here */
 				players_on_depth[p_ptr->dun_depth]++;
+				player_roster_sync(p_ptr);
 
 				p_ptr->new_level_flag = TRUE;
 			}
@@ -1744,16 +1798,23 @@ static void process_various(void)
 
 	//char buf[1024];
 
+	/* Notice finished background saves */
+	check_snapshot(FALSE);
+
 	/* Save the server state occasionally */
 	if (!(turn.turn % (cfg_fps * 60 * SERVER_SAVE)))
 	{
-		save_server_info();
-
-		/* Save each player */
-		for (i = 1; i <= NumPlayers; i++)
+		/* In the background, if we can */
+		if (!save_snapshot())
 		{
-			/* Save this player */
-			save_player(Players[i]);
+			save_server_info();
+
+			/* Save each player */
+			for (i = 1; i <= NumPlayers; i++)
+			{
+				/* Save this player */
+				save_player(Players[i]);
+			}
 		}
 	}
 
@@ -1781,6 +1842,13 @@ static void process_various(void)
 
 		}
 
+		/* Free unused inscriptions before we run out of them */
+		if (quark__num - quark__free_num > QUARK_MAX * 3 / 4)
+		{
+			i = quark_compact();
+			if (i) plog(format("Freed %d unused quarks", i));
+		}
+
 		/* Update the unique respawn timers */
 		for (i = 1; i < z_info->r_max; i++)
 		{
@@ -1846,6 +1914,7 @@ static void process_various(void)
 						{
 							// unstatic the level
 							players_on_depth[i] = 0;
+							note_level_left(i);
 						}
 					}
 				}
@@ -2024,9 +2093,16 @@ void dungeon(void)
 	}
 
 
-	/* Deallocate any unused levels */
-	for (j = -MAX_WILD+1; j < MAX_DEPTH; j++)
+	/* Notice who is where */
+	update_active_depths();
+
+	/* Deallocate any levels which were just left */
+	for (i = 0; i < num_level_checks; i++)
 	{
+		j = level_checks[i];
+		level_check_world[j + MAX_WILD] = FALSE;
+		perf_lvl_checks++;
+
 		/* Everybody has left a level that is still generated */
 		if (players_on_depth[j] == 0 && cave[j])
 		{
@@ -2037,6 +2113,7 @@ void dungeon(void)
 				dealloc_dungeon_level(j);
 		}
 	}
+	num_level_checks = 0;
 
 	/* Check player's depth info */
 	for (i = 1; i <= NumPlayers; i++)
@@ -2044,6 +2121,7 @@ void dungeon(void)
 		player_type *p_ptr = Players[i];
 		int Depth = p_ptr->dun_depth;
 		int x, y, startx, starty;
+		int next_m_idx;
 
 		if (players_on_depth[Depth] == 0) continue;
 
@@ -2073,15 +2151,7 @@ void dungeon(void)
 		}
 
 		/* Clear the "marked" and "lit" flags for each cave grid */
-		for (y = 0; y < MAX_HGT; y++)
-		{
-			for (x = 0; x < MAX_WID; x++)
-			{
-				w_ptr = &p_ptr->cave_flag[y][x];
-
-				*w_ptr = 0;
-			}
-		}
+		C_WIPE(p_ptr->cave_flag, MAX_HGT * MAX_WID, byte);
 
 		/* hack -- update night/day in wilderness levels */
 		if ((Depth < 0) && (IS_DAY)) wild_apply_day(Depth); 
@@ -2095,17 +2165,15 @@ void dungeon(void)
 			setup_panel(p_ptr, FALSE);
 
 			/* Memorize the town for this player (if daytime) */
-			for (y = 0; y < MAX_HGT; y++)
-			{
-				for (x = 0; x < MAX_WID; x++)
-				{
-					w_ptr = &p_ptr->cave_flag[y][x];
-					c_ptr = &cave[Depth][y][x];
+			w_ptr = &p_ptr->cave_flag[0][0];
+			c_ptr = &cave[Depth][0][0];
 
-					/* Memorize if daytime or "interesting" */
-					if (dawn || (!is_boring(c_ptr->feat)) || c_ptr->info & CAVE_ROOM)
-						*w_ptr |= CAVE_MARK;
-				}
+			/* Hack -- the level is a single block of grids */
+			for (i = 0; i < MAX_HGT * MAX_WID; i++, w_ptr++, c_ptr++)
+			{
+				/* Memorize if daytime or "interesting" */
+				if (dawn || (!is_boring(c_ptr->feat)) || c_ptr->info & CAVE_ROOM)
+					*w_ptr |= CAVE_MARK;
 			}
 		}
 		else
@@ -2209,13 +2277,13 @@ void dungeon(void)
 			case LEVEL_RAND:
 
 				/* Remove nearby hounds */
-				for (j = 1; j < m_max; j++)
+				for (j = m_on_depth[Depth]; j; j = next_m_idx)
 				{
 					monster_type	*m_ptr = &m_list[j];
 					monster_race	*r_ptr = &r_info[m_ptr->r_idx];
-		
-					/* Paranoia -- Skip dead monsters */
-					if (!m_ptr->r_idx) continue;
+
+					/* Acquire next monster */
+					next_m_idx = m_ptr->next_m_idx;
 
 					/* Hack -- Skip Unique Monsters */
 					if (r_ptr->flags1 & RF1_UNIQUE) continue;
@@ -2223,9 +2291,6 @@ void dungeon(void)
 					/* Skip monsters other than hounds */
 					if (r_ptr->d_char != 'Z') continue;
 
-					/* Skip monsters not on this depth */
-					if (p_ptr->dun_depth != m_ptr->dun_depth) continue;
-
 					/* Approximate distance */
 					dy = (p_ptr->py > m_ptr->fy) ? (p_ptr->py - m_ptr->fy) : (m_ptr->fy - p_ptr->py);
 					dx = (p_ptr->px > m_ptr->fx) ? (p_ptr->px - m_ptr->fx) : (m_ptr->fx - p_ptr->px);
@@ -2258,7 +2323,8 @@ void dungeon(void)
 		forget_lite(p_ptr);
 		update_view(p_ptr);
 		update_lite(p_ptr);
-		update_monsters(TRUE);
+		forget_monsters_elsewhere(p_ptr);
+		update_monsters(Depth, TRUE);
 		update_players();
 
 		p_ptr->window |= (PW_ITEMLIST);
@@ -2514,6 +2580,9 @@ void shutdown_server(void)
 
 	plog("Shutting down.");
 
+	/* Let the background save finish first */
+	check_snapshot(TRUE);
+
 	/* Kick every player out and save his game */
 	while(NumPlayers > 0)
 	{
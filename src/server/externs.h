@@ -148,12 +148,26 @@ extern bool scan_objects;
 extern s16b inven_nxt;
 /*extern s16b inven_cnt;
 extern s16b equip_cnt;*/
-extern s32b o_nxt;
-extern s32b m_nxt;
 extern s32b o_max;
 extern s32b m_max;
 extern s32b o_top;
 extern s32b m_top;
+extern s32b o_free_num;
+extern s32b m_free_num;
+extern u32b perf_turns;
+extern u32b perf_turn_usec;
+extern u32b perf_mon_process;
+extern u32b perf_mon_updates;
+extern u32b perf_obj_process;
+extern u32b perf_lvl_checks;
+extern u32b perf_fanouts;
+extern u32b perf_fanout_players;
+extern u32b perf_fanout_scan;
+extern u32b perf_bonus_hits;
+extern u32b perf_bonus_partial;
+extern u32b perf_bonus_misses;
+extern u32b perf_path_queries;
+extern u32b perf_path_nodes;
 extern s32b p_max;
 extern maxima *z_info;
 extern u32b eq_name_size;
@@ -185,6 +199,9 @@ extern s16b cfg_max_townies;
 extern s16b cfg_max_trees;
 extern s16b cfg_max_houses;
 extern bool cfg_chardump_color;
+extern bool cfg_binary_saves;
+extern bool cfg_snapshot_saves;
+extern s16b cfg_compress_level;
 extern s16b cfg_pvp_hostility;
 extern bool cfg_pvp_notify;
 extern s16b cfg_pvp_safehostility;
@@ -255,6 +272,9 @@ extern bool *macro__cmd;
 extern char *macro__buf;
 extern s16b quark__num;
 extern cptr *quark__str;
+extern s16b *quark__hash;
+extern s16b *quark__free;
+extern s16b quark__free_num;
 extern u16b message__next;
 extern u16b message__last;
 extern u16b message__head;
@@ -266,9 +286,18 @@ extern u32b option_mask[8];
 extern u32b window_flag[8];
 extern u32b window_mask[8];*/
 /*extern term *ang_term[8];*/
-extern s16b o_fast[MAX_O_IDX];
-extern s16b m_fast[MAX_M_IDX];
+extern s16b o_free[MAX_O_IDX];
+extern u32b o_freed[BIT_WORDS(MAX_O_IDX)];
+extern s16b *o_on_depth;
+extern s16b m_free[MAX_M_IDX];
+extern u32b m_freed[BIT_WORDS(MAX_M_IDX)];
+extern s16b *m_on_depth;
+extern s16b *m_num_depth;
+extern player_type **p_on_depth;
+extern s16b active_depths[MAX_PLAYERS];
+extern int num_active_depths;
 extern cave_type ***cave;
+extern flow_type **level_flow;
 extern wilderness_type *wild_info;
 extern hturn *turn_cavegen;
 extern object_type *o_list;
@@ -385,6 +414,7 @@ extern void player_verify_visual(player_type *p_ptr);
 
 /* cave.c */
 extern int distance(int y1, int x1, int y2, int x2);
+extern void init_los_table(void);
 extern bool los(int Depth, int y1, int x1, int y2, int x2);
 extern bool player_can_see_bold(player_type *p_ptr, int y, int x);
 extern bool no_lite(player_type *p_ptr);
@@ -395,6 +425,10 @@ extern void print_rel(char c, byte a, int y, int x);
 extern void cave_set_feat(int Depth, int y, int x, int feat);
 extern void spot_updates(int Depth, int y, int x, u32b updates);
 extern void note_spot(player_type *p_ptr, int y, int x);
+extern void player_roster_add(player_type *p_ptr);
+extern void player_roster_remove(player_type *p_ptr);
+extern void player_roster_sync(player_type *p_ptr);
+extern player_type *player_roster(int Depth);
 extern void note_spot_depth(int Depth, int y, int x);
 extern void everyone_lite_spot(int Depth, int y, int x);
 extern void everyone_forget_spot(int Depth, int y, int x);
@@ -406,8 +440,9 @@ extern void forget_lite(player_type *p_ptr);
 extern void update_lite(player_type *p_ptr);
 extern void forget_view(player_type *p_ptr);
 extern void update_view(player_type *p_ptr);
-extern void forget_flow(void);
-extern void update_flow(void);
+extern void forget_flow(int Depth);
+extern flow_type *update_flow(int Depth);
+extern void wipe_flow(int Depth);
 extern void wiz_lite(player_type *p_ptr);
 extern void wiz_dark(player_type *p_ptr);
 extern void mmove2(int *y, int *x, int y1, int x1, int y2, int x2);
@@ -449,6 +484,12 @@ extern bool house_owned_by(player_type *p_ptr, int house);
 extern bool set_house_owner(player_type *p_ptr, int house);
 extern bool create_house(player_type *p_ptr);
 extern int houses_owned(player_type *p_ptr);
+extern int find_house(int Depth, int x, int y, int offset);
+extern int next_house_owned(player_type *p_ptr, int house);
+extern bool level_has_owned_house(int Depth);
+extern void house_index_add(int house);
+extern void house_index_rebuild(void);
+extern void set_house_door(int house, int y, int x);
 extern void disown_house(int house);
 extern void do_cmd_go_up(player_type *p_ptr);
 extern void do_cmd_go_down(player_type *p_ptr);
@@ -558,6 +599,14 @@ extern void do_cmd_activate_dir(player_type *p_ptr, int item, int dir);
 extern void do_cmd_refill_potion(player_type *p_ptr, int item);
 
 /* pathfind.c */
+extern int path_find(int Depth, int y1, int x1, int y2, int x2,
+	bool (*pass)(void *data, int Depth, int y, int x), void *data,
+	byte *path, int max);
+#ifdef DEBUG
+extern int path_find_naive(int Depth, int y1, int x1, int y2, int x2,
+	bool (*pass)(void *data, int Depth, int y, int x), void *data,
+	byte *path, int max);
+#endif
 extern bool findpath(player_type *p_ptr, int y, int x);
 
 /* control.c */
@@ -572,6 +621,7 @@ extern bool check_special_level(s16b special_depth);
 extern int find_player_name(char *name);
 extern int find_player(s32b id);
 extern int count_players(int Depth);
+extern void note_level_left(int Depth);
 
 /* files.c */
 extern void safe_setuid_drop(void);
@@ -655,6 +705,7 @@ extern errr rd_savefile_new(player_type *p_ptr);
 extern errr rd_server_savefile(void);
 extern errr rd_savefile_new_scoop_aux(char *sfile, char *pass_word);
 extern bool rd_dungeon_special_ext(int Depth, cptr levelname);
+extern errr scan_savefile(cptr sfile, u32b *records, u32b *bytes);
 
 /* melee1.c */
 /* melee2.c */
@@ -668,18 +719,22 @@ extern void display_roff(int r_idx);
 
 /* monster.c */
 extern void describe_monster(player_type *p_ptr, int m_ind, bool spoilers);
+extern void link_monster(int m_idx);
+extern void unlink_monster(int m_idx);
 extern void delete_monster_idx(int i);
 extern void delete_monster(int Depth, int y, int x);
 extern void compact_monsters(int size);
 extern void wipe_m_list(int Depth);
 extern s16b m_pop(void);
+extern void m_release(int m_idx);
 extern errr get_mon_num_prep(void);
 extern s16b get_mon_num(int level);
 extern void monster_desc(player_type *p_ptr, char *desc, int m_idx, int mode);
 extern void lore_do_probe(player_type *p_ptr, int m_idx);
 extern void lore_treasure(player_type *p_ptr, int m_idx, int num_item, int num_gold);
 extern void update_mon(int m_idx, bool dist);
-extern void update_monsters(bool dist);
+extern void update_monsters(int Depth, bool dist);
+extern void forget_monsters_elsewhere(player_type *p_ptr);
 extern void update_player(player_type *p_ptr);
 extern void update_players(void);
 extern bool place_monster_aux(int Depth, int y, int x, int r_idx, bool slp, bool grp);
@@ -717,6 +772,7 @@ extern void display_monlist(player_type *p_ptr);
 extern void setup_network_server();
 extern void network_loop();
 extern void close_network_server();
+extern void forget_network_server();
 extern void report_to_meta_die(void);
 extern int player_leave(int p_idx);
 extern int player_disconnect(player_type *p_ptr, cptr reason);
@@ -726,6 +782,9 @@ extern int process_player_commands(player_type *p_ptr);
 extern int stream_char_raw(player_type *p_ptr, int st, int y, int x, byte a, char c, byte ta, char tc);
 extern int stream_char(player_type *p_ptr, int st, int y, int x);
 extern int stream_line_as(player_type *p_ptr, int st, int y, int x);
+extern int stream_span(player_type *p_ptr, int st, int y, int x, int n);
+extern void stream_flush_tiles(player_type *p_ptr);
+extern bool stream_congested(player_type *p_ptr);
 extern int send_term_info(player_type *p_ptr, byte flag, u16b line);
 extern int send_term_header(player_type *p_ptr, byte hint, cptr header);
 extern int send_term_writefile(connection_type *ct, byte fmode, cptr filename);
@@ -797,12 +856,15 @@ extern void display_equip(player_type *p_ptr);
 extern void show_equip(void);
 extern void toggle_inven_equip(void);
 extern bool get_item(player_type *p_ptr, int *cp, cptr pmt, bool equip, bool inven, bool floor);*/
+extern void link_object(int o_idx);
+extern void unlink_object(int o_idx);
 extern void delete_object_idx(int i);
 extern void delete_object_ptr(object_type * o_ptr);
 extern void delete_object(int Depth, int y, int x);
 extern void compact_objects(int size);
 extern void wipe_o_list(int Depth);
 extern s16b o_pop(void);
+extern void o_release(int o_idx);
 extern errr get_obj_num_prep(void);
 extern s16b get_obj_num(int level);
 extern bool object_is_fuel(player_type *p_ptr, object_type *o_ptr, bool *fits);
@@ -864,6 +926,7 @@ extern bool remove_hostility(player_type *p_ptr, cptr name);
 extern bool check_hostile(player_type *attacker, player_type *target);
 extern cptr lookup_player_name(int id);
 extern int lookup_player_id(cptr name);
+extern void reserve_player_names(int num);
 extern void add_player_name(cptr name, int id);
 extern void delete_player_id(int id);
 extern void delete_player_name(cptr name);
@@ -881,6 +944,10 @@ extern bool load_player(player_type *p_ptr);
 extern bool load_server_info(void);
 extern bool save_server_info(void);
 extern bool wr_dungeon_special_ext(int Depth, cptr levelname);
+extern bool save_player_as(player_type *p_ptr, char *name, bool binary);
+extern bool save_server_as(char *name, bool binary);
+extern bool save_snapshot(void);
+extern void check_snapshot(bool wait);
 
 
 /* spells1.c */
@@ -1015,8 +1082,11 @@ extern void ascii_to_text(char *buf, cptr str);
 extern void keymap_init(void);
 extern void macro_add(cptr pat, cptr act, bool cmd_flag);
 extern char inkey(void);
+extern int alloc_level_end(alloc_entry *table, int size, int level);
+extern int alloc_pick(alloc_entry *table, int lo, int hi, u32b value);
 extern cptr quark_str(s16b num);
 extern s16b quark_add(cptr str);
+extern int quark_compact(void);
 extern void fill_prevent_inscription(bool *arr, s16b quark);
 extern void update_prevent_inscriptions(player_type *p_ptr);
 extern bool check_guard_inscription( s16b quark, char what);
@@ -1194,29 +1194,26 @@ errr file_character_server(player_type *p_ptr, cptr name)
 
 	/* Dump house inventory */
 	file_putf(fff, "%s", "  [Home Inventory]\n");
-	for (i = 0; i < num_houses; i++)
+	for (i = next_house_owned(p_ptr, -1); i >= 0; i = next_house_owned(p_ptr, i))
 	{
-		if (house_owned_by(p_ptr, i))
-		{
-			int Depth = houses[i].depth;
-			cave_type *c_ptr;
+		int Depth = houses[i].depth;
+		cave_type *c_ptr;
 
-			file_putf(fff, "%s", "\n"); j = 0;
-			for(y=houses[i].y_1; y<=houses[i].y_2;y++)
+		file_putf(fff, "%s", "\n"); j = 0;
+		for(y=houses[i].y_1; y<=houses[i].y_2;y++)
+		{
+			for(x=houses[i].x_1; x<=houses[i].x_2;x++)
 			{
-				for(x=houses[i].x_1; x<=houses[i].x_2;x++)
+				/* Paranoia -- unallocated Depth */
+				if (!cave[Depth]) continue;
+				c_ptr = &cave[Depth][y][x];
+				if (c_ptr->o_idx)
 				{
-					/* Paranoia -- unallocated Depth */
-					if (!cave[Depth]) continue;
-					c_ptr = &cave[Depth][y][x];
-					if (c_ptr->o_idx)
-					{
-						if (j > 12) { file_putf(fff, "%s", "\n"); j = 0; }
-						object_desc(0, o_name, sizeof(o_name), &o_list[c_ptr->o_idx], TRUE, 3);
-						file_putf(fff, "%c%s %s\n",
-			        		index_to_label(j), paren, o_name);
-						j++;
-					}
+					if (j > 12) { file_putf(fff, "%s", "\n"); j = 0; }
+					object_desc(0, o_name, sizeof(o_name), &o_list[c_ptr->o_idx], TRUE, 3);
+					file_putf(fff, "%c%s %s\n",
+		        		index_to_label(j), paren, o_name);
+					j++;
 				}
 			}
 		}
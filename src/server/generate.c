@@ -3709,6 +3709,7 @@ static void build_store(int n, int yy, int xx)
 
 			/* One more house */
 			num_houses++;
+			house_index_add(num_houses - 1);
 		}
 		else
 		{
@@ -4046,22 +4047,55 @@ static void town_gen(void)
 
 
 
+/*
+ * Dungeon level storage
+ *
+ * Each level is a single block, holding the array of row pointers
+ * followed by all the grids, so "cave[Depth][y][x]" works as before
+ * and full-level scans walk memory in order.
+ *
+ * Players taking stairs allocate and free levels all the time, so freed
+ * blocks are wiped and kept for reuse (up to LEVEL_POOL_MAX of them).
+ */
+#define LEVEL_POOL_MAX	16
+#define LEVEL_ROWS_SIZE	(MAX_HGT * sizeof(cave_type *))
+#define LEVEL_SIZE	(LEVEL_ROWS_SIZE + MAX_HGT * MAX_WID * sizeof(cave_type))
+static cave_type **level_pool[LEVEL_POOL_MAX];
+static int level_pool_num = 0;
+
 /*
  * Allocate the space needed for a dungeon level
  */
 void alloc_dungeon_level(int Depth)
 {
+	cave_type **rows;
+	cave_type *grids;
 	int i;
 
-	/* Allocate the array of rows */
-	C_MAKE(cave[Depth], MAX_HGT, cave_type *);
+	/* Reuse a wiped level */
+	if (level_pool_num)
+	{
+		rows = level_pool[--level_pool_num];
+	}
 
-	/* Allocate each row */
-	for (i = 0; i < MAX_HGT; i++)
+	/* Allocate a new one */
+	else
 	{
-		/* Allocate it */
-		C_MAKE(cave[Depth][i], MAX_WID, cave_type);
+		rows = (cave_type **)ralloc(LEVEL_SIZE);
+		grids = (cave_type *)((char *)rows + LEVEL_ROWS_SIZE);
+		C_WIPE(grids, MAX_HGT * MAX_WID, cave_type);
+
+		/* Point each row into the block */
+		for (i = 0; i < MAX_HGT; i++)
+		{
+			rows[i] = &grids[i * MAX_WID];
+		}
 	}
+
+	cave[Depth] = rows;
+
+	/* Make sure it gets deallocated if nobody shows up */
+	note_level_left(Depth);
 }
 
 /*
@@ -4069,18 +4103,9 @@ void alloc_dungeon_level(int Depth)
  */
 void dealloc_dungeon_level(int Depth)
 {
-	int i;
-
 	/* Hack to compensate for the half baked hacks below! */
 	/* Don't deallocate levels which contain houses owned by players */
-	for (i = 0; i < num_houses; i++)
-	{
-		/* House on this depth and owned? */
-		if (houses[i].depth == Depth && house_owned(i))
-		{
-			return;
-		}
-	}
+	if (level_has_owned_house(Depth)) return;
 	
 	/* Delete any monsters on that level */
 	/* Hack -- don't wipe wilderness monsters */
@@ -4090,15 +4115,21 @@ void dealloc_dungeon_level(int Depth)
 	/* Hack -- don't wipe wilderness objects */
 	if (Depth > 0) wipe_o_list(Depth);
 
-	/* Free up the space taken by each row */
-	for (i = 0; i < MAX_HGT; i++)
+	/* Keep the space for another level */
+	if (level_pool_num < LEVEL_POOL_MAX)
+	{
+		C_WIPE(cave[Depth][0], MAX_HGT * MAX_WID, cave_type);
+		level_pool[level_pool_num++] = cave[Depth];
+	}
+
+	/* Deallocate it */
+	else
 	{
-		/* Dealloc that row */
-		FREE(cave[Depth][i]);
+		FREE(cave[Depth]);
 	}
 
-	/* Deallocate the array of rows */
-	FREE(cave[Depth]);
+	/* Forget the monster flow */
+	wipe_flow(Depth);
 
 	/* Set that level to "ungenerated" */
 	cave[Depth] = NULL; 
@@ -4253,7 +4284,7 @@ void generate_cave(player_type *p_ptr, int Depth, int auto_scum)
 
 
 		/* Prevent object over-flow */
-		if (o_max >= MAX_O_IDX)
+		if (o_top >= MAX_O_IDX - 1)
 		{
 			/* Message */
 			why = "too many objects";
@@ -4263,7 +4294,7 @@ void generate_cave(player_type *p_ptr, int Depth, int auto_scum)
 		}
 
 		/* Prevent monster over-flow */
-		if (m_max >= MAX_M_IDX)
+		if (m_top >= MAX_M_IDX - 1)
 		{
 			/* Message */
 			why = "too many monsters";
@@ -4313,11 +4344,11 @@ void generate_cave(player_type *p_ptr, int Depth, int auto_scum)
 		wipe_m_list(Depth);
 
 		/* Compact some objects, if necessary */
-		if (o_max >= MAX_O_IDX * 3 / 4)
+		if (o_top >= MAX_O_IDX * 3 / 4)
 			compact_objects(32);
 
 		/* Compact some monsters, if necessary */
-		if (m_max >= MAX_M_IDX * 3 / 4)
+		if (m_top >= MAX_M_IDX * 3 / 4)
 			compact_monsters(32);
 	}
 
@@ -37,6 +37,7 @@
 
 extern errr init_info_txt(ang_file* fp, char *buf, header *head,
                           parse_info_txt_func parse_info_txt_line);
+extern void init_info_log(cptr str);
 
 #ifdef ALLOW_TEMPLATES
 extern errr parse_z_info(char *buf, header *head);
@@ -53,12 +54,6 @@ extern errr parse_b_info(char *buf, header *head);
 extern errr parse_g_info(char *buf, header *head);
 extern errr parse_flavor_info(char *buf, header *head);
 
-/*
- * Error tracking
- */
-extern s16b error_idx;
-extern s16b error_line;
-
 #endif /* ALLOW_TEMPLATES */
 
 
@@ -38,13 +38,6 @@
 
 #include "init.h"
 
-/*
- * Hack -- error tracking
- */
-extern s16b error_idx;
-extern s16b error_line;
-
-
 /*
  * Hack -- size of the "fake" arrays
  */
@@ -592,10 +585,10 @@ errr init_info_txt(ang_file* fp, char *buf, header *head,
 	bool okay = FALSE;
 
 	/* Just before the first record */
-	error_idx = -1;
+	head->error_idx = -1;
 
 	/* Just before the first line */
-	error_line = 0;
+	head->error_line = 0;
 
 
 	/* Prepare the "fake" stuff */
@@ -606,7 +599,7 @@ errr init_info_txt(ang_file* fp, char *buf, header *head,
 	while (file_getl(fp, buf, 1024))
 	{
 		/* Advance the line number */
-		error_line++;
+		head->error_line++;
 
 		/* Skip comments and blank lines */
 		if (!buf[0] || (buf[0] == '#')) continue;
@@ -954,13 +947,13 @@ errr parse_v_info(char *buf, header *head)
 		i = atoi(buf+2);
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		v_ptr = (vault_type*)head->info_ptr + i;
@@ -1094,13 +1087,13 @@ errr parse_c_info(char *buf, header *head)
 		i = atoi(buf+2);
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		pc_ptr = (player_class*)head->info_ptr + i;
@@ -1427,16 +1420,16 @@ errr parse_h_info(char *buf, header *head)
 		int prv, nxt, prc, soc;
 
 		/* Hack - get the index */
-		i = error_idx + 1;
+		i = head->error_idx + 1;
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		h_ptr = (hist_type*)head->info_ptr + i;
@@ -1527,13 +1520,13 @@ errr parse_b_info(char *buf, header *head)
 		i = (i * z_info->b_max) + j;
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		ot_ptr = (owner_type*)head->info_ptr + i;
@@ -1607,16 +1600,16 @@ errr parse_g_info(char *buf, header *head)
 		while (j-- > 0)
 		{
 			/* Hack - get the index */
-			i = error_idx + 1;
+			i = head->error_idx + 1;
 
 			/* Verify information */
-			if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+			if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 			/* Verify information */
 			if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 			/* Save the index */
-			error_idx = i;
+			head->error_idx = i;
 
 			/* Point at the "info" */
 			g_ptr = (byte*)head->info_ptr + i;
@@ -1681,13 +1674,13 @@ errr parse_f_info(char *buf, header *head)
 		i = atoi(buf+2);
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		f_ptr = (feature_type*)head->info_ptr + i;
@@ -1820,13 +1813,13 @@ errr parse_p_info(char *buf, header *head)
 		i = atoi(buf+2);
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		pr_ptr = (player_race*)head->info_ptr + i;
@@ -2030,6 +2023,19 @@ errr parse_p_info(char *buf, header *head)
 
 
 
+/*
+ * Complain about an unknown flag.  This runs on the loader threads (see
+ * "init_info_run()"), so the message can't be built with "format()".
+ */
+static void unknown_flag(cptr kind, cptr what)
+{
+	char buf[160];
+
+	strnfmt(buf, sizeof(buf), "Unknown %s '%s'.", kind, what);
+	init_info_log(buf);
+}
+
+
 /*
  * Grab one flag in an object_kind from a textual string
  */
@@ -2080,7 +2086,7 @@ static errr grab_one_kind_flag(object_kind *k_ptr, cptr what)
     */
 
 	/* Oops */
-	plog(format("Unknown object flag '%s'.", what));
+	unknown_flag("object flag", what);
 
 	/* Error */
 	return (1);
@@ -2118,13 +2124,13 @@ errr parse_k_info(char *buf, header *head)
 		i = atoi(buf+2);
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		k_ptr = (object_kind*)head->info_ptr + i;
@@ -2370,7 +2376,7 @@ static errr grab_one_artifact_flag(artifact_type *a_ptr, cptr what)
     */
 
 	/* Oops */
-	plog(format("Unknown artifact flag '%s'.", what));
+	unknown_flag("artifact flag", what);
 
 	/* Error */
 	return (1);
@@ -2394,7 +2400,7 @@ static errr grab_one_activation(artifact_type *a_ptr, cptr what)
 	}
 
 	/* Oops */
-	plog(format("Unknown artifact activation '%s'.", what));
+	unknown_flag("artifact activation", what);
 
 	/* Error */
 	return (1);
@@ -2432,13 +2438,13 @@ errr parse_a_info(char *buf, header *head)
 		i = atoi(buf+2);
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		a_ptr = (artifact_type*)head->info_ptr + i;
@@ -2644,7 +2650,7 @@ static bool grab_one_ego_item_flag(ego_item_type *e_ptr, cptr what)
     */
 
 	/* Oops */
-	plog(format("Unknown ego-item flag '%s'.", what));
+	unknown_flag("ego-item flag", what);
 
 	/* Error */
 	return (1);
@@ -2684,13 +2690,13 @@ errr parse_e_info(char *buf, header *head)
 		i = atoi(buf+2);
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		e_ptr = (ego_item_type*)head->info_ptr + i;
@@ -2873,7 +2879,7 @@ static errr grab_one_basic_flag(monster_race *r_ptr, cptr what)
 	}
 
 	/* Oops */
-	plog(format("Unknown monster flag '%s'.", what));
+	unknown_flag("monster flag", what);
 
 	/* Failure */
 	return (1);
@@ -2917,7 +2923,7 @@ static errr grab_one_spell_flag(monster_race *r_ptr, cptr what)
 	}
 
 	/* Oops */
-	plog(format("Unknown monster flag '%s'.", what));
+	unknown_flag("monster flag", what);
 
 	/* Failure */
 	return (1);
@@ -2955,13 +2961,13 @@ errr parse_r_info(char *buf, header *head)
 		i = atoi(buf+2);
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		r_ptr = (monster_race*)head->info_ptr + i;
@@ -3269,13 +3275,13 @@ errr parse_flavor_info(char *buf, header *head)
 		if ((result != 2) && (result != 3)) return (PARSE_ERROR_GENERIC);
 
 		/* Verify information */
-		if (i <= error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
+		if (i <= head->error_idx) return (PARSE_ERROR_NON_SEQUENTIAL_RECORDS);
 
 		/* Verify information */
 		if (i >= head->info_num) return (PARSE_ERROR_TOO_MANY_ENTRIES);
 
 		/* Save the index */
-		error_idx = i;
+		head->error_idx = i;
 
 		/* Point at the "info" */
 		flavor_ptr = (flavor_type*)head->info_ptr + i;
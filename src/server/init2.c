@@ -4,6 +4,25 @@
 
 #include "mangband.h"
 
+/* Data tables can be mapped straight from the binary image */
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+#define USE_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* Data tables can be parsed on several threads */
+#if defined(HAVE_PTHREAD_H) && defined(HAVE_LIBPTHREAD)
+#define USE_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#if defined(HAVE_SYS_TIME_H) && defined(HAVE_GETTIMEOFDAY)
+#include <sys/time.h>
+#endif
+
 
 /*
  * This file is used to initialize various variables and arrays for the
@@ -368,13 +387,6 @@ static void note(cptr str)
 #ifdef ALLOW_TEMPLATES
 
 
-/*
- * Hack -- help give useful error messages
- */
-s16b error_idx;
-s16b error_line;
-
-
 /*
  * Hack -- help initialize the fake "name" and "text" arrays when
  * parsing an "ascii" template file.
@@ -433,59 +445,339 @@ header flavor_head;
 
 
 /*
- * Initialize a "*_info" array, by parsing a binary "image" file
+ * All the "*_info" arrays share a single binary image, "info.raw" in the
+ * "lib/data" directory.  The image starts with a table of contents, and
+ * every array's header starts on a page boundary, followed by its "info",
+ * "name" and "text" blocks.  Where possible the image is mapped privately
+ * into memory and the arrays are used in place, so startup does no copying
+ * and untouched pages are shared with the page cache.
+ *
+ * Each contents entry remembers a hash of the "lib/edit" template the array
+ * was parsed from, so editing a template rebuilds the image automatically.
+ */
+#define INFO_IMAGE_MAGIC	0x4D424E44L	/* "MBND" */
+#define INFO_IMAGE_ALIGN	4096
+#define INFO_IMAGE_MAX		16
+
+typedef struct info_image_entry info_image_entry;
+typedef struct info_image_toc info_image_toc;
+
+struct info_image_entry
+{
+	char name[16];		/* Template name, e.g. "monster" */
+	u32b hash;		/* Hash of the template file */
+	u32b offset;		/* Offset of the header in the image */
+};
+
+struct info_image_toc
+{
+	u32b magic;		/* INFO_IMAGE_MAGIC */
+	u32b size;		/* Size of the whole image */
+	u32b num;		/* Number of entries */
+	info_image_entry entry[INFO_IMAGE_MAX];
+};
+
+/* The loaded image, if any */
+static char *info_image = NULL;
+static u32b info_image_size = 0;
+#ifdef USE_MMAP
+static bool info_image_mapped = FALSE;
+#endif
+
+/* The arrays initialized so far, to dump a fresh image */
+static info_image_entry info_table[INFO_IMAGE_MAX];
+static header *info_table_head[INFO_IMAGE_MAX];
+static int info_table_num = 0;
+
+/* Some array was parsed from its template */
+static bool info_image_stale = FALSE;
+
+
+/*
+ * Release the binary image
+ */
+static void info_image_close(void)
+{
+	if (!info_image) return;
+
+#ifdef USE_MMAP
+	if (info_image_mapped)
+	{
+		munmap(info_image, info_image_size);
+		info_image_mapped = FALSE;
+	}
+	else
+#endif
+	FREE(info_image);
+
+	info_image = NULL;
+	info_image_size = 0;
+}
+
+
+/*
+ * Load the binary image, by mapping it if we can
+ */
+static void info_image_open(void)
+{
+	info_image_toc *toc;
+	char buf[1024];
+
+	path_build(buf, sizeof(buf), ANGBAND_DIR_DATA, "info.raw");
+
+#ifdef USE_MMAP
+	{
+		struct stat st;
+		void *map;
+		int fd = open(buf, O_RDONLY);
+
+		if (fd < 0) return;
+
+		/* Private and writable, since some arrays count things at runtime */
+		if (fstat(fd, &st) || st.st_size < (off_t)sizeof(info_image_toc) ||
+			(map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fd, 0)) == MAP_FAILED)
+		{
+			close(fd);
+			return;
+		}
+		close(fd);
+
+		info_image = map;
+		info_image_size = st.st_size;
+		info_image_mapped = TRUE;
+	}
+#else
+	{
+		info_image_toc test;
+		ang_file *fp = file_open(buf, MODE_READ, -1);
+
+		if (!fp) return;
+
+		/* Read the contents to learn the size, then the whole image */
+		if (file_read(fp, (char*)&test, sizeof(test)) == sizeof(test) &&
+			test.magic == INFO_IMAGE_MAGIC && test.size >= sizeof(test) &&
+			file_seek(fp, 0))
+		{
+			C_MAKE(info_image, test.size, char);
+			info_image_size = test.size;
+
+			if (file_read(fp, info_image, test.size) != test.size)
+			{
+				FREE(info_image);
+				info_image_size = 0;
+			}
+		}
+		file_close(fp);
+	}
+#endif
+
+	if (!info_image) return;
+
+	/* Forget images we cannot trust */
+	toc = (info_image_toc*)info_image;
+	if (toc->magic != INFO_IMAGE_MAGIC || toc->size != info_image_size ||
+		toc->num > INFO_IMAGE_MAX)
+	{
+		plog("Ignoring damaged 'info.raw' file.");
+		info_image_close();
+	}
+}
+
+
+/*
+ * Is the given array part of the binary image?
  */
-static errr init_info_raw(ang_file* fd, header *head)
+static bool in_info_image(const void *ptr)
 {
-	header test;
+	return (info_image && (const char*)ptr >= info_image &&
+		(const char*)ptr < info_image + info_image_size);
+}
 
 
-	/* Read and verify the header */
-	if (file_read(fd, (char*)(&test), sizeof(header)) <= 0 ||
-	    (test.v_major != head->v_major) ||
-	    (test.v_minor != head->v_minor) ||
-	    (test.v_patch != head->v_patch) ||
-	    (test.v_extra != head->v_extra) ||
-	    (test.info_num != head->info_num) ||
-	    (test.info_len != head->info_len) ||
-	    (test.head_size != head->head_size) ||
-	    (test.info_size != head->info_size))
+#ifdef ALLOW_TEMPLATES
+
+/*
+ * Hash the contents of a template file (FNV-1a), or return 0
+ */
+static u32b info_txt_hash(cptr filename)
+{
+	char buf[1024], leaf[32];
+	u32b hash = 2166136261UL;
+	ang_file *fp;
+	size_t n, i;
+
+	/* Not format(), this runs on the loader threads */
+	strnfmt(leaf, sizeof(leaf), "%s.txt", filename);
+	path_build(buf, sizeof(buf), ANGBAND_DIR_EDIT, leaf);
+
+	fp = file_open(buf, MODE_READ, -1);
+	if (!fp) return (0);
+
+	while ((n = file_read(fp, buf, sizeof(buf))) > 0 && n <= sizeof(buf))
+	{
+		for (i = 0; i < n; i++)
+		{
+			hash ^= (byte)buf[i];
+			hash *= 16777619UL;
+		}
+	}
+
+	file_close(fp);
+
+	return (hash);
+}
+
+#endif /* ALLOW_TEMPLATES */
+
+
+/*
+ * Initialize a "*_info" array from the binary image
+ */
+static errr init_info_raw(cptr filename, u32b hash, header *head)
+{
+	info_image_toc *toc = (info_image_toc*)info_image;
+	header *test;
+	char *data;
+	u32b i, end;
+
+	if (!info_image) return (-1);
+
+	/* Find the array */
+	for (i = 0; i < toc->num; i++)
+	{
+		if (streq(toc->entry[i].name, filename)) break;
+	}
+	if (i == toc->num) return (-1);
+
+	/* The template changed */
+	if (hash && toc->entry[i].hash != hash) return (-1);
+
+	/* Paranoia -- the header must fit */
+	if (toc->entry[i].offset > info_image_size - sizeof(header)) return (-1);
+
+	/* Verify the header */
+	test = (header*)(info_image + toc->entry[i].offset);
+	if ((test->v_major != head->v_major) ||
+	    (test->v_minor != head->v_minor) ||
+	    (test->v_patch != head->v_patch) ||
+	    (test->v_extra != head->v_extra) ||
+	    (test->info_num != head->info_num) ||
+	    (test->info_len != head->info_len) ||
+	    (test->head_size != head->head_size) ||
+	    (test->info_size != head->info_size))
 	{
 		/* Error */
 		return (-1);
 	}
 
+	/* Paranoia -- the arrays must fit */
+	end = toc->entry[i].offset + test->head_size;
+	if (test->info_size > info_image_size - end) return (-1);
+	end += test->info_size;
+	if (test->name_size > info_image_size - end) return (-1);
+	end += test->name_size;
+	if (test->text_size > info_image_size - end) return (-1);
 
 	/* Accept the header */
-	COPY(head, &test, header);
+	head->name_size = test->name_size;
+	head->text_size = test->text_size;
+
+	/* Point at the arrays */
+	data = info_image + toc->entry[i].offset + test->head_size;
+	head->info_ptr = data;
+	head->name_ptr = (head->name_size ? data + head->info_size : NULL);
+	head->text_ptr = (head->text_size ? data + head->info_size + head->name_size : NULL);
 
+	/* Success */
+	return (0);
+}
 
-	/* Allocate the "*_info" array */
-	C_MAKE(head->info_ptr, head->info_size, char);
 
-	/* Read the "*_info" array */
-	file_read(fd, head->info_ptr, head->info_size);
+/*
+ * Write a fresh binary image holding every array initialized so far
+ */
+static void info_image_dump(void)
+{
+	info_image_toc toc;
+	char pad[INFO_IMAGE_ALIGN];
+	char buf[1024], tmp[1024];
+	ang_file *fp;
+	u32b pos;
+	int i;
 
-	if (head->name_size)
+	/* Lay out the image */
+	WIPE(&toc, info_image_toc);
+	toc.magic = INFO_IMAGE_MAGIC;
+	toc.num = info_table_num;
+	pos = sizeof(toc);
+	for (i = 0; i < info_table_num; i++)
 	{
-		/* Allocate the "*_name" array */
-		C_MAKE(head->name_ptr, head->name_size, char);
+		header *head = info_table_head[i];
 
-		/* Read the "*_name" array */
-		file_read(fd, head->name_ptr, head->name_size);
+		pos = (pos + INFO_IMAGE_ALIGN - 1) & ~(INFO_IMAGE_ALIGN - 1);
+		toc.entry[i] = info_table[i];
+		toc.entry[i].offset = pos;
+		pos += head->head_size + head->info_size + head->name_size + head->text_size;
 	}
+	toc.size = pos;
+
+	/* Never overwrite the image in place, it may be mapped */
+	path_build(buf, sizeof(buf), ANGBAND_DIR_DATA, "info.raw");
+	path_build(tmp, sizeof(tmp), ANGBAND_DIR_DATA, "info.new");
+
+	/* Attempt to create the raw file */
+	fp = file_open(tmp, MODE_WRITE, FTYPE_RAW);
+
+	/* Failure */
+	if (!fp)
+	{
+		/* Complain */
+		plog_fmt("Cannot write the '%s' file!", tmp);
+		return;
+	}
+
+	C_WIPE(pad, INFO_IMAGE_ALIGN, char);
+
+	/* Dump the contents */
+	file_write(fp, (cptr)&toc, sizeof(toc));
+	pos = sizeof(toc);
 
-	if (head->text_size)
+	for (i = 0; i < info_table_num; i++)
 	{
-		/* Allocate the "*_text" array */
-		C_MAKE(head->text_ptr, head->text_size, char);
+		header *head = info_table_head[i];
 
-		/* Read the "*_text" array */
-		file_read(fd, head->text_ptr, head->text_size);
+		/* Pad to the next page */
+		file_write(fp, pad, toc.entry[i].offset - pos);
+
+		/* Dump the header */
+		file_write(fp, (cptr)head, head->head_size);
+
+		/* Dump the "*_info" array */
+		if (head->info_size > 0)
+			file_write(fp, head->info_ptr, head->info_size);
+
+		/* Dump the "*_name" array */
+		if (head->name_size > 0)
+			file_write(fp, head->name_ptr, head->name_size);
+
+		/* Dump the "*_text" array */
+		if (head->text_size > 0)
+			file_write(fp, head->text_ptr, head->text_size);
+
+		pos = toc.entry[i].offset + head->head_size + head->info_size +
+			head->name_size + head->text_size;
 	}
 
-	/* Success */
-	return (0);
+	/* Close */
+	file_close(fp);
+
+	/* Replace the old image */
+	if (!file_move(tmp, buf))
+	{
+		file_delete(buf);
+		if (!file_move(tmp, buf)) plog_fmt("Cannot write the '%s' file!", buf);
+	}
 }
 
 
@@ -515,7 +807,7 @@ static void init_header(header *head, int num, int len)
 /*
  * Display a parser error message.
  */
-static void display_parse_error(cptr filename, errr err, cptr buf)
+static void display_parse_error(cptr filename, errr err, cptr buf, header *head)
 {
 	cptr oops;
 
@@ -523,8 +815,8 @@ static void display_parse_error(cptr filename, errr err, cptr buf)
 	oops = (((err > 0) && (err < PARSE_ERROR_MAX)) ? err_str[err] : "unknown");
 
 	/* Oops */
-	plog(format("Error at line %d of '%s.txt'.", error_line, filename));
-	plog(format("Record %d contains a '%s' error.", error_idx, oops));
+	plog(format("Error at line %d of '%s.txt'.", head->error_line, filename));
+	plog(format("Record %d contains a '%s' error.", head->error_idx, oops));
 	plog(format("Parsing '%s'.", buf));
 /*	message_flush();*/
 
@@ -535,51 +827,104 @@ static void display_parse_error(cptr filename, errr err, cptr buf)
 #endif /* ALLOW_TEMPLATES */
 
 
+/*** Load the data tables ***/
+
+
 /*
- * Initialize a "*_info" array
- *
- * Note that we let each entry have a unique "name" and "text" string,
- * even if the string happens to be empty (everyone has a unique '\0').
+ * Once "z_info" is known the data tables do not depend on each other, so
+ * init_info() only queues a table and init_info_run() loads the queue at
+ * once, parsing stale templates on up to one thread per processor.  Every
+ * job has its own header and line buffer, and parse errors are reported
+ * after all jobs finish (the parsers only log unknown flags, through
+ * "init_info_log()").
  */
-static errr init_info(cptr filename, header *head)
+#define INFO_THREADS	4
+
+typedef struct info_job info_job;
+
+struct info_job
 {
-	errr err = 1;
+	cptr filename;		/* Template name, e.g. "monster" */
+	header *head;		/* Array header */
+	u32b hash;		/* Hash of the template */
+	bool parsed;		/* Parsed from the template */
+	errr err;		/* Error, if any */
+	micro usec;		/* Time spent loading */
+	char buf[1024];		/* Last line parsed */
+};
 
-	ang_file* fp;
+static info_job info_jobs[INFO_IMAGE_MAX];
+static int info_job_num = 0;
+static int info_job_next = 0;
 
-	/* General buffer */
-	char buf[1024];
+#ifdef USE_PTHREADS
+static pthread_mutex_t info_job_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t info_log_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 
-#ifdef ALLOW_TEMPLATES
+/*
+ * Current time in microseconds, for the load timings
+ */
+static micro info_clock(void)
+{
+#if defined(HAVE_SYS_TIME_H) && defined(HAVE_GETTIMEOFDAY)
+	struct timeval tv;
 
-	/*** Load the binary image file ***/
+	gettimeofday(&tv, NULL);
 
-	/* Build the filename */
-	path_build(buf, sizeof(buf), ANGBAND_DIR_DATA, format("%s.raw", filename));
+	return ((micro)tv.tv_sec * 1000000 + tv.tv_usec);
+#else
+	return (0);
+#endif
+}
 
-	/* Attempt to open the "raw" file */
-	fp = file_open(buf, MODE_READ, -1);
 
-	/* Process existing "raw" file */
-	if (fp)
-	{
-#ifdef CHECK_MODIFICATION_TIME
+/*
+ * Log a message from a template parser, which may be running on any of
+ * the loader threads (so the message must not come from "format()")
+ */
+void init_info_log(cptr str)
+{
+#ifdef USE_PTHREADS
+	pthread_mutex_lock(&info_log_lock);
+#endif
+	plog(str);
+#ifdef USE_PTHREADS
+	pthread_mutex_unlock(&info_log_lock);
+#endif
+}
 
-		err = check_modification_date(fd, format("%s.txt", filename));
 
-#endif /* CHECK_MODIFICATION_TIME */
+/*
+ * Load one queued array, from the binary image or from its template.
+ *
+ * Note that we let each entry have a unique "name" and "text" string,
+ * even if the string happens to be empty (everyone has a unique '\0').
+ */
+static void info_job_load(info_job *job)
+{
+	header *head = job->head;
+	micro start = info_clock();
 
-		/* Attempt to parse the "raw" file */
-		if (!err)
-			err = init_info_raw(fp, head);
+#ifdef ALLOW_TEMPLATES
 
-		/* Close it */
-		file_close(fp);
-	}
+	ang_file* fp;
+	char leaf[32];
+
+	/* Hash the template, to notice edits */
+	job->hash = info_txt_hash(job->filename);
+
+#endif /* ALLOW_TEMPLATES */
+
+	/*** Load the binary image ***/
+
+	job->err = init_info_raw(job->filename, job->hash, head);
+
+#ifdef ALLOW_TEMPLATES
 
 	/* Do we have to parse the *.txt file? */
-	if (err)
+	if (job->err)
 	{
 		/*** Make the fake arrays ***/
 
@@ -596,110 +941,154 @@ static errr init_info(cptr filename, header *head)
 
 		/*** Load the ascii template file ***/
 
+		job->parsed = TRUE;
+
 		/* Build the filename */
-		path_build(buf, sizeof(buf), ANGBAND_DIR_EDIT, format("%s.txt", filename));
+		strnfmt(leaf, sizeof(leaf), "%s.txt", job->filename);
+		path_build(job->buf, sizeof(job->buf), ANGBAND_DIR_EDIT, leaf);
 
 		/* Open the file */
-		fp = file_open(buf, MODE_READ, -1);
-
-		/* Parse it */
-		if (!fp) quit(format("Cannot open '%s' file.", buf));
+		fp = file_open(job->buf, MODE_READ, -1);
 
 		/* Parse the file */
-		err = init_info_txt(fp, buf, head, head->parse_info_txt);
+		if (fp)
+		{
+			job->err = init_info_txt(fp, job->buf, head, head->parse_info_txt);
 
-		/* Close it */
-		file_close(fp);
+			/* Close it */
+			file_close(fp);
+		}
+	}
 
-		/* Errors */
-		if (err) display_parse_error(filename, err, buf);
+#endif /* ALLOW_TEMPLATES */
 
+	job->usec = info_clock() - start;
+}
 
-		/*** Dump the binary image file ***/
 
-		/* Build the filename */
-		path_build(buf, sizeof(buf), ANGBAND_DIR_DATA, format("%s.raw", filename));
+#ifdef USE_PTHREADS
 
-		/* Grab permissions */
-		/*safe_setuid_grab();*/
+/*
+ * Load queued arrays until none are left
+ */
+static void *info_worker(void *unused)
+{
+	int n;
 
-		/* Attempt to create the raw file */
-		fp = file_open(buf, MODE_WRITE, FTYPE_RAW);
+	while (TRUE)
+	{
+		/* Take the next job */
+		pthread_mutex_lock(&info_job_lock);
+		n = info_job_next++;
+		pthread_mutex_unlock(&info_job_lock);
 
-		/* Drop permissions */
-		/*safe_setuid_drop();*/
+		if (n >= info_job_num) break;
 
-		/* Failure */
-		if (!fp)
-		{
-			/* Complain */
-			plog_fmt("Cannot write the '%s' file!", buf);
+		info_job_load(&info_jobs[n]);
+	}
 
-			/* Continue */
-			return (0);
-		}
+	return (NULL);
+}
+
+#endif /* USE_PTHREADS */
 
-		/* Dump to the file */
-		if (fp)
-		{
-			/* Dump it */
-			file_write(fp, (cptr)head, head->head_size);
 
-			/* Dump the "*_info" array */
-			if (head->info_size > 0)
-				file_write(fp, head->info_ptr, head->info_size);
+/*
+ * Queue a "*_info" array for init_info_run()
+ */
+static errr init_info(cptr filename, header *head)
+{
+	info_job *job;
 
-			/* Dump the "*_name" array */
-			if (head->name_size > 0)
-				file_write(fp, head->name_ptr, head->name_size);
+	if (info_job_num >= INFO_IMAGE_MAX) return (-1);
 
-			/* Dump the "*_text" array */
-			if (head->text_size > 0)
-				file_write(fp, head->text_ptr, head->text_size);
+	job = &info_jobs[info_job_num++];
+	WIPE(job, info_job);
+	job->filename = filename;
+	job->head = head;
 
-			/* Close */
-			file_close(fp);
-		}
+	/* Success */
+	return (0);
+}
 
 
-		/*** Kill the fake arrays ***/
+/*
+ * Load every queued array, then report how it went
+ */
+static errr init_info_run(void)
+{
+	int i;
 
-		/* Free the "*_info" array */
-		KILL(head->info_ptr);
+#ifdef USE_PTHREADS
 
-		/* MegaHack -- Free the "fake" arrays */
-		if (z_info)
-		{
-			KILL(head->name_ptr);
-			KILL(head->text_ptr);
-		}
+	pthread_t thread[INFO_THREADS];
+	int num = 0, max = INFO_THREADS;
 
-#endif /* ALLOW_TEMPLATES */
+#ifdef _SC_NPROCESSORS_ONLN
+	/* Extra threads only slow a single processor down */
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpus > 0 && cpus < max) max = cpus;
+#endif
+
+	info_job_next = 0;
 
+	/* Start the helpers, the main thread works too */
+	for (i = 1; i < max && i < info_job_num; i++)
+	{
+		if (!pthread_create(&thread[num], NULL, info_worker, NULL)) num++;
+	}
+	info_worker(NULL);
 
-		/*** Load the binary image file ***/
+	/* Wait for them */
+	for (i = 0; i < num; i++)
+	{
+		pthread_join(thread[i], NULL);
+	}
 
-		/* Build the filename */
-		path_build(buf, sizeof(buf), ANGBAND_DIR_DATA, format("%s.raw", filename));
+#else /* USE_PTHREADS */
 
-		/* Attempt to open the "raw" file */
-		fp = file_open(buf, MODE_READ, -1);
+	for (i = 0; i < info_job_num; i++)
+	{
+		info_job_load(&info_jobs[i]);
+	}
 
-		/* Process existing "raw" file */
-		if (!fp) quit(format("Cannot load '%s.raw' file.", filename));
+#endif /* USE_PTHREADS */
 
-		/* Attempt to parse the "raw" file */
-		err = init_info_raw(fp, head);
+	/* Report in queue order */
+	for (i = 0; i < info_job_num; i++)
+	{
+		info_job *job = &info_jobs[i];
 
-		/* Close it */
-		file_close(fp);
+#ifdef ALLOW_TEMPLATES
+
+		if (job->parsed)
+		{
+			/* Errors */
+			if (job->err < 0) quit(format("Cannot open '%s' file.", job->buf));
+			if (job->err) display_parse_error(job->filename, job->err, job->buf, job->head);
+
+			plog(format("[Parsed '%s.txt' in %ld usec]", job->filename, (long)job->usec));
+
+			/* Dump a fresh binary image once everything is loaded */
+			info_image_stale = TRUE;
+		}
+
+#endif /* ALLOW_TEMPLATES */
 
 		/* Error */
-		if (err) quit(format("Cannot parse '%s.raw' file.", filename));
+		if (job->err) quit(format("Cannot load '%s' from the 'info.raw' file.", job->filename));
 
-#ifdef ALLOW_TEMPLATES
+		/* Remember the array for the next image */
+		if (info_table_num < INFO_IMAGE_MAX)
+		{
+			my_strcpy(info_table[info_table_num].name, job->filename, sizeof(info_table[0].name));
+			info_table[info_table_num].hash = job->hash;
+			info_table_head[info_table_num++] = job->head;
+		}
 	}
-#endif /* ALLOW_TEMPLATES */
+
+	/* Empty the queue */
+	info_job_num = 0;
 
 	/* Success */
 	return (0);
@@ -710,13 +1099,14 @@ static errr init_info(cptr filename, header *head)
  */
 static errr free_info(header *head)
 {
-	if (head->info_size)
+	/* Arrays loaded from the binary image go with it */
+	if (head->info_size && !in_info_image(head->info_ptr))
 		FREE(head->info_ptr);
 
-	if (head->name_size)
+	if (head->name_size && !in_info_image(head->name_ptr))
 		FREE(head->name_ptr);
 
-	if (head->text_size)
+	if (head->text_size && !in_info_image(head->text_ptr))
 		FREE(head->text_ptr);
 
 	/* Success */
@@ -742,6 +1132,9 @@ static errr init_z_info(void)
 
 	err = init_info("limits", &z_head);
 
+	/* Everything else depends on it, so load it right away */
+	if (!err) err = init_info_run();
+
 	/* Set the global variables */
 	z_info = z_head.info_ptr;
 
@@ -754,8 +1147,6 @@ static errr init_z_info(void)
  */
 static errr init_f_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&f_head, z_info->f_max, sizeof(feature_type));
 
@@ -766,14 +1157,8 @@ static errr init_f_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("terrain", &f_head);
-
-	/* Set the global variables */
-	f_info = f_head.info_ptr;
-	f_name = f_head.name_ptr;
-	f_text = f_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("terrain", &f_head));
 }
 
 
@@ -782,8 +1167,6 @@ static errr init_f_info(void)
  */
 static errr init_k_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&k_head, z_info->k_max, sizeof(object_kind));
 
@@ -794,14 +1177,8 @@ static errr init_k_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("object", &k_head);
-
-	/* Set the global variables */
-	k_info = k_head.info_ptr;
-	k_name = k_head.name_ptr;
-	k_text = k_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("object", &k_head));
 }
 
 
@@ -810,8 +1187,6 @@ static errr init_k_info(void)
  */
 static errr init_a_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&a_head, z_info->a_max, sizeof(artifact_type));
 
@@ -822,14 +1197,8 @@ static errr init_a_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("artifact", &a_head);
-
-	/* Set the global variables */
-	a_info = a_head.info_ptr;
-	a_name = a_head.name_ptr;
-	a_text = a_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("artifact", &a_head));
 }
 
 
@@ -838,8 +1207,6 @@ static errr init_a_info(void)
  */
 static errr init_c_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&c_head, z_info->c_max, sizeof(player_class));
 
@@ -850,14 +1217,8 @@ static errr init_c_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("p_class", &c_head);
-
-	/* Set the global variables */
-	c_info = c_head.info_ptr;
-	c_name = c_head.name_ptr;
-	c_text = c_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("p_class", &c_head));
 }
 
 
@@ -866,8 +1227,6 @@ static errr init_c_info(void)
  */
 static errr init_h_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&h_head, z_info->h_max, sizeof(hist_type));
 
@@ -878,13 +1237,8 @@ static errr init_h_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("p_hist", &h_head);
-
-	/* Set the global variables */
-	h_info = h_head.info_ptr;
-	h_text = h_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("p_hist", &h_head));
 }
 
 
@@ -893,8 +1247,6 @@ static errr init_h_info(void)
  */
 static errr init_b_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&b_head, (u16b)(MAX_STORES * z_info->b_max), sizeof(owner_type));
 
@@ -905,14 +1257,8 @@ static errr init_b_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("shop_own", &b_head);
-
-	/* Set the global variables */
-	b_info = b_head.info_ptr;
-	b_name = b_head.name_ptr;
-	b_text = b_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("shop_own", &b_head));
 }
 
 
@@ -921,8 +1267,6 @@ static errr init_b_info(void)
  */
 static errr init_g_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&g_head, (u16b)(z_info->p_max * z_info->p_max), sizeof(byte));
 
@@ -933,14 +1277,8 @@ static errr init_g_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("cost_adj", &g_head);
-
-	/* Set the global variables */
-	g_info = g_head.info_ptr;
-	g_name = g_head.name_ptr;
-	g_text = g_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("cost_adj", &g_head));
 }
 
 
@@ -949,8 +1287,6 @@ static errr init_g_info(void)
  */
 static errr init_e_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&e_head, z_info->e_max, sizeof(ego_item_type));
 
@@ -961,14 +1297,8 @@ static errr init_e_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("ego_item", &e_head);
-
-	/* Set the global variables */
-	e_info = e_head.info_ptr;
-	e_name = e_head.name_ptr;
-	e_text = e_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("ego_item", &e_head));
 }
 
 
@@ -977,8 +1307,6 @@ static errr init_e_info(void)
  */
 static errr init_r_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&r_head, z_info->r_max, sizeof(monster_race));
 
@@ -989,14 +1317,8 @@ static errr init_r_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("monster", &r_head);
-
-	/* Set the global variables */
-	r_info = r_head.info_ptr;
-	r_name = r_head.name_ptr;
-	r_text = r_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("monster", &r_head));
 }
 
 
@@ -1005,8 +1327,6 @@ static errr init_r_info(void)
  */
 static errr init_v_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&v_head, z_info->v_max, sizeof(vault_type));
 
@@ -1017,14 +1337,8 @@ static errr init_v_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("vault", &v_head);
-
-	/* Set the global variables */
-	v_info = v_head.info_ptr;
-	v_name = v_head.name_ptr;
-	v_text = v_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("vault", &v_head));
 }
 
 
@@ -1033,8 +1347,6 @@ static errr init_v_info(void)
  */
 static errr init_flavor_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&flavor_head, z_info->flavor_max, sizeof(flavor_type));
 
@@ -1045,14 +1357,8 @@ static errr init_flavor_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("flavor", &flavor_head);
-
-	/* Set the global variables */
-	flavor_info = flavor_head.info_ptr;
-	flavor_name = flavor_head.name_ptr;
-	flavor_text = flavor_head.text_ptr;
-
-	return (err);
+	/* Queue it */
+	return (init_info("flavor", &flavor_head));
 }
 
 
@@ -1603,6 +1909,9 @@ static errr init_other(void)
 
 	/*** Init the wild_info array... for more information see wilderness.c ***/
 	init_wild_info();
+
+	/*** Precompute the line of sight paths ***/
+	init_los_table();
 	
 	/*** Socials ***/
 	boot_socials();
@@ -1619,6 +1928,8 @@ static errr init_other(void)
 
 	/* Quark variables */
 	C_MAKE(quark__str, QUARK_MAX, cptr);
+	C_MAKE(quark__hash, QUARK_HASH, s16b);
+	C_MAKE(quark__free, QUARK_MAX, s16b);
 
 	/* Message variables */
 	C_MAKE(message__ptr, MESSAGE_MAX, u16b);
@@ -2005,8 +2316,6 @@ bool str_to_boolean(char * str)
  */
 static errr init_p_info(void)
 {
-	errr err;
-
 	/* Init the header */
 	init_header(&p_head, z_info->p_max, sizeof(player_race));
 
@@ -2017,14 +2326,62 @@ static errr init_p_info(void)
 
 #endif /* ALLOW_TEMPLATES */
 
-	err = init_info("p_race", &p_head);
+	/* Queue it */
+	return (init_info("p_race", &p_head));
+}
+
+
+/*
+ * Set the global variables once the queued arrays are loaded
+ */
+static void init_info_globals(void)
+{
+	f_info = f_head.info_ptr;
+	f_name = f_head.name_ptr;
+	f_text = f_head.text_ptr;
+
+	k_info = k_head.info_ptr;
+	k_name = k_head.name_ptr;
+	k_text = k_head.text_ptr;
+
+	a_info = a_head.info_ptr;
+	a_name = a_head.name_ptr;
+	a_text = a_head.text_ptr;
+
+	e_info = e_head.info_ptr;
+	e_name = e_head.name_ptr;
+	e_text = e_head.text_ptr;
+
+	r_info = r_head.info_ptr;
+	r_name = r_head.name_ptr;
+	r_text = r_head.text_ptr;
+
+	v_info = v_head.info_ptr;
+	v_name = v_head.name_ptr;
+	v_text = v_head.text_ptr;
+
+	h_info = h_head.info_ptr;
+	h_text = h_head.text_ptr;
 
-	/* Set the global variables */
 	p_info = p_head.info_ptr;
 	p_name = p_head.name_ptr;
 	p_text = p_head.text_ptr;
 
-	return (err);
+	c_info = c_head.info_ptr;
+	c_name = c_head.name_ptr;
+	c_text = c_head.text_ptr;
+
+	b_info = b_head.info_ptr;
+	b_name = b_head.name_ptr;
+	b_text = b_head.text_ptr;
+
+	g_info = g_head.info_ptr;
+	g_name = g_head.name_ptr;
+	g_text = g_head.text_ptr;
+
+	flavor_info = flavor_head.info_ptr;
+	flavor_name = flavor_head.name_ptr;
+	flavor_text = flavor_head.text_ptr;
 }
 
 /* Attempt to bind cfg_ server option to .prf Y: X: option */
@@ -2213,6 +2570,20 @@ void set_server_option(const char * option, char * value)
     else if (!strcmp(option,"CHARACTER_DUMP_COLOR"))
     {
         cfg_chardump_color = str_to_boolean(value);
+    }
+    else if (!strcmp(option,"BINARY_SAVEFILES"))
+    {
+        cfg_binary_saves = str_to_boolean(value);
+    }
+    else if (!strcmp(option,"SNAPSHOT_SAVES"))
+    {
+        cfg_snapshot_saves = str_to_boolean(value);
+    }
+    else if (!strcmp(option,"COMPRESS_LEVEL"))
+    {
+        cfg_compress_level = atoi(value);
+        if (cfg_compress_level < 0) cfg_compress_level = 0;
+        if (cfg_compress_level > 9) cfg_compress_level = 9;
     }
 	else if (!strcmp(option,"INSTANCE_CLOSED"))
 	{
@@ -2427,58 +2798,72 @@ errr parse_file(struct parser *p, const char *filename) {
  */
 void init_some_arrays(void)
 {
+#ifdef DEBUG
+	/* Time the data tables */
+	static_timer(3);
+#endif
+
+	/* Load the binary image */
+	info_image_open();
+
 	/* Initialize size info */
 	plog("[Initializing array sizes...]");
 	if (init_z_info()) quit("Cannot initialize sizes");
 
+	/* Queue the data tables */
+	plog("[Initializing arrays... (data tables)]");
+
 	/* Initialize feature info */
-	plog("[Initializing arrays... (features)]");
 	if (init_f_info()) quit("Cannot initialize features");
 
 	/* Initialize object info */
-	plog("[Initializing arrays... (objects)]");
 	if (init_k_info()) quit("Cannot initialize objects");
 
 	/* Initialize artifact info */
-	plog("[Initializing arrays... (artifacts)]");
 	if (init_a_info()) quit("Cannot initialize artifacts");
 
 	/* Initialize ego-item info */
-	plog("[Initializing arrays... (ego-items)]");
 	if (init_e_info()) quit("Cannot initialize ego-items");
 
 	/* Initialize monster info */
-	plog("[Initializing arrays... (monsters)]");
 	if (init_r_info()) quit("Cannot initialize monsters");
 
 	/* Initialize vault info */
-	plog("[Initializing arrays... (vaults)]");
 	if (init_v_info()) quit("Cannot initialize vaults");
 
 	/* Initialize history info */
-	plog("[Initializing arrays... (histories)]");
 	if (init_h_info()) quit("Cannot initialize histories");
 
 	/* Initialize race info */
-	plog("[Initializing arrays... (races)]");
 	if (init_p_info()) quit("Cannot initialize races");
 
 	/* Initialize class info */
-	plog("[Initializing arrays... (classes)]");
 	if (init_c_info()) quit("Cannot initialize classes");
 
 	/* Initialize owners info */
-	plog("[Initializing arrays... (owners)]");
 	if (init_b_info()) quit("Cannot initialize owners");
 
 	/* Initialize price info */
-	plog("[Initializing arrays... (prices)]");
 	if (init_g_info()) quit("Cannot initialize prices");
 
 	/* Initialize flavor info */
-	plog("[Initializing arrays... (flavors)]");
 	if (init_flavor_info()) quit("Cannot initialize flavors");
 
+	/* Load them all at once */
+	if (init_info_run()) quit("Cannot initialize data tables");
+	init_info_globals();
+
+	/* Some templates changed, save a fresh binary image */
+	if (info_image_stale)
+	{
+		plog("[Writing the binary image...]");
+		info_image_dump();
+	}
+
+#ifdef DEBUG
+	plog(format("[Loaded data tables in %ld usec]", (long)static_timer(3)));
+#endif
+
 	/* Initialize some other arrays */
 	plog("[Initializing arrays... (other)]");
 	if (init_other()) quit("Cannot initialize other stuff");
@@ -2570,6 +2955,8 @@ void cleanup_angband(void)
 	}
 	/* Free the list of "quarks" */
 	FREE((void*)quark__str);
+	FREE(quark__hash);
+	FREE(quark__free);
 
 	/* Free the info, name, and text arrays */
 	free_info(&flavor_head);
@@ -2585,6 +2972,7 @@ void cleanup_angband(void)
 	free_info(&k_head);	
 	free_info(&f_head);
 	free_info(&z_head);
+	info_image_close();
 
 	/* Free the format() buffer */
 	vformat_kill();
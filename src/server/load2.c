@@ -72,6 +72,280 @@ static u32b	x_check = 0L;
  */
 static char file_buf[1024];
 
+/*
+ * Binary savefile reader, see "SAVEFILE_MAGIC" in "mdefines.h".
+ *
+ * Binary savefiles are read into memory whole, and the primitives
+ * below decode them one record at a time.  Peeking at a record (see
+ * "value_exists") never registers its name, so the dictionary only
+ * grows with the records actually consumed, in the order they were
+ * written.
+ */
+typedef struct bin_reader bin_reader;
+struct bin_reader
+{
+	byte *data;	/* The whole file, or NULL for text savefiles */
+	u32b len;
+	u32b pos;
+
+	u32b name_off[SAVEFILE_NAMES];	/* Name dictionary */
+	u16b name_len[SAVEFILE_NAMES];
+	int num_names;
+
+	u32b section_end[16];	/* Open sections */
+	int depth;
+};
+static bin_reader bin_in;
+
+/* A decoded record header */
+typedef struct bin_record bin_record;
+struct bin_record
+{
+	byte type;
+	u32b name;	/* Offset of the name */
+	u32b name_len;
+	bool define;	/* Name is defined here */
+	u32b body;	/* Offset of the payload */
+};
+
+/* Decode a varint at "*pos" */
+static bool bin_varint(u32b *pos, huge *value)
+{
+	int shift = 0;
+	*value = 0;
+	while (*pos < bin_in.len && shift < 64)
+	{
+		byte b = bin_in.data[(*pos)++];
+		*value |= (huge)(b & 0x7F) << shift;
+		if (!(b & 0x80)) return (TRUE);
+		shift += 7;
+	}
+	return (FALSE);
+}
+
+/* Decode the header of the next record */
+static bool bin_peek(bin_record *rec)
+{
+	u32b pos = bin_in.pos;
+	huge id, len;
+
+	if (pos >= bin_in.len) return (FALSE);
+	rec->type = bin_in.data[pos++];
+
+	if (!bin_varint(&pos, &id)) return (FALSE);
+	if (id)
+	{
+		/* Known name */
+		if (id > bin_in.num_names) return (FALSE);
+		rec->name = bin_in.name_off[id - 1];
+		rec->name_len = bin_in.name_len[id - 1];
+		rec->define = FALSE;
+	}
+	else
+	{
+		/* New name */
+		if (!bin_varint(&pos, &len) || len > bin_in.len - pos) return (FALSE);
+		rec->name = pos;
+		rec->name_len = len;
+		rec->define = TRUE;
+		pos += len;
+	}
+	rec->body = pos;
+	return (TRUE);
+}
+
+/* Offset just past the record (sections are entered, not skipped) */
+static u32b bin_end(bin_record *rec)
+{
+	u32b pos = rec->body;
+	huge len, tmp;
+
+	switch (rec->type)
+	{
+		case SREC_SECTION: pos += 4; break;
+		case SREC_END: break;
+		case SREC_INT:
+		case SREC_UINT:
+		case SREC_HUGE: bin_varint(&pos, &tmp); break;
+		case SREC_HTURN: bin_varint(&pos, &tmp); bin_varint(&pos, &tmp); break;
+		case SREC_STR:
+		case SREC_RAW: if (bin_varint(&pos, &len)) pos += len; break;
+		case SREC_RLE: bin_varint(&pos, &tmp); if (bin_varint(&pos, &len)) pos += len; break;
+		case SREC_FLOAT: pos += 4; break;
+		default: pos = bin_in.len + 1; break;
+	}
+	return (pos);
+}
+
+/* Move past the record */
+static bool bin_consume(bin_record *rec)
+{
+	u32b end = bin_end(rec);
+	if (end > bin_in.len) return (FALSE);
+	if (rec->define && bin_in.num_names < SAVEFILE_NAMES)
+	{
+		bin_in.name_off[bin_in.num_names] = rec->name;
+		bin_in.name_len[bin_in.num_names] = rec->name_len;
+		bin_in.num_names++;
+	}
+	bin_in.pos = end;
+	return (TRUE);
+}
+
+/* Check the record name */
+static bool bin_named(bin_record *rec, cptr name)
+{
+	return (rec->name_len == strlen(name) &&
+		!memcmp(bin_in.data + rec->name, name, rec->name_len));
+}
+
+/* Describe the next record, for error messages */
+static cptr bin_found(void)
+{
+	bin_record rec;
+	int len;
+
+	if (!bin_peek(&rec)) return (format("end of file at offset %lu", (unsigned long)bin_in.pos));
+	len = MIN(rec.name_len, 79);
+	return (format("'%.*s' (type %d) at offset %lu", len, bin_in.data + rec.name, rec.type, (unsigned long)bin_in.pos));
+}
+
+/* Read the next record as a number */
+static bool bin_number(cptr name, huge *value)
+{
+	bin_record rec;
+	u32b pos;
+
+	if (!bin_peek(&rec) || !bin_named(&rec, name)) return (FALSE);
+	pos = rec.body;
+	switch (rec.type)
+	{
+		case SREC_INT:
+			if (!bin_varint(&pos, value)) return (FALSE);
+			/* Undo the zigzag */
+			*value = (huge)(s64b)(s32b)((u32b)(*value >> 1) ^ (0 - (u32b)(*value & 1)));
+			break;
+		case SREC_UINT:
+		case SREC_HUGE:
+			if (!bin_varint(&pos, value)) return (FALSE);
+			break;
+		default: return (FALSE);
+	}
+	return (bin_consume(&rec));
+}
+
+/* Read the next record as a string or a blob */
+static bool bin_bytes(cptr name, bool string, char *dst, u32b max)
+{
+	bin_record rec;
+	u32b pos, i, n;
+	huge len, size;
+
+	if (!bin_peek(&rec) || !bin_named(&rec, name)) return (FALSE);
+	if (string ? (rec.type != SREC_STR) : (rec.type != SREC_RAW && rec.type != SREC_RLE)) return (FALSE);
+	if (bin_end(&rec) > bin_in.len) return (FALSE);
+
+	pos = rec.body;
+	bin_varint(&pos, &len);
+	if (rec.type == SREC_RLE)
+	{
+		/* Expand (count, byte) pairs */
+		bin_varint(&pos, &size);
+		for (i = n = 0; i + 1 < size; i += 2)
+		{
+			byte count = bin_in.data[pos + i];
+			while (count-- && n < max) dst[n++] = bin_in.data[pos + i + 1];
+		}
+	}
+	else
+	{
+		n = MIN(len, max);
+		memcpy(dst, bin_in.data + pos, n);
+	}
+	if (string) dst[n] = '\0';
+
+	return (bin_consume(&rec));
+}
+
+/* Read the next record as a section marker */
+static bool bin_section(cptr name, byte type)
+{
+	bin_record rec;
+	u32b pos;
+
+	if (!bin_peek(&rec) || rec.type != type || !bin_named(&rec, name)) return (FALSE);
+	if (!bin_consume(&rec)) return (FALSE);
+
+	pos = rec.body;
+	if (type == SREC_SECTION)
+	{
+		/* Remember where it should end */
+		u32b len = bin_in.data[pos] | (bin_in.data[pos + 1] << 8) | (bin_in.data[pos + 2] << 16) | ((u32b)bin_in.data[pos + 3] << 24);
+		if (bin_in.depth < 16) bin_in.section_end[bin_in.depth] = pos + 4 + len;
+		bin_in.depth++;
+	}
+	else
+	{
+		if (--bin_in.depth < 0) return (FALSE);
+		if (bin_in.depth < 16 && bin_in.pos != bin_in.section_end[bin_in.depth]) return (FALSE);
+	}
+	return (TRUE);
+}
+
+/*
+ * Prepare to read the savefile open in "file_handle", recognizing
+ * the binary format by its magic.
+ */
+static bool rd_begin(void)
+{
+	char magic[SAVEFILE_MAGIC_LEN + 1];
+	size_t n;
+
+	WIPE(&bin_in, bin_reader);
+	line_counter = 0;
+
+	/* Text savefile */
+	if (file_read(file_handle, magic, sizeof(magic)) != sizeof(magic) ||
+		memcmp(magic, SAVEFILE_MAGIC, SAVEFILE_MAGIC_LEN))
+	{
+		file_seek(file_handle, 0);
+		return (TRUE);
+	}
+
+	if (magic[SAVEFILE_MAGIC_LEN] != SAVEFILE_BINARY_VERSION)
+	{
+		plog(format("Unknown binary savefile version %d", magic[SAVEFILE_MAGIC_LEN]));
+		return (FALSE);
+	}
+
+	/* Slurp the rest */
+	bin_in.len = 64 * 1024;
+	bin_in.data = C_RNEW(bin_in.len, byte);
+	while ((n = file_read(file_handle, (char *)bin_in.data + bin_in.pos, bin_in.len - bin_in.pos)) > 0)
+	{
+		bin_in.pos += n;
+		if (bin_in.pos == bin_in.len)
+		{
+			byte *old_data = bin_in.data;
+			bin_in.data = C_RNEW(bin_in.len * 2, byte);
+			memcpy(bin_in.data, old_data, bin_in.len);
+			FREE(old_data);
+			bin_in.len *= 2;
+		}
+	}
+	bin_in.len = bin_in.pos;
+	bin_in.pos = 0;
+
+	return (TRUE);
+}
+
+/* Done reading the savefile */
+static void rd_end(void)
+{
+	if (bin_in.data) FREE(bin_in.data);
+	bin_in.data = NULL;
+}
+
 /*
  * Functions to read data from the textual format save file
  */
@@ -83,6 +357,13 @@ bool start_section_read(char* name)
 	char got_section[80];
 	bool matched = FALSE;
 	
+	if (bin_in.data)
+	{
+		if (bin_section(name, SREC_SECTION)) return (TRUE);
+		plog(format("Missing section.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -107,6 +388,13 @@ bool end_section_read(char* name)
 	char got_section[80];
 	bool matched = FALSE;
 		
+	if (bin_in.data)
+	{
+		if (bin_section(name, SREC_END)) return (TRUE);
+		plog(format("Missing end section.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -134,6 +422,18 @@ bool read_byte(char* name, byte *dst)
 	u16b larger_value;
 #endif
 		
+	if (bin_in.data)
+	{
+		huge tmp;
+		if (bin_number(name, &tmp))
+		{
+			*dst = (byte)tmp;
+			return (TRUE);
+		}
+		plog(format("Missing integer.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -172,6 +472,18 @@ bool read_short(char* name, s16b *dst)
 	bool matched = FALSE;
 	s16b value;
 		
+	if (bin_in.data)
+	{
+		huge tmp;
+		if (bin_number(name, &tmp))
+		{
+			*dst = (s16b)tmp;
+			return (TRUE);
+		}
+		plog(format("Missing integer.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -196,6 +508,18 @@ bool read_int(char* name, int *dst)
 	bool matched = FALSE;
 	int value;
 		
+	if (bin_in.data)
+	{
+		huge tmp;
+		if (bin_number(name, &tmp))
+		{
+			*dst = (int)tmp;
+			return (TRUE);
+		}
+		plog(format("Missing integer.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -220,6 +544,18 @@ bool read_uint(const char* name, uint *dst)
 	bool matched = FALSE;
 	uint value;
 		
+	if (bin_in.data)
+	{
+		huge tmp;
+		if (bin_number(name, &tmp))
+		{
+			*dst = (uint)tmp;
+			return (TRUE);
+		}
+		plog(format("Missing unsigned integer.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -244,6 +580,18 @@ bool read_huge(char* name, huge *dst)
 	bool matched = FALSE;
 	huge value;
 		
+	if (bin_in.data)
+	{
+		huge tmp;
+		if (bin_number(name, &tmp))
+		{
+			*dst = (huge)tmp;
+			return (TRUE);
+		}
+		plog(format("Missing signed long.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -268,6 +616,25 @@ bool read_hturn(char* name, hturn *value)
 	bool matched = FALSE;
 	s64b era, turn;
 
+	if (bin_in.data)
+	{
+		bin_record rec;
+		u32b pos;
+		huge h_era, h_turn;
+		if (bin_peek(&rec) && rec.type == SREC_HTURN && bin_named(&rec, name))
+		{
+			pos = rec.body;
+			if (bin_varint(&pos, &h_era) && bin_varint(&pos, &h_turn) && bin_consume(&rec))
+			{
+				value->era = h_era;
+				value->turn = h_turn;
+				return (TRUE);
+			}
+		}
+		plog(format("Missing hturn.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -295,6 +662,13 @@ bool read_str(char* name, char* value)
 	bool matched = FALSE;
 	char *c;
 	
+	if (bin_in.data)
+	{
+		if (bin_bytes(name, TRUE, value, sizeof(file_buf) - 1)) return (TRUE);
+		plog(format("Missing string data.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -350,6 +724,18 @@ bool read_float(char* name, float *dst)
 	bool matched = FALSE;
 	float value;
 	
+	if (bin_in.data)
+	{
+		bin_record rec;
+		if (bin_peek(&rec) && rec.type == SREC_FLOAT && bin_named(&rec, name) && bin_consume(&rec))
+		{
+			memcpy(dst, bin_in.data + rec.body, 4);
+			return (TRUE);
+		}
+		plog(format("Missing float.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -378,6 +764,13 @@ bool read_binary(char* name, char* value, int max_len)
 	unsigned int abyte;
 	hex[2] = '\0';
 
+	if (bin_in.data)
+	{
+		if (bin_bytes(name, FALSE, value, max_len)) return (TRUE);
+		plog(format("Missing binary data.  Expected '%s', found %s", name, bin_found()));
+		return (FALSE);
+	}
+
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
 	{
 		line_counter++;
@@ -415,6 +808,13 @@ void skip_value(char* name)
 	char seek_name[80];
 	long fpos;
 	
+	if (bin_in.data)
+	{
+		bin_record rec;
+		if (bin_peek(&rec) && rec.type > SREC_END && bin_named(&rec, name)) bin_consume(&rec);
+		return;
+	}
+
 	/* Remember where we are incase there is nothing to skip */
 	fpos = file_tell(file_handle);
 	sprintf(seek_name,"%s = ",name);
@@ -439,6 +839,12 @@ bool value_exists(const char* name)
 	bool matched = FALSE;
 	long fpos;
 	
+	if (bin_in.data)
+	{
+		bin_record rec;
+		return (bin_peek(&rec) && rec.type > SREC_END && bin_named(&rec, name));
+	}
+
 	/* Remember where we are */
 	fpos = file_tell(file_handle);
 	sprintf(seek_name,"%s = ",name);
@@ -463,6 +869,12 @@ bool section_exists(char* name)
 	bool matched = FALSE;
 	long fpos;
 	
+	if (bin_in.data)
+	{
+		bin_record rec;
+		return (bin_peek(&rec) && rec.type == SREC_SECTION && bin_named(&rec, name));
+	}
+
 	/* Remember where we are */
 	fpos = file_tell(file_handle);
 	if (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
@@ -1516,6 +1928,7 @@ static bool rd_dungeon(bool ext, int Depth)
 	int y, x;
 	cave_type *c_ptr;
 	char cave_row[MAX_WID+1];
+	static char cave_plane[MAX_HGT * MAX_WID];
 
 	__try( start_section_read("dungeon_level") );
 
@@ -1569,6 +1982,17 @@ static bool rd_dungeon(bool ext, int Depth)
 	/* Load features */
 	__try( start_section_read("features") );
 
+	/* Binary savefiles store the whole plane */
+	if (value_exists("plane"))
+	{
+		__try( read_binary("plane", cave_plane, MAX_HGT * MAX_WID) );
+		for (y = 0; y < max_y; y++)
+		{
+			for (x = 0; x < max_x; x++)
+				cave[depth][y][x].feat = cave_plane[y * MAX_WID + x];
+		}
+	}
+	else
 		for (y = 0; y < max_y; y++)
 		{
 			__try( read_binary("row",cave_row,MAX_WID) );
@@ -1587,6 +2011,16 @@ static bool rd_dungeon(bool ext, int Depth)
 	/* Load info */
 	start_section_read("info");
 
+	if (value_exists("plane"))
+	{
+		__try( read_binary("plane", cave_plane, MAX_HGT * MAX_WID) );
+		for (y = 0; y < max_y; y++)
+		{
+			for (x = 0; x < max_x; x++)
+				cave[depth][y][x].info = cave_plane[y * MAX_WID + x];
+		}
+	}
+	else
 		for (y = 0; y < max_y; y++)
 		{
 			__try( read_binary("row",cave_row,MAX_WID) );
@@ -1627,6 +2061,7 @@ static errr rd_dungeon_special()
 	char levelname[32];
 	ang_file* fhandle;
 	ang_file* server_handle;
+	static bin_reader server_bin;
 	int i,num_levels,j=0,k=0;
 	
 	/* Clear all the special levels */
@@ -1655,11 +2090,14 @@ static errr rd_dungeon_special()
 		{
 			/* swap out the main file pointer for our level file */
 			server_handle = file_handle;
+			server_bin = bin_in;
 			file_handle = fhandle;
 			/* load the level */
-			ok = rd_dungeon(FALSE, 0);
+			ok = rd_begin() && rd_dungeon(FALSE, 0);
+			rd_end();
 			/* swap the file pointers back */
 			file_handle = server_handle;
+			bin_in = server_bin;
 			/* close the level file */
 			file_close(fhandle);
 			/* we have an arbitrary max number of levels */
@@ -1684,6 +2122,7 @@ bool rd_dungeon_special_ext(int Depth, cptr levelname)
 	char filename[1024];
 	ang_file* fhandle;
 	ang_file* server_handle;
+	static bin_reader server_bin;
 	
 	path_build(filename, 1024, ANGBAND_DIR_SAVE, levelname);
 
@@ -1693,13 +2132,16 @@ bool rd_dungeon_special_ext(int Depth, cptr levelname)
 	{
 			/* swap out the main file pointer for our level file */
 			server_handle = file_handle;
+			server_bin = bin_in;
 			file_handle = fhandle;
 
 			/* load the level */
-			ok = rd_dungeon(TRUE, Depth);
+			ok = rd_begin() && rd_dungeon(TRUE, Depth);
+			rd_end();
 
 			/* swap the file pointers back */
 			file_handle = server_handle;
+			bin_in = server_bin;
 
 			/* close the level file */
 			file_close(fhandle);
@@ -1727,6 +2169,18 @@ static bool rd_cave_memory(player_type *p_ptr)
 	__try( read_short("max_height", &max_y) );
 	__try( read_short("max_width", &max_x) );
 
+	/* Binary savefiles store the whole plane */
+	if (value_exists("plane"))
+	{
+		static char cave_plane[MAX_HGT * MAX_WID];
+		__try( read_binary("plane", cave_plane, MAX_HGT * MAX_WID) );
+		for (y = 0; y < max_y; y++)
+		{
+			for (x = 0; x < max_x; x++)
+				p_ptr->cave_flag[y][x] = cave_plane[y * MAX_WID + x];
+		}
+	}
+	else
 	for (y = 0; y < max_y; y++)
 	{
 		__try( read_binary("row", cave_row, MAX_WID) );
@@ -1749,7 +2203,7 @@ static bool rd_cave_memory(player_type *p_ptr)
  * changes). It attempts to read out the stored password, and compares it
  * to the password provided in "pass_word". If it matches, the hashed
  * password stored back onto the "pass_word" buff, which is assumed to be
- * of MAX_CHARS length.
+ * of MAX_CHARS length. Binary savefiles are walked record by record.
  *
  * Returns 0 on match, -1 on parsing error and -2 if password do not
  * match.
@@ -1776,8 +2230,29 @@ errr rd_savefile_new_scoop_aux(char *sfile, char *pass_word)
 	/* Paranoia */
 	if (!file_handle) return (-1);
 
+	/* Binary savefile, walk the records */
+	if (!rd_begin())
+	{
+		file_close(file_handle);
+		return (-1);
+	}
+	if (bin_in.data)
+	{
+		bin_record rec;
+		while (bin_peek(&rec))
+		{
+			if (rec.type == SREC_STR && bin_named(&rec, "pass"))
+			{
+				read_pass = bin_bytes("pass", TRUE, pass, 79);
+				break;
+			}
+			if (!bin_consume(&rec)) break;
+		}
+		rd_end();
+	}
+
 	/* Try to fetch the data */
-	while (file_getl(file_handle, buf, 1024))
+	else while (file_getl(file_handle, buf, 1024))
 	{
 		read = strtok(buf, " \t=");
 		if (!strcmp(read, "pass"))
@@ -1845,6 +2320,43 @@ errr rd_savefile_new_scoop_aux(char *sfile, char *pass_word)
 	return (err);
 }
 
+/*
+ * Walk through a savefile without loading anything, counting records.
+ * Used by the "savetest" console command to time parsing on its own.
+ */
+errr scan_savefile(cptr sfile, u32b *records, u32b *bytes)
+{
+	char name[80];
+	errr err = 0;
+
+	*records = *bytes = 0;
+
+	file_handle = file_open(sfile, MODE_READ, -1);
+	if (!file_handle) return (-1);
+
+	if (!rd_begin()) err = -1;
+	else if (bin_in.data)
+	{
+		bin_record rec;
+		*bytes = SAVEFILE_MAGIC_LEN + 1 + bin_in.len;
+		while (bin_peek(&rec) && bin_consume(&rec)) (*records)++;
+		if (bin_in.pos != bin_in.len) err = -1;
+	}
+	else
+	{
+		while (file_getl(file_handle, file_buf, sizeof(file_buf)-1))
+		{
+			*bytes += strlen(file_buf) + 1;
+			if (sscanf(file_buf, "%79s", name) == 1) (*records)++;
+		}
+	}
+
+	rd_end();
+	file_close(file_handle);
+
+	return (err);
+}
+
 /*
  * Actually read the savefile
  *
@@ -2192,7 +2704,8 @@ errr rd_savefile_new(player_type *p_ptr)
 	if (!file_handle) return (-1);
 
 	/* Call the sub-function */
-	err = rd_savefile_new_aux(p_ptr);
+	err = rd_begin() ? rd_savefile_new_aux(p_ptr) : -1;
+	rd_end();
 
 	/* Check for errors */
 	if (file_error(file_handle)) err = -1;
@@ -2204,7 +2717,7 @@ errr rd_savefile_new(player_type *p_ptr)
 	return (err);
 }
 
-errr rd_server_savefile()
+static errr rd_server_savefile_aux(void)
 {
 #undef __try
 #define __try(X) if (!(X)) { exit(1); }
@@ -2213,10 +2726,6 @@ errr rd_server_savefile()
 
         int i;
 
-	errr err = 0;
-
-	char savefile[1024];
-
 	byte tmp8u;
         u16b tmp16u;
         u32b tmp32u;
@@ -2224,14 +2733,6 @@ errr rd_server_savefile()
 	int major;
 	char name[80];
 
-	/* Savefile name */
-	path_build(savefile, 1024, ANGBAND_DIR_SAVE, "server");
-
-	/* The server savefile is a binary file */
-	file_handle = file_open(savefile, MODE_READ, -1);
-	line_counter = 0;
-
-
 	__try( start_section_read("mangband_server_save") );
 	__try( start_section_read("version") );
 	__try( read_int("major", &major) );
@@ -2239,9 +2740,6 @@ errr rd_server_savefile()
 	__try( read_int("patch", &major) );
 	__try( end_section_read("version") );
 
-	/* Paranoia */
-	if (!file_handle) return (-1);
-
         /* Clear the checksums */
         v_check = 0L;
         x_check = 0L;
@@ -2360,7 +2858,14 @@ errr rd_server_savefile()
 		/* load the monsters */
 		for (i = 1; i < tmp32u; i++)
 		{
-			__try( rd_monster(&m_list[m_pop()]) );
+			s16b m_idx = m_pop();
+			__try( rd_monster(&m_list[m_idx]) );
+
+			/* Join the level list */
+			if (m_list[m_idx].r_idx) link_monster(m_idx);
+
+			/* Hack -- older savefiles may have holes */
+			else m_release(m_idx);
 		}
 	__try( end_section_read("monsters") );
 
@@ -2383,6 +2888,16 @@ errr rd_server_savefile()
 
 		/* Set the maximum object number */
 		o_max = tmp16u;
+		o_top = o_max - 1;
+
+		/* Rebuild the level lists */
+		for (i = 1; i < o_max; i++)
+		{
+			if (o_list[i].k_idx) link_object(i);
+
+			/* Hack -- older savefiles may have holes */
+			else o_release(i);
+		}
 	__try( end_section_read("objects") );
 
 		/* Read holding info */
@@ -2432,6 +2947,7 @@ errr rd_server_savefile()
 			__try( rd_house(i) );
 		}
 		num_houses = tmp16u;
+		house_index_rebuild();
 		__try( end_section_read("houses") );
 
 		/* Read arenas info */
@@ -2477,6 +2993,9 @@ errr rd_server_savefile()
 	__try( start_section_read("player_names") );
 	__try( read_int("num_players", &tmp32u) );
 
+		/* Size the name table once, up front */
+		reserve_player_names(tmp32u);
+
 		/* Read the available records */
 		for (i = 0; i < tmp32u; i++)
 		{
@@ -2508,8 +3027,33 @@ errr rd_server_savefile()
 
 	__try( end_section_read("mangband_server_save") );
 
+	/* Success */
+	return (0);
+}
+
+errr rd_server_savefile()
+{
+	errr err;
+
+	char savefile[1024];
+
+	/* Savefile name */
+	path_build(savefile, 1024, ANGBAND_DIR_SAVE, "server");
+
+	/* The server savefile is a binary file */
+	file_handle = file_open(savefile, MODE_READ, -1);
+	line_counter = 0;
+
+	/* Paranoia */
+	if (!file_handle) return (-1);
+
+	/* Text or binary, every way out of the reader ends here */
+	if (!rd_begin()) exit(1);
+	err = rd_server_savefile_aux();
+	rd_end();
+
 	/* Check for errors */
-	if (file_error(file_handle)) err = -1;
+	if (!err && file_error(file_handle)) err = -1;
 
 	/* Close the file */
 	file_close(file_handle);
@@ -31,6 +31,37 @@
   | SERVER_VERSION_PATCH << 4 | SERVER_VERSION_EXTRA)
 
 
+/*
+ * Binary savefile container (see "save.c" and "load2.c")
+ *
+ * A binary savefile starts with the magic string and a format version
+ * byte, followed by a stream of records which mirror the text format
+ * one to one: a record type byte, a name reference and a payload.
+ *
+ * Names are varints indexing a dictionary built while the file is
+ * written; index 0 means "new name follows" (length + bytes), which
+ * is then assigned the next free index.  Sections carry the length
+ * of their body, which the loader checks at the end marker.
+ * Integers are varints (zigzag for signed values), binary blobs are
+ * stored raw or run-length encoded, whichever is shorter.
+ */
+#define SAVEFILE_MAGIC	"MAngSav"
+#define SAVEFILE_MAGIC_LEN	7
+#define SAVEFILE_BINARY_VERSION	1
+#define SAVEFILE_NAMES	1024	/* Size of the name dictionary */
+
+#define SREC_SECTION	1	/* name, u32 body length */
+#define SREC_END    	2	/* name */
+#define SREC_INT    	3	/* name, zigzag varint */
+#define SREC_UINT   	4	/* name, varint */
+#define SREC_HUGE   	5	/* name, varint */
+#define SREC_HTURN  	6	/* name, varint era, varint turn */
+#define SREC_STR    	7	/* name, varint length, bytes */
+#define SREC_RAW    	8	/* name, varint length, bytes */
+#define SREC_RLE    	9	/* name, varint length, varint size, (count, byte) pairs */
+#define SREC_FLOAT  	10	/* name, 4 bytes */
+
+
 /*
  * The maximum number of player ID's
  */
@@ -96,7 +127,7 @@
 #define MAX_ARENAS	10
 
 /*
- * Number of entries in the player name hash table.
+ * Initial number of entries in the player name hash table.
  * This must be a power of 2!
  */
 #define NUM_HASH_ENTRIES	256
@@ -2994,6 +3025,19 @@ that keeps many algorithms happy.
 #define player_has_los_bold(PLR,Y,X) \
     ((PLR->cave_flag[Y][X] & CAVE_VIEW) != 0)
 
+/*
+ * Test, set or clear the bit of entity "I" in a per-player bit array
+ * (see "mon_vis", "obj_vis", etc in "player_type")
+ */
+#define bit_has(A,I) \
+    ((int)(((A)[(I) >> 5] >> ((I) & 31)) & 1))
+#define bit_on(A,I) \
+    ((A)[(I) >> 5] |= (1UL << ((I) & 31)))
+#define bit_off(A,I) \
+    ((A)[(I) >> 5] &= ~(1UL << ((I) & 31)))
+#define bit_put(A,I,V) \
+    ((V) ? bit_on(A,I) : bit_off(A,I))
+
 /*
  * Convert an "attr"/"char" pair into a "pict" (P)
  */
@@ -445,7 +445,7 @@ bool make_attack_spell(player_type *p_ptr, int m_idx)
 	bool blind = (p_ptr->blind ? TRUE : FALSE);
 
 	/* Extract the "see-able-ness" */
-	bool seen = (!blind && p_ptr->mon_vis[m_idx]);
+	bool seen = (!blind && bit_has(p_ptr->mon_vis, m_idx));
 
 
 	/* Assume "normal" target */
@@ -2093,31 +2093,18 @@ static int mon_will_run(player_type *p_ptr, int m_idx)
  * Prefer "non-diagonal" directions, but twiddle them a little
  * to angle slightly towards the player's actual location.
  *
- * Allow very perceptive monsters to track old "spoor" left by
- * previous locations occupied by the player.  This will tend
- * to have monsters end up either near the player or on a grid
- * recently occupied by the player (and left via "teleport").
- *
- * Note that if "smell" is turned on, all monsters get vicious.
- *
- * Also note that teleporting away from a location will cause
- * the monsters who were chasing you to converge on that location
- * as long as you are still near enough to "annoy" them without
- * being close enough to chase directly.  I have no idea what will
- * happen if you combine "smell" with low "aaf" values.
+ * The flow field leads to the nearest player on the level, which is
+ * usually the one the monster is after anyway.
  */
-static bool get_moves_aux(int m_idx, int *yp, int *xp)
+static bool get_moves_aux(player_type *p_ptr, int m_idx, int *yp, int *xp)
 {
-	int i, y, x, y1, x1, when = 0, cost = 999;
+	int i, y, x, y1, x1, cost, best = 0;
 
-	cave_type *c_ptr;
+	flow_type *f_ptr;
 
 	monster_type *m_ptr = &m_list[m_idx];
 	monster_race *r_ptr = &r_info[m_ptr->r_idx];
 
-	/* Monster flowing disabled */
-	if (!flow_by_sound) return (FALSE);
-
 	/* Monster can go through rocks */
 	if (r_ptr->flags2 & RF2_PASS_WALL) return (FALSE);
 	if (r_ptr->flags2 & RF2_KILL_WALL) return (FALSE);
@@ -2126,25 +2113,17 @@ static bool get_moves_aux(int m_idx, int *yp, int *xp)
 	y1 = m_ptr->fy;
 	x1 = m_ptr->fx;
 
-	/* Monster grid */
-	c_ptr = &cave[y1][x1];
-
-	/* The player is not currently near the monster grid */
-	if (c_ptr->when < cave[py][px].when)
-	{
-		/* The player has never been near the monster grid */
-		if (!c_ptr->when) return (FALSE);
+	/* Hack -- Player can see us, run towards him */
+	if (player_has_los_bold(p_ptr, y1, x1)) return (FALSE);
 
-		/* The monster is not allowed to track the player */
-		if (!flow_by_smell) return (FALSE);
-	}
+	/* Get the (shared) flow of this level */
+	f_ptr = update_flow(m_ptr->dun_depth);
+	if (!f_ptr) return (FALSE);
 
 	/* Monster is too far away to notice the player */
-	if (c_ptr->cost > MONSTER_FLOW_DEPTH) return (FALSE);
-	if (c_ptr->cost > r_ptr->aaf) return (FALSE);
-
-	/* Hack -- Player can see us, run towards him */
-	if (player_has_los_bold(y1, x1)) return (FALSE);
+	cost = f_ptr->cost[y1][x1];
+	if (!cost) return (FALSE);
+	if (cost > r_ptr->aaf + 1) return (FALSE);
 
 	/* Check nearby grids, diagonals first */
 	for (i = 7; i >= 0; i--)
@@ -2153,26 +2132,24 @@ static bool get_moves_aux(int m_idx, int *yp, int *xp)
 		y = y1 + ddy_ddd[i];
 		x = x1 + ddx_ddd[i];
 
-		/* Ignore illegal locations */
-		if (!cave[y][x].when) continue;
-
-		/* Ignore ancient locations */
-		if (cave[y][x].when < when) continue;
+		/* Ignore unreached locations */
+		if (!in_bounds2(m_ptr->dun_depth, y, x)) continue;
+		if (!f_ptr->cost[y][x]) continue;
 
 		/* Ignore distant locations */
-		if (cave[y][x].cost > cost) continue;
+		if (f_ptr->cost[y][x] >= cost) continue;
 
-		/* Save the cost and time */
-		when = cave[y][x].when;
-		cost = cave[y][x].cost;
+		/* Save the cost */
+		cost = f_ptr->cost[y][x];
+		best = i + 1;
 
 		/* Hack -- Save the "twiddled" location */
-		(*yp) = py + 16 * ddy_ddd[i];
-		(*xp) = px + 16 * ddx_ddd[i];
+		(*yp) = p_ptr->py + 16 * ddy_ddd[i];
+		(*xp) = p_ptr->px + 16 * ddx_ddd[i];
 	}
 
 	/* No legal move (?) */
-	if (!when) return (FALSE);
+	if (!best) return (FALSE);
 
 	/* Success */
 	return (TRUE);
@@ -2234,11 +2211,10 @@ static void get_moves(player_type *p_ptr, int m_idx, int *mm)
 
 
 #ifdef MONSTER_FLOW
-	/* Flow towards the player */
-	if (flow_by_sound)
+	/* Flow towards the player (but wanderers go their own way) */
+	if (x2 == p_ptr->px && y2 == p_ptr->py)
 	{
-		/* Flow towards the player */
-		(void)get_moves_aux(m_idx, &y2, &x2);
+		(void)get_moves_aux(p_ptr, m_idx, &y2, &x2);
 	}
 #endif
 
@@ -2524,7 +2500,7 @@ static void process_monster(int Ind, int m_idx)
 				m_ptr->csleep -= d;
 
 				/* Notice the "not waking up" */
-				if (p_ptr->mon_vis[m_idx])
+				if (bit_has(p_ptr->mon_vis, m_idx))
 				{
 					/* Hack -- Count the ignores */
 					if (l_ptr->ignore < MAX_UCHAR) l_ptr->ignore++;
@@ -2538,7 +2514,7 @@ static void process_monster(int Ind, int m_idx)
 				m_ptr->csleep = 0;
 
 				/* Notice the "waking up" */
-				if (p_ptr->mon_vis[m_idx])
+				if (bit_has(p_ptr->mon_vis, m_idx))
 				{
 					char m_name[80];
 
@@ -2588,7 +2564,7 @@ static void process_monster(int Ind, int m_idx)
 			m_ptr->stunned = 0;
 
 			/* Message if visible */
-			if (p_ptr->mon_vis[m_idx])
+			if (bit_has(p_ptr->mon_vis, m_idx))
 			{
 				char m_name[80];
 
@@ -2628,7 +2604,7 @@ static void process_monster(int Ind, int m_idx)
 			m_ptr->confused = 0;
 
 			/* Message if visible */
-			if (p_ptr->mon_vis[m_idx])
+			if (bit_has(p_ptr->mon_vis, m_idx))
 			{
 				char m_name[80];
 
@@ -2661,7 +2637,7 @@ static void process_monster(int Ind, int m_idx)
 			m_ptr->monfear = 0;
 
 			/* Visual note */
-			if (p_ptr->mon_vis[m_idx])
+			if (bit_has(p_ptr->mon_vis, m_idx))
 			{
 				char m_name[80];
 				char m_poss[80];
@@ -2705,7 +2681,7 @@ static void process_monster(int Ind, int m_idx)
 				if (multiply_monster(m_idx))
 				{
 					/* Take note if visible */
-					if (p_ptr->mon_vis[m_idx])
+					if (bit_has(p_ptr->mon_vis, m_idx))
 					{
 						l_ptr->flags2 |= RF2_MULTIPLY;
 
@@ -2742,8 +2718,8 @@ static void process_monster(int Ind, int m_idx)
 	         (randint0(100) < 75))
 	{
 		/* Memorize flags */
-		if (p_ptr->mon_vis[m_idx]) l_ptr->flags1 |= RF1_RAND_50;
-		if (p_ptr->mon_vis[m_idx]) l_ptr->flags1 |= RF1_RAND_25;
+		if (bit_has(p_ptr->mon_vis, m_idx)) l_ptr->flags1 |= RF1_RAND_50;
+		if (bit_has(p_ptr->mon_vis, m_idx)) l_ptr->flags1 |= RF1_RAND_25;
 
 		/* Try four "random" directions */
 		mm[0] = mm[1] = mm[2] = mm[3] = 5;
@@ -2754,7 +2730,7 @@ static void process_monster(int Ind, int m_idx)
 	         (randint0(100) < 50))
 	{
 		/* Memorize flags */
-		if (p_ptr->mon_vis[m_idx]) l_ptr->flags1 |= RF1_RAND_50;
+		if (bit_has(p_ptr->mon_vis, m_idx)) l_ptr->flags1 |= RF1_RAND_50;
 
 		/* Try four "random" directions */
 		mm[0] = mm[1] = mm[2] = mm[3] = 5;
@@ -2765,7 +2741,7 @@ static void process_monster(int Ind, int m_idx)
 	         (randint0(100) < 25))
 	{
 		/* Memorize flags */
-		if (p_ptr->mon_vis[m_idx]) l_ptr->flags1 |= RF1_RAND_25;
+		if (bit_has(p_ptr->mon_vis, m_idx)) l_ptr->flags1 |= RF1_RAND_25;
 
 		/* Try four "random" directions */
 		mm[0] = mm[1] = mm[2] = mm[3] = 5;
@@ -3012,7 +2988,7 @@ static void process_monster(int Ind, int m_idx)
 		    (r_ptr->flags1 & RF1_NEVER_BLOW))
 		{
 			/* Hack -- memorize lack of attacks */
-			if (p_ptr->mon_vis[m_idx]) l_ptr->flags1 |= RF1_NEVER_BLOW;
+			if (bit_has(p_ptr->mon_vis, m_idx)) l_ptr->flags1 |= RF1_NEVER_BLOW;
 
 			/* Do not move */
 			do_move = FALSE;
@@ -3049,7 +3025,7 @@ static void process_monster(int Ind, int m_idx)
 		if (do_move && (r_ptr->flags1 & RF1_NEVER_MOVE))
 		{
 			/* Hack -- memorize lack of attacks */
-			if (p_ptr->mon_vis[m_idx]) l_ptr->flags1 |= RF1_NEVER_MOVE;
+			if (bit_has(p_ptr->mon_vis, m_idx)) l_ptr->flags1 |= RF1_NEVER_MOVE;
 
 			/* Do not move */
 			do_move = FALSE;
@@ -3136,9 +3112,9 @@ static void process_monster(int Ind, int m_idx)
 			everyone_lite_spot(Depth, ny, nx);
 
 			/* Possible disturb */
-			if (p_ptr->mon_vis[m_idx] &&
+			if (bit_has(p_ptr->mon_vis, m_idx) &&
 			    (option_p(p_ptr,DISTURB_MOVE) ||
-			     (p_ptr->mon_los[m_idx] &&
+			     (bit_has(p_ptr->mon_los, m_idx) &&
 			      option_p(p_ptr,DISTURB_NEAR))))
 			{
 				/* Disturb */
@@ -3287,7 +3263,7 @@ static void process_monster(int Ind, int m_idx)
 	  l_ptr = p_ptr->l_list + m_ptr->r_idx;
 
 	/* Learn things from observable monster */
-	if (p_ptr->mon_vis[m_idx])
+	if (bit_has(p_ptr->mon_vis, m_idx))
 	{
 		/* Monster opened a door */
 		if (did_open_door) l_ptr->flags2 |= RF2_OPEN_DOOR;
@@ -3322,7 +3298,7 @@ static void process_monster(int Ind, int m_idx)
 		m_ptr->monfear = 0;
 
 		/* Message if seen */
-		if (p_ptr->mon_vis[m_idx])
+		if (bit_has(p_ptr->mon_vis, m_idx))
 		{
 			char m_name[80];
 
@@ -3347,8 +3323,7 @@ static void process_monster(int Ind, int m_idx)
  * (backwards, so we can excise any "freshly dead" monsters), energizing each
  * monster, and allowing fully energized monsters to move, attack, pass, etc.
  *
- * Note that monsters can never move in the monster array (except when the
- * "compact_monsters()" function is called by "dungeon()" or "save_player()").
+ * Note that monsters can never move in the monster array.
  *
  * This function is responsible for at least half of the processor time
  * on a normal system with a "normal" amount of monsters and a player doing
@@ -3360,14 +3335,14 @@ static void process_monster(int Ind, int m_idx)
  * Most of the rest of the time is spent in "update_view()" and "lite_spot()",
  * especially when the player is running.
  *
- * Note the use of the new special "m_fast" array, which allows us to only
- * process monsters which are alive (or at least recently alive), which may
- * provide some optimization, especially when resting.  Note that monsters
- * which are only recently alive are excised, using a simple "excision"
- * method relying on the fact that the array is processed backwards.
+ * Monsters are only processed on levels which have at least one player
+ * who can be noticed (see below), and each monster only looks at the
+ * players on its own level, using the per-level monster lists (see
+ * "link_monster()").  Monsters on empty levels are simply frozen.
  *
- * Note that "new" monsters are always added by "m_pop()" and they are
- * always added at the end of the "m_fast" array.
+ * Note that "new" monsters are always added at the head of their level
+ * list, and each level list is copied before being processed, so that
+ * monsters born this turn wait until the next one.
  */
  
  
@@ -3375,207 +3350,233 @@ void process_monsters(void)
 {
 	int			k, i, e, pl;
 	int			fx, fy;
+	int			g, h, n, num, Depth;
 
 	bool		test;
 
 	monster_type	*m_ptr;
 	monster_race	*r_ptr;
 
+	static s16b	who[MAX_PLAYERS];
+	static s16b	who_depth[MAX_PLAYERS];
+	static s16b	order[MAX_M_IDX];
 
 
-	/* Process the monsters */
-	for (k = m_top - 1; k >= 0; k--)
+	/* Collect the players monsters may notice */
+	for (num = 0, pl = 1; pl <= NumPlayers; pl++)
 	{
-		player_type *p_ptr;
-		int closest = -1, dis_to_closest = 9999, lowhp = 9999;
-		bool closest_in_los = FALSE;
+		player_type *p_ptr = Players[pl];
 
-		/* Access the index */
-		i = m_fast[k];
+		/* Hack -- notice death or departure */
+		if (!p_ptr->alive || p_ptr->death || p_ptr->new_level_flag)
+			continue;
 
-		/* Access the monster */
-		m_ptr = &m_list[i];
+		/* Hack -- Skip him if he's shopping */
+		if (p_ptr->store_num != -1)
+			continue;
 
+		/* Hack -- make the dungeon master invisible to monsters */
+		if (p_ptr->dm_flags & DM_MONSTER_FRIEND) continue;
 
-		/* Excise "dead" monsters */
-		if (!m_ptr->r_idx)
+		/* Keep the list sorted by depth (insertion sort) */
+		for (k = num++; k > 0 && who_depth[k - 1] > p_ptr->dun_depth; k--)
 		{
-			/* Excise the monster */
-			m_fast[k] = m_fast[--m_top];
-
-			/* Skip */
-			continue;
+			who[k] = who[k - 1];
+			who_depth[k] = who_depth[k - 1];
 		}
+		who[k] = pl;
+		who_depth[k] = p_ptr->dun_depth;
+	}
+
+	/* Process each level with players on it */
+	for (g = 0; g < num; g = h)
+	{
+		Depth = who_depth[g];
+
+		/* Find the players on this level */
+		for (h = g + 1; h < num && who_depth[h] == Depth; h++) /* loop */;
 
+		/* Copy the level list */
+		for (n = 0, i = m_on_depth[Depth]; i; i = m_list[i].next_m_idx)
+			order[n++] = i;
 
-		/* Find the closest player */
-		for (pl = 1; pl <= NumPlayers; pl++)
+		/* Process the monsters */
+		for (k = 0; k < n; k++)
 		{
-			int j;
-			bool in_los;
+			player_type *p_ptr;
+			int closest = -1, dis_to_closest = 9999, lowhp = 9999;
+			bool closest_in_los = FALSE;
 
-			p_ptr = Players[pl];
+			/* Access the index */
+			i = order[k];
 
-			/* Hack -- notice death or departure */
-			if (!p_ptr->alive || p_ptr->death || p_ptr->new_level_flag)
-				continue;
+			/* Access the monster */
+			m_ptr = &m_list[i];
 
-			/* Make sure he's on the same dungeon level */
-			if (p_ptr->dun_depth != m_ptr->dun_depth)
-				continue;
+			/* Skip monsters killed (or moved) this turn */
+			if (!m_ptr->r_idx || m_ptr->dun_depth != Depth) continue;
 
-			/* Hack -- Skip him if he's shopping */
-			if (p_ptr->store_num != -1)
-				continue;
+			/* Count */
+			perf_mon_process++;
+
+
+			/* Find the closest player */
+			for (pl = g; pl < h; pl++)
+			{
+				int j;
+				bool in_los;
+
+				p_ptr = Players[who[pl]];
+
+				/* Hack -- notice death or departure */
+				if (!p_ptr->alive || p_ptr->death || p_ptr->new_level_flag)
+					continue;
 
-			/* Hack -- make the dungeon master invisible to monsters */
-			if (p_ptr->dm_flags & DM_MONSTER_FRIEND) continue;
+				/* Make sure he's on the same dungeon level */
+				if (p_ptr->dun_depth != m_ptr->dun_depth)
+					continue;
 
-			/* Compute distance */
-			j = distance(p_ptr->py, p_ptr->px, m_ptr->fy, m_ptr->fx);
+				/* Hack -- Skip him if he's shopping */
+				if (p_ptr->store_num != -1)
+					continue;
 
-			/* Compute los */
-			in_los = player_has_los_bold(p_ptr, m_ptr->fy, m_ptr->fx);
+				/* Hack -- make the dungeon master invisible to monsters */
+				if (p_ptr->dm_flags & DM_MONSTER_FRIEND) continue;
 
-			/* Skip if _not_ in LoS while closest _is_ in */
-			if (!in_los && closest_in_los) continue;
+				/* Compute distance */
+				j = distance(p_ptr->py, p_ptr->px, m_ptr->fy, m_ptr->fx);
+
+				/* Compute los */
+				in_los = player_has_los_bold(p_ptr, m_ptr->fy, m_ptr->fx);
+
+				/* Skip if _not_ in LoS while closest _is_ in */
+				if (!in_los && closest_in_los) continue;
 			
-			/* Only check distance if they share LoS properties */		
-			else if (closest_in_los == in_los) 
-			{
-				/* Skip if further than closest */
-				if (j > dis_to_closest) continue;
+				/* Only check distance if they share LoS properties */		
+				else if (closest_in_los == in_los) 
+				{
+					/* Skip if further than closest */
+					if (j > dis_to_closest) continue;
 	
-				/* Skip if same distance and stronger */
-				if (j == dis_to_closest && p_ptr->chp > lowhp) continue;
+					/* Skip if same distance and stronger */
+					if (j == dis_to_closest && p_ptr->chp > lowhp) continue;
+				}
+				/* Remember this player */
+				dis_to_closest = j;
+				closest = who[pl];
+				lowhp = p_ptr->chp;
+				closest_in_los = in_los;
 			}
-			/* Remember this player */
-			dis_to_closest = j;
-			closest = pl;
-			lowhp = p_ptr->chp;
-			closest_in_los = in_los;
-		}
 
-		/* Obtain the energy boost */
-		e = extract_energy[m_ptr->mspeed];
+			/* Obtain the energy boost */
+			e = extract_energy[m_ptr->mspeed];
 		
-		/* If we are within a players time bubble, scale our energy */
-		if(closest > -1)
-		{
-			e = e * ((float)time_factor(Players[closest]) / 100);
-		}
+			/* If we are within a players time bubble, scale our energy */
+			if(closest > -1)
+			{
+				e = e * ((float)time_factor(Players[closest]) / 100);
+			}
 
-		/* Give this monster some energy */
-		m_ptr->energy += e;
+			/* Give this monster some energy */
+			m_ptr->energy += e;
 
-		/* Make sure we don't store up too much energy */
-		if (m_ptr->energy > level_speed(m_ptr->dun_depth))
-			m_ptr->energy = level_speed(m_ptr->dun_depth);
+			/* Make sure we don't store up too much energy */
+			if (m_ptr->energy > level_speed(m_ptr->dun_depth))
+				m_ptr->energy = level_speed(m_ptr->dun_depth);
 
-		/* Not enough energy to move */
-		if (m_ptr->energy < level_speed(m_ptr->dun_depth)) continue;
+			/* Not enough energy to move */
+			if (m_ptr->energy < level_speed(m_ptr->dun_depth)) continue;
 		
-		/* Use some energy */
-		m_ptr->energy -= level_speed(m_ptr->dun_depth);
+			/* Use some energy */
+			m_ptr->energy -= level_speed(m_ptr->dun_depth);
 
-		/* Paranoia -- Make sure we found a closest player */
-		if (closest == -1)
-			continue;
+			/* Paranoia -- Make sure we found a closest player */
+			if (closest == -1)
+				continue;
 
-		p_ptr = Players[closest];
+			p_ptr = Players[closest];
 
-		/* Hack -- calculate the "player noise" */
-		/* noise = (1L << (30 - p_ptr->skill_stl)); // we can do better */
+			/* Hack -- calculate the "player noise" */
+			/* noise = (1L << (30 - p_ptr->skill_stl)); // we can do better */
 
-		/* If player has acted this turn, use that noise value (cap to 30) */
-		if (p_ptr->noise)
-		{
-			noise = (1L << (MIN(30, p_ptr->noise)));
-		}
-		/* If player hasn't acted, 1/100 chance to make noise */
-		else if (randint1(100) == 1)
-		{
-			noise = (1L << (30 - p_ptr->skill_stl));
-		}
-		/* Player is totally silent */
-		else noise = 0;
+			/* If player has acted this turn, use that noise value (cap to 30) */
+			if (p_ptr->noise)
+			{
+				noise = (1L << (MIN(30, p_ptr->noise)));
+			}
+			/* If player hasn't acted, 1/100 chance to make noise */
+			else if (randint1(100) == 1)
+			{
+				noise = (1L << (30 - p_ptr->skill_stl));
+			}
+			/* Player is totally silent */
+			else noise = 0;
 
-		m_ptr->cdis = dis_to_closest;
-		m_ptr->closest_player = closest;
+			m_ptr->cdis = dis_to_closest;
+			m_ptr->closest_player = closest;
 
-		/* Access the race */
-		r_ptr = &r_info[m_ptr->r_idx];
+			/* Access the race */
+			r_ptr = &r_info[m_ptr->r_idx];
 
-		/* Hack -- Require proximity unless this is a wanderer */
-		if ( !(r_ptr->flags2 & RF2_WANDERER) )
-		{
-			if (m_ptr->cdis >= 100) continue;
-		}
+			/* Hack -- Require proximity unless this is a wanderer */
+			if ( !(r_ptr->flags2 & RF2_WANDERER) )
+			{
+				if (m_ptr->cdis >= 100) continue;
+			}
 
-		/* Access the location */
-		fx = m_ptr->fx;
-		fy = m_ptr->fy;
+			/* Access the location */
+			fx = m_ptr->fx;
+			fy = m_ptr->fy;
 
-		/* Assume no move */
-		test = FALSE;
+			/* Assume no move */
+			test = FALSE;
 
-		/* Handle "sensing radius" */
-		if (m_ptr->cdis <= r_ptr->aaf)
-		{
-			/* We can "sense" the player */
-			test = TRUE;
-		}
-
-		/* Handle "sight" and "aggravation" */
-		else if ((m_ptr->cdis <= MAX_SIGHT) &&
-		         (closest_in_los || p_ptr->aggravate))
-		{
-			/* We can "see" or "feel" the player */
-			test = TRUE;
-		}
+			/* Handle "sensing radius" */
+			if (m_ptr->cdis <= r_ptr->aaf)
+			{
+				/* We can "sense" the player */
+				test = TRUE;
+			}
 
-#ifdef MONSTER_FLOW
-		/* Hack -- Monsters can "smell" the player from far away */
-		/* Note that most monsters have "aaf" of "20" or so */
-		else if (flow_by_sound &&
-		         (cave[py][px].when == cave[fy][fx].when) &&
-		         (cave[fy][fx].cost < MONSTER_FLOW_DEPTH) &&
-		         (cave[fy][fx].cost < r_ptr->aaf))
-		{
-			/* We can "smell" the player */
-			test = TRUE;
-		}
-#endif
+			/* Handle "sight" and "aggravation" */
+			else if ((m_ptr->cdis <= MAX_SIGHT) &&
+			         (closest_in_los || p_ptr->aggravate))
+			{
+				/* We can "see" or "feel" the player */
+				test = TRUE;
+			}
 
-		/* Do nothing unless a wanderer */
-		if (!test && !(r_ptr->flags2 & RF2_WANDERER) ) continue;
+			/* Do nothing unless a wanderer */
+			if (!test && !(r_ptr->flags2 & RF2_WANDERER) ) continue;
 
 
-		/* Process the monster */
-		process_monster(closest, i);
+			/* Process the monster */
+			process_monster(closest, i);
+		}
 	}
 
 	/* Only when needed, every five game turns */
 	if (scan_monsters && (!(turn.turn%5)))
 	{
-		/* Shimmer multi-hued monsters */
-		for (i = 1; i < m_max; i++)
+		/* Shimmer multi-hued monsters (nobody sees the empty levels) */
+		for (g = 0; g < num; g = h)
 		{
-			monster_race *r_ptr;
-
-			m_ptr = &m_list[i];
+			for (h = g + 1; h < num && who_depth[h] == who_depth[g]; h++) /* loop */;
+			for (i = m_on_depth[who_depth[g]]; i; i = m_list[i].next_m_idx)
+			{
+				monster_race *r_ptr;
 
-			/* Skip dead monsters */
-			if (!m_ptr->r_idx) continue;
+				m_ptr = &m_list[i];
 
-			/* Access the monster race */
-			r_ptr = &r_info[m_ptr->r_idx];
+				/* Access the monster race */
+				r_ptr = &r_info[m_ptr->r_idx];
 
-			/* Skip non-multi-hued monsters */
-			if (!(r_ptr->flags1 & RF1_ATTR_MULTI)) continue;
+				/* Skip non-multi-hued monsters */
+				if (!(r_ptr->flags1 & RF1_ATTR_MULTI)) continue;
 
-			/* Shimmer Multi-Hued Monsters */
-			everyone_lite_spot(m_ptr->dun_depth, m_ptr->fy, m_ptr->fx);
+				/* Shimmer Multi-Hued Monsters */
+				everyone_lite_spot(m_ptr->dun_depth, m_ptr->fy, m_ptr->fx);
+			}
 		}
 	}
 }
@@ -35,6 +35,50 @@ bool allow_unique_level(int r_idx, int Depth)
 }
 
 
+/*
+ * Add a monster to the list of monsters on its level.
+ *
+ * Every "live" monster is kept on exactly one of these lists, so that
+ * code which only cares about a single level (or only about levels
+ * with players on them) can avoid scanning the whole "m_list[]".
+ */
+void link_monster(int m_idx)
+{
+	monster_type *m_ptr = &m_list[m_idx];
+	int next = m_on_depth[m_ptr->dun_depth];
+
+	/* Place at the head of the level list */
+	m_ptr->prev_m_idx = 0;
+	m_ptr->next_m_idx = next;
+	if (next) m_list[next].prev_m_idx = m_idx;
+	m_on_depth[m_ptr->dun_depth] = m_idx;
+
+	/* Count it */
+	m_num_depth[m_ptr->dun_depth]++;
+}
+
+/*
+ * Remove a monster from the list of monsters on its level.
+ */
+void unlink_monster(int m_idx)
+{
+	monster_type *m_ptr = &m_list[m_idx];
+
+	if (m_ptr->prev_m_idx)
+		m_list[m_ptr->prev_m_idx].next_m_idx = m_ptr->next_m_idx;
+	else if (m_on_depth[m_ptr->dun_depth] == m_idx)
+		m_on_depth[m_ptr->dun_depth] = m_ptr->next_m_idx;
+
+	if (m_ptr->next_m_idx)
+		m_list[m_ptr->next_m_idx].prev_m_idx = m_ptr->prev_m_idx;
+
+	m_ptr->prev_m_idx = m_ptr->next_m_idx = 0;
+
+	/* Uncount it */
+	m_num_depth[m_ptr->dun_depth]--;
+}
+
+
 /*
  * Delete a monster by index.
  *
@@ -42,7 +86,7 @@ bool allow_unique_level(int r_idx, int Depth)
  * all intents and purposes.  The monster record is left in place
  * but the record is wiped, marking it as "dead" (no race index)
  * so that it can be "skipped" when scanning the monster array,
- * and "excised" from the "m_fast" array when needed.
+ * and its index is handed back to "m_pop()".
  *
  * Thus, anyone who makes direct reference to the "m_list[]" array
  * using monster indexes that may have become invalid should be sure
@@ -105,8 +149,14 @@ void delete_monster_idx(int i)
 	/* Visual update */
 	everyone_lite_spot(Depth, y, x);
 
+	/* Leave the level list */
+	unlink_monster(i);
+
 	/* Wipe the Monster */
 	WIPE(m_ptr, monster_type);
+
+	/* Free the index */
+	m_release(i);
 }
 
 
@@ -131,79 +181,7 @@ void delete_monster(int Depth, int y, int x)
 }
 
 /*
- * Move a monster from index i1 to index i2 in the monster list
- */
-static void compact_monsters_aux(int i1, int i2)
-{
-	int y, x, Depth;
-	int Ind;
-
-	monster_type *m_ptr;
-
-	s16b this_o_idx, next_o_idx = 0;
-
-
-	/* Do nothing */
-	if (i1 == i2) return;
-
-
-	/* Old monster */
-	m_ptr = &m_list[i1];
-
-	/* Location */
-	y = m_ptr->fy;
-	x = m_ptr->fx;
-	Depth = m_ptr->dun_depth;
-	/* Update the cave */
-	/* Hack -- make sure the level is allocated, as in the wilderness
-	   it sometimes will not be */
-	if (cave[Depth])			
-		cave[Depth][y][x].m_idx = i2;
-
-
-	/* Repair objects being carried by monster */
-	for (this_o_idx = m_ptr->hold_o_idx; this_o_idx; this_o_idx = next_o_idx)
-	{
-		object_type *o_ptr;
-
-		/* Get the object */
-		o_ptr = &o_list[this_o_idx];
-
-		/* Get the next object */
-		next_o_idx = o_ptr->next_o_idx;
-
-		/* Reset monster pointer */
-		o_ptr->held_m_idx = i2;
-	}
-	
-	/* Copy the visibility and los flags for the players */
-	for (Ind = 1; Ind <= NumPlayers; Ind++)
-	{
-
-		Players[Ind]->mon_vis[i2] = Players[Ind]->mon_vis[i1];
-		Players[Ind]->mon_los[i2] = Players[Ind]->mon_los[i1];
-		Players[Ind]->mon_det[i2] = Players[Ind]->mon_det[i1];
-		
-		/* Hack -- copy hurt flag */
-		Players[Ind]->mon_hrt[i2] = Players[Ind]->mon_hrt[i1];;
-
-		/* Hack -- Update the target */
-		if (Players[Ind]->target_who == (int)(i1)) Players[Ind]->target_who = i2;
-
-		/* Hack -- Update the health bar */
-		if (Players[Ind]->health_who == (int)(i1)) health_track(Players[Ind], i2);
-	}
-
-	/* Hack -- move monster */
-	COPY(&m_list[i2], &m_list[i1], monster_type);
-
-	/* Hack -- wipe hole */
-	(void)WIPE(&m_list[i1], monster_type);
-}
-
-
-/*
- * Compact and Reorder the monster list
+ * Compact the monster list
  *
  * This function can be very dangerous, use with caution!
  *
@@ -211,8 +189,8 @@ static void compact_monsters_aux(int i1, int i2)
  * on a combination of monster level, distance from player, and
  * current "desperation".
  *
- * After "compacting" (if needed), we "reorder" the monsters into a more
- * compact order, and we reset the allocation info, and the "live" array.
+ * Monsters are never moved around, the indexes of the deleted ones
+ * simply go back to "m_pop()".
  */
 void compact_monsters(int size)
 {
@@ -222,8 +200,11 @@ void compact_monsters(int size)
 
 	//s16b this_o_idx, next_o_idx = 0;
 
-	/* Message (only if compacting) */
-	if (size) plog("Compacting monsters...");
+	/* Nothing to do */
+	if (!size) return;
+
+	/* Message */
+	plog("Compacting monsters...");
 
 
 	/* Compact at least 'size' objects */
@@ -273,37 +254,6 @@ void compact_monsters(int size)
 			num++;
 		}
 	}
-
-
-	/* Excise dead monsters (backwards!) */
-	for (i = m_max - 1; i >= 1; i--)
-	{
-		/* Get the i'th monster */
-		monster_type *m_ptr = &m_list[i];
-
-		/* Skip real monsters */
-		if (m_ptr->r_idx) continue;
-		
-		/* Move last monster into open hole */
-		compact_monsters_aux(m_max - 1, i);
-
-		/* One less monster */
-		m_max--;
-	}
-
-	/* Reset "m_nxt" */
-	m_nxt = m_max;
-
-
-	/* Reset "m_top" */
-	m_top = 0;
-
-	/* Collect "live" monsters */
-	for (i = 1; i < m_max; i++)
-	{
-		/* Collect indexes */
-		m_fast[m_top++] = i;
-	}
 }
 
 
@@ -358,17 +308,11 @@ void wipe_m_list(int Depth)
 	health_track(0);
 #endif
 
-	/* Delete all the monsters */
-	for (i = m_max - 1; i >= 1; i--)
+	/* Delete all the monsters on this level */
+	while ((i = m_on_depth[Depth]))
 	{
-		monster_type *m_ptr = &m_list[i];
-
-		if (m_ptr->dun_depth == Depth)
-			delete_monster_idx(i);
+		delete_monster_idx(i);
 	}
-
-	/* Compact the monster list */
-	compact_monsters(0);
 }
 
 
@@ -377,13 +321,29 @@ void wipe_m_list(int Depth)
  *
  * This routine should almost never fail, but it *can* happen.
  *
- * Note that this function must maintain the special "m_fast"
- * array of indexes of "live" monsters.
+ * Indexes of deleted monsters are kept on the "m_free" stack, and
+ * reused before "m_max" grows, so this takes constant time.  The
+ * index of a live monster never changes.
  */
 s16b m_pop(void)
 {
-	int i, n, k;
+	int i;
+
+	/* Reuse a free index */
+	while (m_free_num)
+	{
+		i = m_free[--m_free_num];
+		bit_off(m_freed, i);
+
+		/* Paranoia -- skip monsters in use */
+		if (m_list[i].r_idx) continue;
+
+		/* Count it */
+		m_top++;
 
+		/* Use this monster */
+		return (i);
+	}
 
 	/* Normal allocation */
 	if (m_max < MAX_M_IDX)
@@ -394,45 +354,19 @@ s16b m_pop(void)
 		/* Expand the array */
 		m_max++;
 
-		/* Update "m_fast" */
-		m_fast[m_top++] = i;
+		/* Count it */
+		m_top++;
 
 		/* Return the index */
 		return (i);
 	}
 
-
-	/* Check for some space */
-	for (n = 1; n < MAX_M_IDX; n++)
+	/* Hack -- recover any dead monster not handed back */
+	for (i = m_max - 1; i >= 1; i--)
 	{
-		/* Get next space */
-		i = m_nxt;
-
-		/* Advance (and wrap) the "next" pointer */
-		if (++m_nxt >= MAX_M_IDX) m_nxt = 1;
-
-		/* Skip monsters in use */
-		if (m_list[i].r_idx) continue;
-
-		/* Verify space XXX XXX */
-		if (m_top >= MAX_M_IDX) continue;
-
-		/* Verify not allocated */
-		for (k = 0; k < m_top; k++)
-		{
-			/* Hack -- Prevent errors */
-			if (m_fast[k] == i) i = 0;
-		}
-
-		/* Oops XXX XXX */
-		if (!i) continue;
-
-		/* Update "m_fast" */
-		m_fast[m_top++] = i;
-
-		/* Use this monster */
-		return (i);
+		if (!m_list[i].r_idx) m_release(i);
 	}
+	if (m_free_num) return (m_pop());
 
 
 	/* Warn the player */
@@ -443,8 +377,30 @@ s16b m_pop(void)
 }
 
 
+/*
+ * Hand the index of a dead monster back to "m_pop()"
+ */
+void m_release(int m_idx)
+{
+	/* Already free */
+	if (bit_has(m_freed, m_idx)) return;
+
+	/* Push it */
+	bit_on(m_freed, m_idx);
+	m_free[m_free_num++] = m_idx;
+
+	/* Uncount it */
+	m_top--;
+}
+
+
 
 
+/*
+ * The running totals of the "monster allocation table" are out of date
+ */
+static bool alloc_race_dirty = TRUE;
+
 /*
  * Apply a "monster restriction function" to the "monster allocation table"
  */
@@ -473,19 +429,40 @@ errr get_mon_num_prep(void)
 		}
 	}
 
+	/* Recount on next use */
+	alloc_race_dirty = TRUE;
+
 	/* Success */
 	return (0);
 }
 
 
+/*
+ * Recompute the running totals of the "monster allocation table"
+ */
+static void get_mon_num_total(void)
+{
+	int i;
+	u32b total = 0L;
+
+	for (i = 0; i < alloc_race_size; i++)
+	{
+		total += alloc_race_table[i].prob2;
+		alloc_race_table[i].total = total;
+	}
+
+	alloc_race_dirty = FALSE;
+}
+
 
 /*
  * Choose a monster race that seems "appropriate" to the given level
  *
- * This function uses the "prob2" field of the "monster allocation table",
- * and various local information, to calculate the "prob3" field of the
- * same table, which is then used to choose an "appropriate" monster, in
- * a relatively efficient manner.
+ * This function uses the running totals of the "prob2" field of the
+ * "monster allocation table" to choose an "appropriate" monster with
+ * a binary search.  The legal monsters always form a single run of the
+ * (level sorted) table, so the result is exactly what a linear walk
+ * over per-level probabilities would have picked.
  *
  * Note that "town" monsters will *only* be created in the town, and
  * "normal" monsters will *never* be created in the town, unless the
@@ -515,12 +492,9 @@ s16b get_mon_num(int level)
 {
 	int			i, j, p, d1 = 0, d2 = 0;
 
-	int			r_idx;
+	int			lo, hi;
 
-	long		value, total;
-
-	monster_race	*r_ptr;
-	monster_type	*m_ptr;
+	u32b		base, total;
 
 	alloc_entry		*table = alloc_race_table;
 
@@ -538,22 +512,7 @@ s16b get_mon_num(int level)
 	}
 
 	/* Limit the total number of townies */
-	j = 0;
-	if (level == 0)
-	{
-		for (i = m_top - 1; i >= 0; i--)
-		{
-			/* Access the index */
-			p = m_fast[i];
-
-			/* Access the monster */
-			m_ptr = &m_list[p];
-			
-			/* Count townies */
-			if (m_ptr->dun_depth == 0) j++;
-		}
-	}
-	if (j > cfg_max_townies) return(0);
+	if ((level == 0) && (m_num_depth[0] > cfg_max_townies)) return(0);
 	
 
 	if (level > 0)
@@ -587,80 +546,31 @@ s16b get_mon_num(int level)
 		level += ((d2 < 5) ? d2 : 5);
 	} */
 
-	/* Reset total */
-	total = 0L;
-
-	/* Process probabilities */
-	for (i = 0; i < alloc_race_size; i++)
-	{
-		/* Monsters are sorted by depth */
-		if (table[i].level > level) break;
-
-
-		/* XXX disabling this 
-		{
-			 ceiling 
-			if (table[i].level > -level) break;
-			 floor 
-			if (table[i].level < level) continue; 
-		}
-		*/
-
-		/* Default */
-		table[i].prob3 = 0;
+	/* Bring the running totals up to date */
+	if (alloc_race_dirty) get_mon_num_total();
 
-		/* Hack -- No town monsters in the dungeon */
-		if ((level > 0) && (table[i].level <= 0)) continue;
+	/* Monsters are sorted by depth */
+	hi = alloc_level_end(table, alloc_race_size, level);
 
-		/* Access the "r_idx" of the chosen monster */
-		r_idx = table[i].index;
+	/* Hack -- No town monsters in the dungeon */
+	lo = (level > 0) ? alloc_level_end(table, hi, 0) : 0;
 
-		/* Access the actual race */
-		r_ptr = &r_info[r_idx];
-
-		/* Hack -- "unique" monsters must be "unique" */
-        /*if ((r_ptr->flags1 & RF1_UNIQUE) &&
-		    (r_ptr->cur_num >= r_ptr->max_num))
-		{
-			continue;
-        }*/
-
-		/* Depth Monsters never appear out of depth */
-		/* FIXME: This might cause FORCE_DEPTH monsters to appear out of depth */
-		if ((r_ptr->flags1 & RF1_FORCE_DEPTH) && (r_ptr->level > level))
-		{
-			continue;
-		}
-
-		/* Unique Monsters never appear in the wilderness */
-		if ((r_ptr->flags1 & RF1_UNIQUE) && (level < 0))
-		{
-			continue;
-		}
-
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
+	/*
+	 * Note that "FORCE_DEPTH" monsters past "level" and "UNIQUE" monsters
+	 * in the wilderness (negative levels) are already excluded, as their
+	 * table entries lie beyond "hi".  Unique "cur_num" is not checked here.
+	 */
 
-		/* Total */
-		total += table[i].prob3;
-	}
+	/* Total the legal monsters */
+	base = (lo > 0) ? table[lo - 1].total : 0L;
+	total = (hi > lo) ? table[hi - 1].total - base : 0L;
 
 	/* No legal monsters */
 	if (total <= 0) return (0);
 
 
 	/* Pick a monster */
-	value = randint0(total);
-
-	/* Find the monster */
-	for (i = 0; i < alloc_race_size; i++)
-	{
-		/* Found the entry */
-		if (value < table[i].prob3) break;
-
-		/* Decrement */
-		value = value - table[i].prob3;
-	}
+	i = alloc_pick(table, lo, hi, base + randint0(total));
 
 
 	/* Power boost */
@@ -673,17 +583,7 @@ s16b get_mon_num(int level)
 		j = i;
 
 		/* Pick a monster */
-		value = randint0(total);
-
-		/* Find the monster */
-		for (i = 0; i < alloc_race_size; i++)
-		{
-			/* Found the entry */
-			if (value < table[i].prob3) break;
-
-			/* Decrement */
-			value = value - table[i].prob3;
-		}
+		i = alloc_pick(table, lo, hi, base + randint0(total));
 
 		/* Keep the "best" one */
 		if (abs(table[i].level) < abs(table[j].level)) i = j;
@@ -696,17 +596,7 @@ s16b get_mon_num(int level)
 		j = i;
 
 		/* Pick a monster */
-		value = randint0(total);
-
-		/* Find the monster */
-		for (i = 0; i < alloc_race_size; i++)
-		{
-			/* Found the entry */
-			if (value < table[i].prob3) break;
-
-			/* Decrement */
-			value = value - table[i].prob3;
-		}
+		i = alloc_pick(table, lo, hi, base + randint0(total));
 
 		/* Keep the "best" one */
 		if (abs(table[i].level) < abs(table[j].level)) i = j;
@@ -745,7 +635,7 @@ void display_monlist(player_type *p_ptr)
 		m_ptr = &m_list[idx];
 
 		/* Only visible monsters */
-		if (!p_ptr->mon_vis[idx]) continue;
+		if (!bit_has(p_ptr->mon_vis, idx)) continue;
 
 		/* Hack -- ignore mimics, unless DM */
 		if (m_ptr->mimic_k_idx && !(p_ptr->dm_flags & DM_SEE_MONSTERS)) continue;
@@ -762,7 +652,7 @@ void display_monlist(player_type *p_ptr)
 		m_ptr = &m_list[idx];
 
 		/* Only visible monsters */
-		if (!p_ptr->mon_vis[idx]) continue;
+		if (!bit_has(p_ptr->mon_vis, idx)) continue;
 
 		/* Do each race only once */
 		if (!race_counts[m_ptr->r_idx]) continue;
@@ -812,7 +702,7 @@ void display_monlist(player_type *p_ptr)
 	for (idx = 1; idx <= NumPlayers; idx++)
 	{
 		/* Only visible players */
-		if (!p_ptr->play_vis[idx]) continue;
+		if (!bit_has(p_ptr->play_vis, idx)) continue;
 
 		q_ptr = Players[idx];
 
@@ -909,7 +799,7 @@ void monster_desc(player_type *p_ptr, char *desc, int m_idx, int mode)
 	if (p_ptr)
 	{
 		/* Can we "see" it (exists + forced, or visible + not unforced) */
-		seen = (m_ptr && ((mode & 0x80) || (!(mode & 0x40) && p_ptr->mon_vis[m_idx])));
+		seen = (m_ptr && ((mode & 0x80) || (!(mode & 0x40) && bit_has(p_ptr->mon_vis, m_idx))));
 	}
 	else
 	{
@@ -1144,6 +1034,10 @@ s16b monster_carry(player_type *p_ptr, int m_idx, object_type *j_ptr)
 		/* Forget location */
 		o_ptr->iy = o_ptr->ix = 0;
 
+		/* Join the monster's level */
+		o_ptr->dun_depth = m_ptr->dun_depth;
+		link_object(o_idx);
+
 		/* Link the object to the monster */
 		o_ptr->held_m_idx = m_idx;
 
@@ -1218,7 +1112,7 @@ void reveal_mimic(int m_idx)
 		/* Skip players on different depth */
 		if (p_ptr->dun_depth != m_ptr->dun_depth) continue;
 		/* Skip players who don't see this monster */
-		if (!p_ptr->mon_vis[m_idx]) continue;
+		if (!bit_has(p_ptr->mon_vis, m_idx)) continue;
 
 		lite_spot(p_ptr, m_ptr->fy, m_ptr->fx);
 		p_ptr->window |= PW_ITEMLIST | PW_MONLIST;
@@ -1229,7 +1123,7 @@ void reveal_mimic(int m_idx)
 void forget_monster(player_type *p_ptr, int m_idx, bool deleted)
 {
 	/* Was visible? Update monster list then */
-	if (p_ptr->mon_vis[m_idx]) p_ptr->window |= (PW_MONLIST);
+	if (bit_has(p_ptr->mon_vis, m_idx)) p_ptr->window |= (PW_MONLIST);
 
 	/* Remove cursor tracking */
 	if (p_ptr->cursor_who == m_idx)
@@ -1249,12 +1143,12 @@ void forget_monster(player_type *p_ptr, int m_idx, bool deleted)
 	if (p_ptr->health_who == m_idx) health_track(p_ptr, 0);
 
 	/* Clear all visibility flags */
-	p_ptr->mon_vis[m_idx] = FALSE;
-	p_ptr->mon_los[m_idx] = FALSE;
+	bit_off(p_ptr->mon_vis, m_idx);
+	bit_off(p_ptr->mon_los, m_idx);
 	p_ptr->mon_det[m_idx] = 0;
 
 	/* Remove hurt flag (only if monster is completely dead) */
-	if (deleted) p_ptr->mon_hrt[m_idx] = FALSE;
+	if (deleted) bit_off(p_ptr->mon_hrt, m_idx);
 }
 
 /*
@@ -1458,10 +1352,10 @@ void update_mon(int m_idx, bool dist)
 		if (flag)
 		{
 			/* It was previously unseen */
-			if (!p_ptr->mon_vis[m_idx])
+			if (!bit_has(p_ptr->mon_vis, m_idx))
 			{
 				/* Mark as visible */
-				p_ptr->mon_vis[m_idx] = TRUE;
+				bit_on(p_ptr->mon_vis, m_idx);
 
 				/* Draw the monster */
 				lite_spot(p_ptr, fy, fx);
@@ -1496,10 +1390,10 @@ void update_mon(int m_idx, bool dist)
 		else
 		{
 			/* It was previously seen */
-			if (p_ptr->mon_vis[m_idx])
+			if (bit_has(p_ptr->mon_vis, m_idx))
 			{
 				/* Mark as not visible */
-				p_ptr->mon_vis[m_idx] = FALSE;
+				bit_off(p_ptr->mon_vis, m_idx);
 
 				/* Erase the monster */
 				lite_spot(p_ptr, fy, fx);
@@ -1520,10 +1414,10 @@ void update_mon(int m_idx, bool dist)
 		if (easy || (hard && nearby))
 		{
 			/* Change */
-			if (!p_ptr->mon_los[m_idx])
+			if (!bit_has(p_ptr->mon_los, m_idx))
 			{
 				/* Mark as easily visible */
-				p_ptr->mon_los[m_idx] = TRUE;
+				bit_on(p_ptr->mon_los, m_idx);
 
 				/* Disturb on appearance */
 				if (option_p(p_ptr,DISTURB_NEAR)) disturb(p_ptr, 1, 0);
@@ -1534,10 +1428,10 @@ void update_mon(int m_idx, bool dist)
 		else
 		{
 			/* Change */
-			if (p_ptr->mon_los[m_idx])
+			if (bit_has(p_ptr->mon_los, m_idx))
 			{
 				/* Mark as not easily visible */
-				p_ptr->mon_los[m_idx] = FALSE;
+				bit_off(p_ptr->mon_los, m_idx);
 
 				/* Disturb on disappearance */
 				if (option_p(p_ptr,DISTURB_NEAR)) disturb(p_ptr, 1, 0);
@@ -1552,16 +1446,41 @@ void update_mon(int m_idx, bool dist)
 
 
 /*
- * This function simply updates all the (non-dead) monsters (see above).
+ * This function simply updates all the (non-dead) monsters on the
+ * given level (see above).
+ *
+ * Monsters on other levels are not affected by anything happening
+ * here, so they are left alone.
  */
-void update_monsters(bool dist)
+void update_monsters(int Depth, bool dist)
 {
 	int          i;
 
 	/* Efficiency -- Clear multihued flag */
 	scan_monsters = FALSE;
 
-	/* Update each (live) monster */
+	/* Update each (live) monster on the level */
+	for (i = m_on_depth[Depth]; i; i = m_list[i].next_m_idx)
+	{
+		/* Update the monster */
+		update_mon(i, dist);
+
+		/* Count */
+		perf_mon_updates++;
+	}
+}
+
+
+/*
+ * Forget every monster the player remembers from other levels.
+ *
+ * Called when the player arrives on a new level, since nobody will
+ * call "update_mon()" on the monsters he left behind.
+ */
+void forget_monsters_elsewhere(player_type *p_ptr)
+{
+	int i;
+
 	for (i = 1; i < m_max; i++)
 	{
 		monster_type *m_ptr = &m_list[i];
@@ -1569,8 +1488,11 @@ void update_monsters(bool dist)
 		/* Skip dead monsters */
 		if (!m_ptr->r_idx) continue;
 
-		/* Update the monster */
-		update_mon(i, dist);
+		/* Skip monsters on this level */
+		if (m_ptr->dun_depth == p_ptr->dun_depth) continue;
+
+		/* Forget it */
+		forget_monster(p_ptr, i, FALSE);
 	}
 }
 
@@ -1682,10 +1604,10 @@ void update_player(player_type *q_ptr)
 		if (flag)
 		{
 			/* It was previously unseen */
-			if (!p_ptr->play_vis[q_ptr->Ind])
+			if (!bit_has(p_ptr->play_vis, q_ptr->Ind))
 			{
 				/* Mark as visible */
-				p_ptr->play_vis[q_ptr->Ind] = TRUE;
+				bit_on(p_ptr->play_vis, q_ptr->Ind);
 
 				/* Draw the player */
 				lite_spot(p_ptr, py, px);
@@ -1706,10 +1628,10 @@ void update_player(player_type *q_ptr)
 		else
 		{
 			/* It was previously seen */
-			if (p_ptr->play_vis[q_ptr->Ind])
+			if (bit_has(p_ptr->play_vis, q_ptr->Ind))
 			{
 				/* Mark as not visible */
-				p_ptr->play_vis[q_ptr->Ind] = FALSE;
+				bit_off(p_ptr->play_vis, q_ptr->Ind);
 
 				/* Erase the player */
 				lite_spot(p_ptr, py, px);
@@ -1730,10 +1652,10 @@ void update_player(player_type *q_ptr)
 		if (easy || (hard && nearby))
 		{
 			/* Change */
-			if (!p_ptr->play_los[q_ptr->Ind])
+			if (!bit_has(p_ptr->play_los, q_ptr->Ind))
 			{
 				/* Mark as easily visible */
-				p_ptr->play_los[q_ptr->Ind] = TRUE;
+				bit_on(p_ptr->play_los, q_ptr->Ind);
 
 				/* Disturb on appearance */
 				if (option_p(p_ptr,DISTURB_NEAR) && check_hostile(p_ptr, q_ptr))
@@ -1748,10 +1670,10 @@ void update_player(player_type *q_ptr)
 		else
 		{
 			/* Change */
-			if (p_ptr->play_los[q_ptr->Ind])
+			if (bit_has(p_ptr->play_los, q_ptr->Ind))
 			{
 				/* Mark as not easily visible */
-				p_ptr->play_los[q_ptr->Ind] = FALSE;
+				bit_off(p_ptr->play_los, q_ptr->Ind);
 
 				/* Disturb on disappearance */
 				if (option_p(p_ptr,DISTURB_NEAR) && check_hostile(p_ptr, q_ptr))
@@ -1900,6 +1822,9 @@ static bool place_monster_one(int Depth, int y, int x, int r_idx, bool slp)
 	m_ptr->fx = x;
 	m_ptr->dun_depth = Depth;
 
+	/* Join the level list */
+	link_monster(c_ptr->m_idx);
+
 
 	/* Hack -- Count the monsters on the level */
 	r_ptr->cur_num++;
@@ -1961,10 +1886,10 @@ static bool place_monster_one(int Depth, int y, int x, int r_idx, bool slp)
 
 	for (Ind = 1; Ind <= NumPlayers; Ind++)
 	{
-		Players[Ind]->mon_los[c_ptr->m_idx] = FALSE;
-		Players[Ind]->mon_vis[c_ptr->m_idx] = FALSE;
+		bit_off(Players[Ind]->mon_los, c_ptr->m_idx);
+		bit_off(Players[Ind]->mon_vis, c_ptr->m_idx);
 		Players[Ind]->mon_det[c_ptr->m_idx] = 0;
-		Players[Ind]->mon_hrt[c_ptr->m_idx] = FALSE;		
+		bit_off(Players[Ind]->mon_hrt, c_ptr->m_idx);		
 	}
 
 	/* Update the monster */
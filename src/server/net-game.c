@@ -339,7 +339,7 @@ int send_indication(player_type *p_ptr, int id, ...)
 
 	start_pos = ct->wbuf.len; /* begin cq "transaction" */
 
-	if (!cq_printf(&ct->wbuf, "%c", i_ptr->pkt))
+	if (!cq_pack_c(&ct->wbuf, i_ptr->pkt))
 	{
 		ct->wbuf.len = start_pos; /* rollback */
 		client_withdraw(ct);
@@ -352,22 +352,22 @@ int send_indication(player_type *p_ptr, int id, ...)
 		if (i_ptr->type == INDITYPE_TINY)
 		{
 			tiny_c = (signed char) va_arg (marker, unsigned int);
-			n = cq_printf(&ct->wbuf, "%c", tiny_c);
+			n = cq_pack_c(&ct->wbuf, tiny_c);
 		}
 		else if (i_ptr->type == INDITYPE_NORMAL)
 		{
 			normal_c = (s16b) va_arg (marker, unsigned int);
-			n = cq_printf(&ct->wbuf, "%d", normal_c);
+			n = cq_pack_d(&ct->wbuf, normal_c);
 		}
 		else if (i_ptr->type == INDITYPE_LARGE)
 		{
 			large_c = (s32b) va_arg (marker, s32b);
-			n = cq_printf(&ct->wbuf, "%l", large_c);
+			n = cq_pack_l(&ct->wbuf, large_c);
 		}
 		else if (i_ptr->type == INDITYPE_STRING)
 		{
 			text_c = (char*) va_arg (marker, char*);
-			n = cq_printf(&ct->wbuf, "%s", text_c);
+			n = cq_pack_s(&ct->wbuf, text_c, MAX_CHARS);
 		}
 		/* Result */
 		if (!n)
@@ -383,13 +383,28 @@ int send_indication(player_type *p_ptr, int id, ...)
 	return 0;
 }
 
-int send_stream_info(connection_type *ct, int id)
+/*
+ * Dungeon view streams can send their lines as deltas against what the
+ * client already has (see "cq_printc_delta()").  Clients 1.5.4 and newer
+ * are told so in the stream info; older ones never see the RLE_DELTA flag.
+ */
+static bool stream_delta(player_type *p_ptr, int st)
+{
+	if (streams[st].addr != NTERM_WIN_OVERHEAD) return FALSE;
+	if (streams[st].flag & SF_OVERLAYED) return FALSE;
+	return client_version_atleast(p_ptr->version, 1,5,4);
+}
+
+int send_stream_info(connection_type *ct, player_type *p_ptr, int id)
 {
 	const stream_type *s_ptr = &streams[id];
+	byte rle = s_ptr->rle;
 	if (!s_ptr->pkt) return 1; /* Last one */
 
+	if (stream_delta(p_ptr, id)) rle |= RLE_DELTA;
+
 	if (cq_printf(&ct->wbuf, "%c" "%c%c%c%c" "%s%s" "%ud%c%ud%c", PKT_STREAM,
-		s_ptr->pkt, s_ptr->addr, s_ptr->rle, s_ptr->flag,
+		s_ptr->pkt, s_ptr->addr, rle, s_ptr->flag,
 		s_ptr->mark, s_ptr->window_desc,
 		s_ptr->min_row, s_ptr->min_col, s_ptr->max_row, s_ptr->max_col) <= 0)
 	{
@@ -401,6 +416,19 @@ int send_stream_info(connection_type *ct, int id)
 	return 1;
 }
 
+/*
+ * Tell the client everything after this packet is deflated, and start
+ * doing so.  Only clients 1.5.4 and newer know this packet.
+ */
+int send_compress(connection_type *ct, int level)
+{
+	if (!cq_printf(&ct->wbuf, "%c%c", PKT_COMPRESS, level) || !conn_deflate_start(ct, level))
+	{
+		client_withdraw(ct);
+	}
+	return 1;
+}
+
 int send_stream_size(connection_type *ct, int st, int y, int x)
 {
 	if (!ct) return -1;
@@ -434,13 +462,18 @@ int stream_char_raw(player_type *p_ptr, int st, int y, int x, byte a, char c, by
 	/* Header + Body (with or without transperancy) */
 	l = ((y << 8) & 0x7F00) | (x & 0x00FF) | 0x8000;
 	if (stream->flag & SF_TRANSPARENT)
-		n = cq_printf(&ct->wbuf, "%c%d%c%c%c%c", stream->pkt, l, a, c, a, c);
+		n = cq_pack_c_ud_c_c_c_c(&ct->wbuf, stream->pkt, l, a, c, a, c);
 	else
-		n = cq_printf(&ct->wbuf, "%c%d%c%c", stream->pkt, l, a, c);
+		n = cq_pack_c_ud_c_c(&ct->wbuf, stream->pkt, l, a, c);
 	if (n <= 0)
 	{
 		client_withdraw(ct);
 	}
+	else if (stream_delta(p_ptr, st))
+	{
+		p_ptr->sent_info[y][x].a = a;
+		p_ptr->sent_info[y][x].c = c;
+	}
 
 	/* Ok */
 	return 1;
@@ -467,18 +500,174 @@ int stream_char(player_type *p_ptr, int st, int y, int x)
 	/* Header + Body (with or without transperancy) */
 	l = ((y << 8) & 0x7F00) | (x & 0x00FF) | 0x8000;
 	if (stream->flag & SF_TRANSPARENT)
-		n = cq_printf(&ct->wbuf, "%c%ud%c%c%c%c", stream->pkt, l, source[x].a, source[x].c, p_ptr->trn_info[y][x].a, p_ptr->trn_info[y][x].c);
+		n = cq_pack_c_ud_c_c_c_c(&ct->wbuf, stream->pkt, l, source[x].a, source[x].c, p_ptr->trn_info[y][x].a, p_ptr->trn_info[y][x].c);
 	else
-		n = cq_printf(&ct->wbuf, "%c%ud%c%c", stream->pkt, l, source[x].a, source[x].c);
+		n = cq_pack_c_ud_c_c(&ct->wbuf, stream->pkt, l, source[x].a, source[x].c);
 	if (n <= 0)
 	{
 		client_withdraw(ct);
 	}
+	else if (stream_delta(p_ptr, st))
+	{
+		p_ptr->sent_info[y][x] = source[x];
+	}
+
+	/* Ok */
+	return 1;
+}
+
+/*
+ * Send a run of "n" grids of one row, starting at "x".
+ *
+ * The header has bit 0x4000 set (and bit 0x8000 clear) to tell it from
+ * a whole line; the grids follow in the stream's RLE mode, just like a
+ * line would.  Only clients 1.5.4 and newer understand it.
+ */
+int stream_span(player_type *p_ptr, int st, int y, int x, int n)
+{
+	connection_type *ct;
+	const stream_type *stream = &streams[st];
+	cave_view_type *source = p_ptr->stream_cave[st] + y * MAX_WID;
+	int start_pos;
+
+	/* Programmer error */
+	if (y >= 0x4000 || x > 255 || n > 255) { printf("stream_span is limited to y < 16384, x <= 255, n <= 255, you are using y %d, x %d, n %d\n", y, x, n); return -1; }
+
+	/* Paranoia -- do not send to closed connection */
+	if (p_ptr->conn == -1) return -1;
+	ct = Conn[p_ptr->conn];
+
+	/* Do not send streams not subscribed to */
+	if (!p_ptr->stream_hgt[st]) return 1;
+
+	/* Begin cq "transaction" */
+	start_pos = ct->wbuf.len;
+
+	/* Packet header */
+	if (cq_pack_c_ud_c_c(&ct->wbuf, stream->pkt, (u16b)(y | 0x4000), (byte)x, (byte)n) <= 0)
+	{
+		ct->wbuf.len = start_pos; /* rewind */
+		client_withdraw(ct);
+	}
+	/* (Secondary) */
+	if ((stream->flag & SF_TRANSPARENT) && cq_printc(&ct->wbuf, stream->rle, &p_ptr->trn_info[y][x], n) <= 0)
+	{
+		ct->wbuf.len = start_pos; /* rewind */
+		client_withdraw(ct);
+	}
+	/* Packet body */
+	if (cq_printc(&ct->wbuf, stream->rle, &source[x], n) <= 0)
+	{
+		ct->wbuf.len = start_pos; /* rewind */
+		client_withdraw(ct);
+	}
+	else if (stream_delta(p_ptr, st))
+	{
+		C_COPY(&p_ptr->sent_info[y][x], &source[x], n, cave_view_type);
+	}
 
 	/* Ok */
 	return 1;
 }
 
+/*
+ * Send the dungeon grids "lite_spot()" has changed since the last time.
+ *
+ * Each row goes out in whichever form is smallest: one packet per grid,
+ * a few spans (nearby grids are merged, resending the unchanged ones in
+ * between), or the whole line.  A breath or a swarm of monsters changing
+ * many grids thus costs a handful of packets instead of hundreds.
+ */
+#define SPAN_HEAD	5	/* Bytes of a span packet before its grids */
+#define CHAR_HEAD	3	/* Bytes of a single grid packet before its grid */
+#define LINE_HEAD	3	/* Bytes of a line packet before its grids */
+void stream_flush_tiles(player_type *p_ptr)
+{
+	connection_type *ct;
+	int st = DUNGEON_STREAM_p(p_ptr);
+	int cols = p_ptr->stream_wid[st];
+	int tile = (streams[st].flag & SF_TRANSPARENT) ? 4 : 2;
+	bool spans = client_version_atleast(p_ptr->version, 1,5,4);
+	s16b span_x[MAX_WID], span_n[MAX_WID];
+	int num, cost, w, y, x, i;
+	u32b before;
+
+	/* Nothing to do */
+	for (w = 0; w < BIT_WORDS(MAX_HGT); w++) if (p_ptr->scr_dirty_row[w]) break;
+	if (w == BIT_WORDS(MAX_HGT)) return;
+
+	/* Paranoia -- do not send to closed connection */
+	if (p_ptr->conn == -1 || !cols) goto done;
+	ct = Conn[p_ptr->conn];
+	before = cq_len(&ct->wbuf);
+
+	for (y = 0; y < MAX_HGT; y++)
+	{
+		if (!bit_has(p_ptr->scr_dirty_row, y)) continue;
+
+		/* Collect the changed grids into runs */
+		num = 0;
+		for (x = 0; x < cols; x++)
+		{
+			if (!bit_has(p_ptr->scr_dirty[y], x)) continue;
+
+			/* Close enough to the last run to extend it */
+			if (num && spans && (x - (span_x[num - 1] + span_n[num - 1])) * tile <= SPAN_HEAD)
+			{
+				span_n[num - 1] = x - span_x[num - 1] + 1;
+				continue;
+			}
+
+			span_x[num] = x;
+			span_n[num] = 1;
+			num++;
+		}
+
+		/* Price them */
+		cost = 0;
+		for (i = 0; i < num; i++)
+		{
+			cost += (span_n[i] > 1 ? SPAN_HEAD : CHAR_HEAD) + span_n[i] * tile;
+		}
+
+		/* The whole line is cheaper */
+		if (cost >= LINE_HEAD + cols * tile)
+		{
+			Stream_line_p(p_ptr, st, y);
+			p_ptr->map_packets++;
+			continue;
+		}
+
+		for (i = 0; i < num; i++)
+		{
+			if (span_n[i] > 1) stream_span(p_ptr, st, y, span_x[i], span_n[i]);
+			else stream_char(p_ptr, st, y, span_x[i]);
+			p_ptr->map_packets++;
+		}
+	}
+
+	p_ptr->map_bytes += cq_len(&ct->wbuf) - before;
+
+done:
+	/* Everything is sent */
+	C_WIPE(p_ptr->scr_dirty, MAX_HGT * BIT_WORDS(MAX_WID), u32b);
+	C_WIPE(p_ptr->scr_dirty_row, BIT_WORDS(MAX_HGT), u32b);
+}
+
+/* See if player's connection already has a backlog of unsent output.
+ * Large stream dumps should be postponed until it clears. */
+bool stream_congested(player_type *p_ptr)
+{
+	connection_type *ct;
+
+	/* Paranoia -- closed connection never drains */
+	if (p_ptr->conn == -1) return FALSE;
+	ct = Conn[p_ptr->conn];
+
+	/* (On compressed connections, the backlog is in the deflated queue) */
+	return (cq_len(&ct->wbuf) + cq_len(&ct->zwbuf) > PD_HIGH_WATER ? TRUE : FALSE);
+}
+
 int stream_line_as(player_type *p_ptr, int st, int y, int as_y)
 {
 	connection_type *ct;
@@ -489,6 +678,8 @@ int stream_line_as(player_type *p_ptr, int st, int y, int as_y)
 	s16b	cols = p_ptr->stream_wid[st];
 	byte	rle = stream->rle;
 	byte	trn = (stream->flag & SF_TRANSPARENT);
+	bool	delta = stream_delta(p_ptr, st);
+	int 	n;
 	source 	= p_ptr->stream_cave[st] + y * MAX_WID;
 
 	/* Programmer error */
@@ -508,7 +699,7 @@ int stream_line_as(player_type *p_ptr, int st, int y, int as_y)
 	start_pos = ct->wbuf.len;
 
 	/* Packet header */
-	if (cq_printf(&ct->wbuf, "%c%ud", stream->pkt, as_y) <= 0)
+	if (cq_pack_c_ud(&ct->wbuf, stream->pkt, as_y) <= 0)
 	{
 		ct->wbuf.len = start_pos; /* rewind */
 		client_withdraw(ct);
@@ -520,11 +711,19 @@ int stream_line_as(player_type *p_ptr, int st, int y, int as_y)
 		client_withdraw(ct);
 	}
 	/* Packet body */
-	if (cq_printc(&ct->wbuf, rle, source, cols) <= 0)
+	if (delta)
+		n = cq_printc_delta(&ct->wbuf, rle, source, p_ptr->sent_info[as_y], (as_y ? p_ptr->sent_info[as_y - 1] : NULL), cols);
+	else
+		n = cq_printc(&ct->wbuf, rle, source, cols);
+	if (n <= 0)
 	{
 		ct->wbuf.len = start_pos; /* rewind */
 		client_withdraw(ct);
 	}
+	else if (delta)
+	{
+		C_COPY(p_ptr->sent_info[as_y], source, cols, cave_view_type);
+	}
 
 	/* Ok */
 	return 1;
@@ -601,7 +800,7 @@ int send_cursor(player_type *p_ptr, byte vis, byte x, byte y)
 	if (p_ptr->conn == -1) return -1;
 	ct = Conn[p_ptr->conn];
 
-	if (!cq_printf(&ct->wbuf, "%c" "%c%c%c", PKT_CURSOR, vis, x, y))
+	if (!cq_pack_c_c_c_c(&ct->wbuf, PKT_CURSOR, vis, x, y))
 	{
 		client_withdraw(ct);
 	}
@@ -855,7 +1054,7 @@ int send_message(player_type *p_ptr, cptr msg, u16b typ)
 	/* Clip end of msg if too long */
 	my_strcpy(buf, msg, MSG_LEN);
 
-	if (!cq_printf(&ct->wbuf, "%c%ud%S", PKT_MESSAGE, typ, buf))
+	if (!cq_pack_c_ud_S(&ct->wbuf, PKT_MESSAGE, typ, buf))
 	{
 		client_withdraw(ct);
 	}
@@ -869,7 +1068,7 @@ int send_message_repeat(player_type *p_ptr, u16b typ)
 	if (p_ptr->conn == -1) return -1;
 	ct = Conn[p_ptr->conn];
 
-	if (!cq_printf(&ct->wbuf, "%c%ud", PKT_MESSAGE_REPEAT, typ))
+	if (!cq_pack_c_ud(&ct->wbuf, PKT_MESSAGE_REPEAT, typ))
 	{
 		client_withdraw(ct);
 	}
@@ -881,7 +1080,7 @@ int send_sound(player_type *p_ptr, u16b sound)
 	connection_type *ct;
 	if (p_ptr->conn == -1) return -1;
 	ct = Conn[p_ptr->conn];
-	if (!cq_printf(&ct->wbuf, "%c%ud", PKT_SOUND, sound))
+	if (!cq_pack_c_ud(&ct->wbuf, PKT_SOUND, sound))
 	{
 		client_withdraw(ct);
 	}
@@ -1190,7 +1389,7 @@ int recv_basic_request(connection_type *ct, player_type *p_ptr) {
 			while (id < MAX_INDICATORS) if (!send_indicator_info(ct, id++)) break;
 		break;
 		case BASIC_INFO_STREAMS:
-			while (id < MAX_STREAMS) if (!send_stream_info(ct, id++)) break;
+			while (id < MAX_STREAMS) if (!send_stream_info(ct, p_ptr, id++)) break;
 		break;
 		case BASIC_INFO_COMMANDS:
 			while (id < MAX_CUSTOM_COMMANDS) if (!send_custom_command_info(ct, id++)) break;
@@ -1463,7 +1662,9 @@ int recv_stream_size(connection_type *ct, player_type *p_ptr) {
 		}
 	}
 
-	/* Ack it */
+	/* Ack it (the client starts over with an empty view) */
+	if (stg < MAX_STREAMS && stream_delta(p_ptr, stg))
+		C_WIPE(p_ptr->sent_info, MAX_HGT * MAX_WID, cave_view_type);
 	send_stream_size(ct, stg, y, x);
 
 	return 1;
@@ -126,16 +126,16 @@ void reindex_player(int oldPInd, int newPInd)
 		}
 
 		/* Visibility flags */
-		p_ptr->play_vis[newPInd] = p_ptr->play_vis[oldPInd];
-		p_ptr->play_los[newPInd] = p_ptr->play_los[oldPInd];
+		bit_put(p_ptr->play_vis, newPInd, bit_has(p_ptr->play_vis, oldPInd));
+		bit_put(p_ptr->play_los, newPInd, bit_has(p_ptr->play_los, oldPInd));
 		p_ptr->play_det[newPInd] = p_ptr->play_det[oldPInd];
 
 		/* Vanishing player was visible, update list */
-		if (newPInd == 0 && p_ptr->play_vis[oldPInd]) p_ptr->window |= (PW_MONLIST);
+		if (newPInd == 0 && bit_has(p_ptr->play_vis, oldPInd)) p_ptr->window |= (PW_MONLIST);
 
 		/* And forget about old index */
-		p_ptr->play_vis[oldPInd] = FALSE;
-		p_ptr->play_los[oldPInd] = FALSE;
+		bit_off(p_ptr->play_vis, oldPInd);
+		bit_off(p_ptr->play_los, oldPInd);
 		p_ptr->play_det[oldPInd] = 0;
 	}
 }
@@ -184,6 +184,7 @@ int player_enter(int ind)
 
 	/* Setup his locaton */
 	player_setup(p_ptr);
+	player_roster_add(p_ptr);
 	setup_panel(p_ptr, TRUE);
 	verify_panel(p_ptr);
 
@@ -290,6 +291,9 @@ int player_leave(int p_idx)
 		update_player(p_ptr);
 	}
 
+	/* He is no longer on his level */
+	player_roster_remove(p_ptr);
+
 	/* Try to save his character */
 	saved = save_player(p_ptr);
 
@@ -491,6 +495,7 @@ void post_process_players(void)
 /* Infinite Loop */
 void network_loop()
 {
+	micro timeout;
 	shutdown_timer = 0;
 	plog(format("Server is running version %04x", SERVER_VERSION));
 #ifdef DEBUG
@@ -505,7 +510,13 @@ void network_loop()
 
 		post_process_players(); /* Execute all commands */
 
-		network_pause(2000); /* 0.002 ms "sleep" */
+		/* Sleep until some socket is ready or the next timer is due,
+		 * unless there's output waiting to be flushed */
+		timeout = timers_delay(first_timer, ONE_SECOND);
+		timeout = senders_delay(first_sender, timeout);
+		if (connections_pending(first_connection)) timeout = 0;
+
+		network_pause(timeout);
 	}
 }
 
@@ -526,6 +537,12 @@ void close_network_server()
 	free_server_memory();
 }
 
+/* Let go of the network in a forked child, leaving it to the parent */
+void forget_network_server()
+{
+	network_forget(first_listener, first_connection, first_sender);
+}
+
 /* Send one last packet to meta.
  * The round-about way of doing this has to do with the way "UDP Senders" are
  * handled. We can't call any netcode DIRECTLY, but we can trick it to flush. */
@@ -693,10 +710,16 @@ int second_tick(int data1, data data2) {
 }
 
 int dungeon_tick(int data1, data data2) {
+	int i;
+
 	/* plog("The Clock Ticked"); */ ticks++;
 
 	/* Game Turn */
+	static_timer(2);
 	dungeon();
+	perf_turn_usec += static_timer(2);
+	perf_turns++;
+	for (i = 1; i <= NumPlayers; i++) Players[i]->map_turns++;
 	return 2;
 }
 					/* data1 is (int)fd */
@@ -981,6 +1004,9 @@ int client_login(int data1, data data2) { /* return -1 on error */
 	/* Advance to next stage */
 	ct->receive_cb = client_read;
 
+	/* Compress everything from here on, if client can take it */
+	if (cfg_compress_level && client_version_atleast(version, 1,5,4)) send_compress(ct, cfg_compress_level);
+
 	/* Since LOGIN is the first command ever, it's a good time to send basics */
 	if (client_version_atleast(p_ptr->version, 1,5,3)) send_stats_info(ct);
 	send_race_info(ct);
@@ -57,6 +57,7 @@ extern int send_optgroups_info(connection_type *ct);
 extern int send_options_info(connection_type *ct, player_type *p_ptr, int id);
 extern int send_indicator_info(connection_type *ct, int id);
 extern int send_custom_command_info(connection_type *ct, int id);
+extern int send_compress(connection_type *ct, int level);
 /* Receive */
 //Not really needed .. //
 //extern int recv_undef(connection_type *ct, player_type *p_ptr);
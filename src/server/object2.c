@@ -30,6 +30,42 @@ void delete_object_ptr(object_type * o_ptr)
 
 }
 
+/*
+ * Add an object to the list of objects on its level.
+ *
+ * Every "live" object (on the floor or carried by a monster) is kept
+ * on exactly one of these lists, see "link_monster()".
+ */
+void link_object(int o_idx)
+{
+	object_type *o_ptr = &o_list[o_idx];
+	int next = o_on_depth[o_ptr->dun_depth];
+
+	/* Place at the head of the level list */
+	o_ptr->prev_lvl_idx = 0;
+	o_ptr->next_lvl_idx = next;
+	if (next) o_list[next].prev_lvl_idx = o_idx;
+	o_on_depth[o_ptr->dun_depth] = o_idx;
+}
+
+/*
+ * Remove an object from the list of objects on its level.
+ */
+void unlink_object(int o_idx)
+{
+	object_type *o_ptr = &o_list[o_idx];
+
+	if (o_ptr->prev_lvl_idx)
+		o_list[o_ptr->prev_lvl_idx].next_lvl_idx = o_ptr->next_lvl_idx;
+	else if (o_on_depth[o_ptr->dun_depth] == o_idx)
+		o_on_depth[o_ptr->dun_depth] = o_ptr->next_lvl_idx;
+
+	if (o_ptr->next_lvl_idx)
+		o_list[o_ptr->next_lvl_idx].prev_lvl_idx = o_ptr->prev_lvl_idx;
+
+	o_ptr->prev_lvl_idx = o_ptr->next_lvl_idx = 0;
+}
+
 /* 
  * Excise a dungeon object from any stacks 
  */ 
@@ -110,8 +146,8 @@ static void excise_object_idx(int o_idx)
 		/* No one can see it anymore */
 		for (i = 1; i <= NumPlayers; i++)
 		{
-			if (Players[i]->obj_vis[o_idx]) Players[i]->window |= (PW_ITEMLIST);
-			Players[i]->obj_vis[o_idx] = FALSE;
+			if (bit_has(Players[i]->obj_vis, o_idx)) Players[i]->window |= (PW_ITEMLIST);
+			bit_off(Players[i]->obj_vis, o_idx);
 		}
 	}
 }
@@ -200,8 +236,14 @@ void delete_object_idx(int o_idx)
 		everyone_lite_spot(Depth, y, x);
 	}
 
+	/* Leave the level list */
+	unlink_object(o_idx);
+
 	/* Wipe the object */
 	object_wipe(j_ptr);
+
+	/* Free the index */
+	o_release(o_idx);
 }
 
 
@@ -231,84 +273,7 @@ void delete_object(int Depth, int y, int x)
 
 
 /* 
- * Move an object from index i1 to index i2 in the object list 
- */ 
-static void compact_objects_aux(int i1, int i2) 
-{ 
-	int i, Ind;
-	object_type *o_ptr;
-
-	/* Do nothing */
-	if (i1 == i2) return;
-
-	/* Repair objects */
-	for (i = 1; i < o_max; i++)
-	{
-		/* Get the object */
-		o_ptr = &o_list[i];
-
-		/* Skip "dead" objects */
-		if (!o_ptr->k_idx) continue;
-
-		/* Repair "next" pointers */
-		if (o_ptr->next_o_idx == i1)
-		{
-			/* Repair */
-			o_ptr->next_o_idx = i2;
-		}
-	}
-
-	/* Get the object */
-	o_ptr = &o_list[i1];
- 
-	/* Monster */
-	if (o_ptr->held_m_idx)
-	{
-		monster_type *m_ptr;
-
-		/* Get the monster */
-		m_ptr = &m_list[o_ptr->held_m_idx];
-
-		/* Repair monster */
-		if (m_ptr->hold_o_idx == i1)
-		{
-			/* Repair */
-			m_ptr->hold_o_idx = i2;
-		}
-	}
-
-	/* Dungeon */
-	else
-	{
-		int y, x, Depth;
-
-		/* Get location */
-		y = o_ptr->iy;
-		x = o_ptr->ix;
-		Depth = o_ptr->dun_depth;
-
-		/* Repair grid */
-		if (cave[Depth] && (cave[Depth][y][x].o_idx == i1))
-		{
-			/* Repair */
-			cave[Depth][y][x].o_idx = i2;
-		}
-	}
-
-	/* Copy the visibility flags for each player */
-	for (Ind = 1; Ind <= NumPlayers; Ind++)
-		Players[Ind]->obj_vis[i2] = Players[Ind]->obj_vis[i1];
-
-	/* Hack -- move object */
-	COPY(&o_list[i2], &o_list[i1], object_type);
-
-	/* Hack -- wipe hole */
-	object_wipe(o_ptr);
-} 
-
-
-/* 
- * Compact and reorder the object list 
+ * Compact the object list 
  * 
  * This function can be very dangerous, use with caution! 
  * 
@@ -318,47 +283,16 @@ static void compact_objects_aux(int i1, int i2)
  * When compacting other objects, we base the saving throw on a combination of 
  * object level, distance from player, and current "desperation". 
  * 
- * After compacting, we "reorder" the objects into a more compact order, and we 
- * reset the allocation info, and the "live" array. 
+ * Objects are never moved around, the indexes of the deleted ones 
+ * simply go back to "o_pop()". 
  */ 
 void compact_objects(int size) 
 { 
 	int i, y, x, cnt;
 	int cur_lev, cur_val, chance;
 
-	/* Reorder objects when not passed a size */
-	if (!size)
-	{
-		/* Excise dead objects (backwards!) */
-		for (i = o_max - 1; i >= 1; i--)
-		{
-			object_type *o_ptr = &o_list[i];
-
-			/* Skip real objects */
-			if (o_ptr->k_idx) continue;
-
-			/* Move last object into open hole */
-			compact_objects_aux(o_max - 1, i);
-
-			/* Compress "o_max" */
-			o_max--;
-		}
-
-		/* Reset "o_nxt" */
-		o_nxt = o_max;
-
-		/* Reset "o_top" */
-		o_top = 0;
-
-		/* Collect "live" objects */
-		for (i = 1; i < o_max; i++)
-		{
-			/* Collect indexes */
-			o_fast[o_top++] = i;
-		}
-
-		return;
-	}
+	/* Nothing to do */
+	if (!size) return;
 
 	/* Message */
 	plog("Compacting objects...");
@@ -447,9 +381,6 @@ void compact_objects(int size)
 			size--; 
 		}
 	} 
-
-	/* Reorder objects */ 
-	compact_objects(0); 
 }
 
 
@@ -465,18 +396,11 @@ void wipe_o_list(int Depth)
 {
 	int i;//, house_depth;
 
-	/* Delete the existing objects */
-	for (i = 1; i < o_max; i++)
+	/* Delete the existing objects on this level */
+	while ((i = o_on_depth[Depth]))
 	{
 		object_type *o_ptr = &o_list[i];
 
-		/* Skip dead objects */
-		if (!o_ptr->k_idx) continue;
-
-		/* Skip objects not on this depth */
-		if (o_ptr->dun_depth != Depth)
-			continue;
-
 		/* Mega-Hack -- preserve artifacts */
 		/* Hack -- Preserve unknown artifacts */
 		/* We now preserve ALL artifacts, known or not */
@@ -512,12 +436,15 @@ void wipe_o_list(int Depth)
 			m_ptr->hold_o_idx = 0;			
 		}
 
+		/* Leave the level list */
+		unlink_object(i);
+
 		/* Wipe the object */
 		WIPE(o_ptr, object_type);
-	}
 
-	/* Compact the object list */
-	compact_objects(0);
+		/* Free the index */
+		o_release(i);
+	}
 }
 
 
@@ -527,13 +454,28 @@ void wipe_o_list(int Depth)
  * This routine should almost never fail, but in case it does,
  * we must be sure to handle "failure" of this routine.
  *
- * Note that this function must maintain the special "o_fast"
- * array of pointers to "live" objects.
+ * Indexes of deleted objects are kept on the "o_free" stack, see
+ * "m_pop()".
  */
 s16b o_pop(void)
 {
-	int i, n, k;
+	int i;
 
+	/* Reuse a free index */
+	while (o_free_num)
+	{
+		i = o_free[--o_free_num];
+		bit_off(o_freed, i);
+
+		/* Paranoia -- skip objects in use */
+		if (o_list[i].k_idx) continue;
+
+		/* Count it */
+		o_top++;
+
+		/* Use this object */
+		return (i);
+	}
 
 	/* Initial allocation */
 	if (o_max < MAX_O_IDX)
@@ -544,45 +486,19 @@ s16b o_pop(void)
 		/* Expand object array */
 		o_max++;
 
-		/* Update "o_fast" */
-		o_fast[o_top++] = i;
+		/* Count it */
+		o_top++;
 
 		/* Use this object */
 		return (i);
 	}
 
-
-	/* Check for some space */
-	for (n = 1; n < MAX_O_IDX; n++)
+	/* Hack -- recover any dead object not handed back */
+	for (i = o_max - 1; i >= 1; i--)
 	{
-		/* Get next space */
-		i = o_nxt;
-
-		/* Advance (and wrap) the "next" pointer */
-		if (++o_nxt >= MAX_O_IDX) o_nxt = 1;
-
-		/* Skip objects in use */
-		if (o_list[i].k_idx) continue;
-
-		/* Verify space XXX XXX */
-		if (o_top >= MAX_O_IDX) continue;
-
-		/* Verify not allocated */
-		for (k = 0; k < o_top; k++)
-		{
-			/* Hack -- Prevent errors */
-			if (o_fast[k] == i) i = 0;
-		}
-
-		/* Oops XXX XXX */
-		if (!i) continue;
-
-		/* Update "o_fast" */
-		o_fast[o_top++] = i;
-
-		/* Use this object */
-		return (i);
+		if (!o_list[i].k_idx) o_release(i);
 	}
+	if (o_free_num) return (o_pop());
 
 
 	/* Warn the player */
@@ -593,6 +509,33 @@ s16b o_pop(void)
 }
 
 
+/*
+ * Hand the index of a dead object back to "o_pop()"
+ */
+void o_release(int o_idx)
+{
+	/* Already free */
+	if (bit_has(o_freed, o_idx)) return;
+
+	/* Push it */
+	bit_on(o_freed, o_idx);
+	o_free[o_free_num++] = o_idx;
+
+	/* Uncount it */
+	o_top--;
+}
+
+
+
+/*
+ * The running totals of the "object allocation table" are out of date
+ */
+static bool alloc_kind_dirty = TRUE;
+
+/*
+ * The running totals of the "object allocation table" skip chests
+ */
+static bool alloc_kind_chest = FALSE;
 
 /*
  * Apply a "object restriction function" to the "object allocation table"
@@ -622,19 +565,46 @@ errr get_obj_num_prep(void)
 		}
 	}
 
+	/* Recount on next use */
+	alloc_kind_dirty = TRUE;
+
 	/* Success */
 	return (0);
 }
 
 
+/*
+ * Recompute the running totals of the "object allocation table"
+ */
+static void get_obj_num_total(void)
+{
+	int i;
+	u32b total = 0L;
+
+	alloc_entry *table = alloc_kind_table;
+
+	for (i = 0; i < alloc_kind_size; i++)
+	{
+		/* Hack -- prevent embedded chests */
+		if (!opening_chest || (k_info[table[i].index].tval != TV_CHEST))
+		{
+			total += table[i].prob2;
+		}
+
+		table[i].total = total;
+	}
+
+	alloc_kind_dirty = FALSE;
+	alloc_kind_chest = opening_chest;
+}
+
 
 /*
  * Choose an object kind that seems "appropriate" to the given level
  *
- * This function uses the "prob2" field of the "object allocation table",
- * and various local information, to calculate the "prob3" field of the
- * same table, which is then used to choose an "appropriate" object, in
- * a relatively efficient manner.
+ * This function uses the running totals of the "prob2" field of the
+ * "object allocation table" to choose an "appropriate" object with a
+ * binary search over the entries no deeper than the given level.
  *
  * It is (slightly) more likely to acquire an object of the given level
  * than one of a lower level.  This is done by choosing several objects
@@ -645,13 +615,9 @@ errr get_obj_num_prep(void)
  */
 s16b get_obj_num(int level)
 {
-	int			i, j, p;
-
-	int			k_idx;
-
-	long		value, total;
+	int			i, j, p, n;
 
-	object_kind		*k_ptr;
+	u32b		total;
 
 	alloc_entry		*table = alloc_kind_table;
 
@@ -668,50 +634,24 @@ s16b get_obj_num(int level)
 	}
 
 
-	/* Reset total */
-	total = 0L;
-
-	/* Process probabilities */
-	for (i = 0; i < alloc_kind_size; i++)
+	/* Bring the running totals up to date */
+	if (alloc_kind_dirty || (alloc_kind_chest != opening_chest))
 	{
-		/* Objects are sorted by depth */
-		if (table[i].level > level) break;
-
-		/* Default */
-		table[i].prob3 = 0;
-
-		/* Access the index */
-		k_idx = table[i].index;
-
-		/* Access the actual kind */
-		k_ptr = &k_info[k_idx];
-
-		/* Hack -- prevent embedded chests */
-		if (opening_chest && (k_ptr->tval == TV_CHEST)) continue;
+		get_obj_num_total();
+	}
 
-		/* Accept */
-		table[i].prob3 = table[i].prob2;
+	/* Objects are sorted by depth */
+	n = alloc_level_end(table, alloc_kind_size, level);
 
-		/* Total */
-		total += table[i].prob3;
-	}
+	/* Total the legal objects */
+	total = (n > 0) ? table[n - 1].total : 0L;
 
 	/* No legal objects */
 	if (total <= 0) return (0);
 
 
 	/* Pick an object */
-	value = randint0(total);
-
-	/* Find the object */
-	for (i = 0; i < alloc_kind_size; i++)
-	{
-		/* Found the entry */
-		if (value < table[i].prob3) break;
-
-		/* Decrement */
-		value = value - table[i].prob3;
-	}
+	i = alloc_pick(table, 0, n, randint0(total));
 
 
 	/* Power boost */
@@ -724,17 +664,7 @@ s16b get_obj_num(int level)
 		j = i;
 
 		/* Pick a object */
-		value = randint0(total);
-
-		/* Find the monster */
-		for (i = 0; i < alloc_kind_size; i++)
-		{
-			/* Found the entry */
-			if (value < table[i].prob3) break;
-
-			/* Decrement */
-			value = value - table[i].prob3;
-		}
+		i = alloc_pick(table, 0, n, randint0(total));
 
 		/* Keep the "best" one */
 		if (table[i].level < table[j].level) i = j;
@@ -747,17 +677,7 @@ s16b get_obj_num(int level)
 		j = i;
 
 		/* Pick a object */
-		value = randint0(total);
-
-		/* Find the object */
-		for (i = 0; i < alloc_kind_size; i++)
-		{
-			/* Found the entry */
-			if (value < table[i].prob3) break;
-
-			/* Decrement */
-			value = value - table[i].prob3;
-		}
+		i = alloc_pick(table, 0, n, randint0(total));
 
 		/* Keep the "best" one */
 		if (table[i].level < table[j].level) i = j;
@@ -3569,6 +3489,7 @@ bool place_specific_object(int Depth, int y1, int x1, object_type *forge, int le
 				o_ptr->iy = y;
 				o_ptr->ix = x;
 				o_ptr->dun_depth = Depth;
+				link_object(o_idx);
 		
 				c_ptr = &cave[Depth][y][x];
 				c_ptr->o_idx = o_idx;
@@ -3577,7 +3498,7 @@ bool place_specific_object(int Depth, int y1, int x1, object_type *forge, int le
 				for (i = 1; i <= NumPlayers; i++)
 				{
 					/* He can't see it */
-					Players[i]->obj_vis[o_idx] = FALSE;
+					bit_off(Players[i]->obj_vis, o_idx);
 				}
 			
 				
@@ -3712,6 +3633,7 @@ object_type* place_object(int Depth, int y, int x, bool good, bool great, byte o
 		o_ptr->iy = y;
 		o_ptr->ix = x;
 		o_ptr->dun_depth = Depth;
+		link_object(o_idx);
 
 		c_ptr = &cave[Depth][y][x];
 		c_ptr->o_idx = o_idx;
@@ -3731,7 +3653,7 @@ object_type* place_object(int Depth, int y, int x, bool good, bool great, byte o
 		for (i = 1; i <= NumPlayers; i++)
 		{
 			/* He can't see it */
-			Players[i]->obj_vis[o_idx] = FALSE;
+			bit_off(Players[i]->obj_vis, o_idx);
 		}
 
 		/* Add origin */
@@ -3903,6 +3825,7 @@ void place_gold(int Depth, int y, int x)
 		o_ptr->iy = y;
 		o_ptr->ix = x;
 		o_ptr->dun_depth = Depth;
+		link_object(o_idx);
 
 		c_ptr = &cave[Depth][y][x];
 		c_ptr->o_idx = o_idx;
@@ -3917,7 +3840,7 @@ void place_gold(int Depth, int y, int x)
 		for (j = 1; j <= NumPlayers; j++)
 		{
 			/* This player can't see it */
-			Players[j]->obj_vis[o_idx] = FALSE;
+			bit_off(Players[j]->obj_vis, o_idx);
 		}
 	}
 
@@ -4091,6 +4014,7 @@ void drop_near(object_type *o_ptr, int chance, int Depth, int y, int x)
 				o_ptr->iy = ny;
 				o_ptr->ix = nx;
 				o_ptr->dun_depth = Depth;
+				link_object(o_idx);
 	
 				/* Place */
 				c_ptr = &cave[Depth][ny][nx];
@@ -4119,7 +4043,7 @@ void drop_near(object_type *o_ptr, int chance, int Depth, int y, int x)
 			for (k = 1; k <= NumPlayers; k++)
 			{
 				/* This player cannot see it */
-				Players[k]->obj_vis[o_idx] = FALSE;
+				bit_off(Players[k]->obj_vis, o_idx);
 			}
 
 			/* Note the spot */
@@ -4430,7 +4354,7 @@ void floor_item_notify(player_type *p_ptr, s16b o_idx, bool force)
 	if (o_idx) for (i = 1; i <= NumPlayers; i++)
 	{
 		if (Players[i]->dun_depth != p_ptr->dun_depth) continue;
-		if (Players[i]->obj_vis[o_idx]) Players[i]->window |= (PW_ITEMLIST);
+		if (bit_has(Players[i]->obj_vis, o_idx)) Players[i]->window |= (PW_ITEMLIST);
 	}
 
 	if (!force && p_ptr->delta_floor_item == o_idx) return;
@@ -4934,12 +4858,15 @@ static void notify_player_standing_on(int o_idx)
 	for (Ind = 1; Ind <= NumPlayers; Ind++)
 	{
 		p_ptr = Players[Ind];
-		if (p_ptr->obj_vis[o_idx]) p_ptr->window |= (PW_ITEMLIST);
+		if (bit_has(p_ptr->obj_vis, o_idx)) p_ptr->window |= (PW_ITEMLIST);
 	}
 }
 
 /*
  * Hack -- process the objects
+ *
+ * Only the objects on levels with players on them are processed,
+ * everything else is frozen until somebody comes back.
  */
 void process_objects(void)
 {
@@ -4953,43 +4880,36 @@ void process_objects(void)
 
 
 	/* Process objects */
-	for (k = o_top - 1; k >= 0; k--)
+	for (k = 0; k < num_active_depths; k++)
 	{
-		/* Access index */
-		i = o_fast[k];
-
-		/* Access object */
-		o_ptr = &o_list[i];
-
-		/* Excise dead objects */
-		if (!o_ptr->k_idx)
+		for (i = o_on_depth[active_depths[k]]; i; i = o_ptr->next_lvl_idx)
 		{
-			/* Excise it */
-			o_fast[k] = o_fast[--o_top];
+			/* Access object */
+			o_ptr = &o_list[i];
 
-			/* Skip */
-			continue;
-		}
+			/* Count */
+			perf_obj_process++;
 
-		/* Recharge rods on the ground */
-		if ((o_ptr->tval == TV_ROD) && (o_ptr->timeout))
-		{
-			/* Charge it (charge ALL rods) */
-			/* Note: this is the behavior in vanilla Angband 3.0.9 */
-			o_ptr->timeout -= o_ptr->number;
-
-			/* Alternate code */
-			/* Only charging rods should recharge (same as charging from the inventory) */
-			/*object_kind* k_ptr = &k_info[o_ptr->k_idx];
-			int temp = (o_ptr->timeout + (k_ptr->pval - 1)) / k_ptr->pval;
-			if (temp > o_ptr->number) temp = o_ptr->number;
-			o_ptr->timeout -= temp;*/
-
-			/* Boundary control */
-			if (o_ptr->timeout < 0) o_ptr->timeout = 0;
-
-			/* Notify player standing on top of that item */
-			notify_player_standing_on(i);
+			/* Recharge rods on the ground */
+			if ((o_ptr->tval == TV_ROD) && (o_ptr->timeout))
+			{
+				/* Charge it (charge ALL rods) */
+				/* Note: this is the behavior in vanilla Angband 3.0.9 */
+				o_ptr->timeout -= o_ptr->number;
+
+				/* Alternate code */
+				/* Only charging rods should recharge (same as charging from the inventory) */
+				/*object_kind* k_ptr = &k_info[o_ptr->k_idx];
+				int temp = (o_ptr->timeout + (k_ptr->pval - 1)) / k_ptr->pval;
+				if (temp > o_ptr->number) temp = o_ptr->number;
+				o_ptr->timeout -= temp;*/
+
+				/* Boundary control */
+				if (o_ptr->timeout < 0) o_ptr->timeout = 0;
+
+				/* Notify player standing on top of that item */
+				notify_player_standing_on(i);
+			}
 		}
 	}
 
@@ -5390,7 +5310,7 @@ int scan_floor(player_type *p_ptr, int *items, int max_size, int y, int x, int m
 			continue;
 #else
 		/* MAngband-specific: squelch/mode 0x02 alternative */
-		if ((mode & 0x02) && !(p_ptr->obj_vis[this_o_idx])) continue;
+		if ((mode & 0x02) && !(bit_has(p_ptr->obj_vis, this_o_idx))) continue;
 #endif
 
 		/* Accept this item */
@@ -520,7 +520,7 @@ int party_mark_members(player_type *p_ptr, int m_idx)
 		q_ptr = Players[i];
 		q_ptr->in_hack = FALSE;
 		if (same_player(q_ptr, p_ptr) || ((p_ptr->party) &&
-			(!m_idx || q_ptr->mon_hrt[m_idx]) &&
+			(!m_idx || bit_has(q_ptr->mon_hrt, m_idx)) &&
 			(q_ptr->dun_depth == p_ptr->dun_depth) &&
 			(q_ptr->party == p_ptr->party) &&
 			((cfg_party_sharelevel == -1) || (abs(q_ptr->lev - p_ptr->lev) <= cfg_party_sharelevel))
@@ -544,8 +544,8 @@ void party_share_hurt(player_type *p_ptr, player_type  *q_ptr)
 	/* Copy hurt */
 	for (i = 0; i < MAX_M_IDX; i++)
 	{
-		if (q_ptr->mon_hrt[i])
-			p_ptr->mon_hrt[i] = TRUE;
+		if (bit_has(q_ptr->mon_hrt, i))
+			bit_on(p_ptr->mon_hrt, i);
 	}
 }
 
@@ -791,8 +791,12 @@ bool check_hostile(player_type *p_ptr, player_type *q_ptr)
  * hash function can be a bitwise "and" and get the relevant bits off the end.
  *
  * No "probing" is done; if any two ID's map to the same hash slot, they will
- * be chained in a linked list.  This will most likely be a very rare thing,
- * however.
+ * be chained in a linked list.  The table is doubled whenever it holds more
+ * entries than slots, so the chains stay short.
+ *
+ * Every entry is also chained into a second table, keyed by a hash of the
+ * lower-cased player name, so that looking up an ID by name does not need
+ * to walk the whole table.  Names are still compared exactly.
  */
 
 /* The struct to hold a data entry */
@@ -803,10 +807,16 @@ struct hash_entry
 	int id;				/* The ID */
 	cptr name;			/* Player name */
 	struct hash_entry *next;	/* Next entry in the chain */
+	struct hash_entry *name_next;	/* Next entry in the name chain */
 };
 
-/* The hash table itself */
-static hash_entry *hash_table[NUM_HASH_ENTRIES];
+/* The hash tables themselves, by ID and by name */
+static hash_entry **hash_table = NULL;
+static hash_entry **name_table = NULL;
+
+/* Number of slots in each table (a power of 2), and of entries */
+static int hash_size = 0;
+static int hash_num = 0;
 
 
 /*
@@ -815,7 +825,70 @@ static hash_entry *hash_table[NUM_HASH_ENTRIES];
 static int hash_slot(int id)
 {
 	/* Be very efficient */
-	return (id & (NUM_HASH_ENTRIES - 1));
+	return (id & (hash_size - 1));
+}
+
+/*
+ * Return the slot in which a name should be stored.
+ */
+static int name_slot(cptr name)
+{
+	u32b h = 5381;
+
+	while (*name) h = (h * 33) ^ (byte)tolower((unsigned char)*name++);
+
+	return (h & (hash_size - 1));
+}
+
+/*
+ * Put an entry at the head of its chains.
+ */
+static void hash_link(hash_entry *ptr)
+{
+	int slot = hash_slot(ptr->id);
+	int nslot = name_slot(ptr->name);
+
+	ptr->next = hash_table[slot];
+	hash_table[slot] = ptr;
+
+	ptr->name_next = name_table[nslot];
+	name_table[nslot] = ptr;
+}
+
+/*
+ * Make room for at least "num" entries, before adding them one by one
+ * (for example, when loading the whole table from the server savefile).
+ */
+void reserve_player_names(int num)
+{
+	hash_entry **old_table = hash_table;
+	hash_entry *ptr, *next;
+	int old_size = hash_size;
+	int size = NUM_HASH_ENTRIES;
+	int i;
+
+	while (size < num && size < 0x1000000) size <<= 1;
+
+	/* Big enough already */
+	if (size <= hash_size) return;
+
+	/* Allocate the new tables */
+	C_MAKE(hash_table, size, hash_entry *);
+	KILL(name_table);
+	C_MAKE(name_table, size, hash_entry *);
+	hash_size = size;
+
+	/* Move the old entries over */
+	for (i = 0; i < old_size; i++)
+	{
+		for (ptr = old_table[i]; ptr; ptr = next)
+		{
+			next = ptr->next;
+			hash_link(ptr);
+		}
+	}
+
+	KILL(old_table);
 }
 
 /*
@@ -826,6 +899,9 @@ cptr lookup_player_name(int id)
 	int slot;
 	hash_entry *ptr;
 
+	/* Empty table */
+	if (!hash_size) return NULL;
+
 	/* Get the slot */
 	slot = hash_slot(id);
 
@@ -853,24 +929,16 @@ cptr lookup_player_name(int id)
 int lookup_player_id(cptr name)
 {
 	hash_entry *ptr;
-	int i;
 
-	/* Search in each array slot */
-	for (i = 0; i < NUM_HASH_ENTRIES; i++)
-	{
-		/* Acquire pointer to this chain */
-		ptr = hash_table[i];
+	/* Empty table */
+	if (!hash_size) return 0;
 
-		/* Check all entries in this chain */
-		while (ptr)
-		{
-			/* Check this name */
-			if (!strcmp(ptr->name, name))
-				return ptr->id;
-
-			/* Next entry in chain */
-			ptr = ptr->next;
-		}
+	/* Search the name chain */
+	for (ptr = name_table[name_slot(name)]; ptr; ptr = ptr->name_next)
+	{
+		/* Check this name */
+		if (!strcmp(ptr->name, name))
+			return ptr->id;
 	}
 
 	/* Not found */
@@ -882,11 +950,10 @@ int lookup_player_id(cptr name)
  */
 void add_player_name(cptr name, int id)
 {
-	int slot;
 	hash_entry *ptr;
 
-	/* Get the destination slot */
-	slot = hash_slot(id);
+	/* Grow the table as needed */
+	reserve_player_names(hash_num + 1);
 
 	/* Create a new hash entry struct */
 	MAKE(ptr, hash_entry);
@@ -897,11 +964,9 @@ void add_player_name(cptr name, int id)
 	/* Set the entry's id */
 	ptr->id = id;
 
-	/* Add the rest of the chain to this entry */
-	ptr->next = hash_table[slot];
-
-	/* Put this entry in the table */
-	hash_table[slot] = ptr;
+	/* Put this entry in the tables */
+	hash_link(ptr);
+	hash_num++;
 }
 
 /*
@@ -910,7 +975,10 @@ void add_player_name(cptr name, int id)
 void delete_player_id(int id)
 {
 	int slot;
-	hash_entry *ptr, *old_ptr;
+	hash_entry *ptr, *old_ptr, **link;
+
+	/* Empty table */
+	if (!hash_size) return;
 
 	/* Get the destination slot */
 	slot = hash_slot(id);
@@ -932,12 +1000,20 @@ void delete_player_id(int id)
 				hash_table[slot] = ptr->next;
 			else old_ptr->next = ptr->next;
 
+			/* And from its name chain */
+			link = &name_table[name_slot(ptr->name)];
+			while (*link != ptr) link = &(*link)->name_next;
+			*link = ptr->name_next;
+
 			/* Free the memory in the player name */
 			free((char *)(ptr->name));
 
 			/* Free the memory for this struct */
 			KILL(ptr);
 
+			/* One less */
+			hash_num--;
+
 			/* Done */
 			return;
 		}
@@ -982,7 +1058,7 @@ void wipe_player_names()
 	hash_entry *next;
 
 	/* Entry points */
-	for (i = 0; i < NUM_HASH_ENTRIES; i++)
+	for (i = 0; i < hash_size; i++)
 	{
 		/* Acquire this chain */
 		ptr = hash_table[i];
@@ -999,6 +1075,11 @@ void wipe_player_names()
 			ptr = next;
 		}
 	}
+
+	/* Free the tables */
+	KILL(hash_table);
+	KILL(name_table);
+	hash_size = hash_num = 0;
 }
 /*
  * Return a list of the player ID's stored in the table.
@@ -1009,7 +1090,7 @@ int player_id_list(int **list)
 	hash_entry *ptr;
 
 	/* Count up the number of valid entries */
-	for (i = 0; i < NUM_HASH_ENTRIES; i++)
+	for (i = 0; i < hash_size; i++)
 	{
 		/* Acquire this chain */
 		ptr = hash_table[i];
@@ -1029,7 +1110,7 @@ int player_id_list(int **list)
 	C_MAKE((*list), len, int);
 
 	/* Look again, this time storing ID's */
-	for (i = 0; i < NUM_HASH_ENTRIES; i++)
+	for (i = 0; i < hash_size; i++)
 	{
 		/* Acquire this chain */
 		ptr = hash_table[i];
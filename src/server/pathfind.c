@@ -19,109 +19,246 @@
 #define DUNGEON_WID MAX_WID
 #define DUNGEON_HGT MAX_HGT
 
+/* Grids in the search window */
+#define PF_GRIDS (MAX_PF_RADIUS * MAX_PF_RADIUS)
 
+/* "dist" of grids which may not be entered */
+#define PF_BLOCKED (MAX_PF_LENGTH + 2)
 
-/*** Globals ***/
 
-static int terrain[MAX_PF_RADIUS][MAX_PF_RADIUS];
-/*char pf_result[MAX_PF_LENGTH];
-int pf_result_index;*/
-
-static int ox, oy, ex, ey;
-static int dir_search[8] = {2,4,6,8,1,3,7,9};
+/*** Search window ***/
 
+/*
+ * The square of MAX_PF_RADIUS grids around the start of a search.
+ * Everything else a search needs lives on the stack of "path_find()",
+ * so searches may be run for any number of players (or monsters).
+ */
+typedef struct path_window path_window;
 
-/*** Pathfinding code ***/
+struct path_window
+{
+	int ox, oy;	/* Top left grid */
+	int ex, ey;	/* Bottom right grid (exclusive) */
+};
 
-static bool is_valid_pf(player_type *p_ptr, int y, int x)
+static void path_window_init(path_window *w, int y, int x)
 {
-	int Depth = p_ptr->dun_depth;
-	cave_type *c_ptr;
+	w->ox = MAX(x - MAX_PF_RADIUS / 2, 0);
+	w->oy = MAX(y - MAX_PF_RADIUS / 2, 0);
 
-	/* Unvisited means allowed */
-	if (!(p_ptr->cave_flag[y][x] & (CAVE_MARK))) return (TRUE);
+	w->ex = MIN(x + MAX_PF_RADIUS / 2 - 1, DUNGEON_WID);
+	w->ey = MIN(y + MAX_PF_RADIUS / 2 - 1, DUNGEON_HGT);
+}
 
-	/* Require open space */
-	if (!cave_floor_bold(Depth, y, x)) return (FALSE);
+#define path_window_has(W,Y,X) \
+	(((X) >= (W)->ox) && ((X) < (W)->ex) && ((Y) >= (W)->oy) && ((Y) < (W)->ey))
 
-	/* Hack -- don't step into traps */
-	c_ptr = &cave[Depth][y][x];
-	if ((p_ptr->cave_flag[y][x] & (CAVE_MARK)) /* Known location */
-	&& (c_ptr->feat >= FEAT_TRAP_HEAD) /* Visible trap */
-	&& (c_ptr->feat <= FEAT_TRAP_TAIL)) return (FALSE);
+#define PF_IDX(W,Y,X) (((Y) - (W)->oy) * MAX_PF_RADIUS + ((X) - (W)->ox))
 
-	return (TRUE);
+
+/*** Pathfinding code ***/
+
+/*
+ * Estimated number of steps left from (y, x) to (ty, tx), times 256.
+ *
+ * Diagonal steps cost as much as straight ones, so the octile distance
+ * is simply the larger of the two offsets.  The smaller one breaks ties
+ * so that the search prefers grids near the straight line.
+ */
+static u32b path_estimate(int y, int x, int ty, int tx)
+{
+	int dy = ABS(ty - y);
+	int dx = ABS(tx - x);
+
+	return ((u32b)MAX(dy, dx) << 8) + MIN(dy, dx);
 }
 
-static void fill_terrain_info(player_type *p_ptr)
+/*
+ * Find a shortest path from (y1, x1) to (y2, x2) on level "Depth",
+ * using A* with a binary heap.
+ *
+ * The search is bounded by the MAX_PF_RADIUS square around the start.
+ * "pass(data, Depth, y, x)" tells whether a grid may be entered, the
+ * start itself is never asked about.
+ *
+ * On success, the directions to take are stored in "path" (first step
+ * first) and their number is returned.  If there is no path, or it
+ * would be longer than "max" steps, -1 is returned.
+ */
+int path_find(int Depth, int y1, int x1, int y2, int x2,
+	bool (*pass)(void *data, int Depth, int y, int x), void *data,
+	byte *path, int max)
 {
-	int i, j;
+	path_window win, *w = &win;
 
-	ox = MAX(p_ptr->px - MAX_PF_RADIUS / 2, 0);
-	oy = MAX(p_ptr->py - MAX_PF_RADIUS / 2, 0);
+	u16b dist[PF_GRIDS];	/* Steps from the start plus one, 0 if unseen */
+	byte from[PF_GRIDS];	/* Direction of the step into the grid */
+	s16b where[PF_GRIDS];	/* Heap position plus one, 0 if closed */
+	u32b key[PF_GRIDS];	/* Estimated total cost of open grids */
+	s16b heap[PF_GRIDS];	/* Open grids */
+	int num = 0;
 
-	ex = MIN(p_ptr->px + MAX_PF_RADIUS / 2 - 1, DUNGEON_WID);
-	ey = MIN(p_ptr->py + MAX_PF_RADIUS / 2 - 1, DUNGEON_HGT);
+	int i, j, k, d, y, x, ny, nx, cur, next, goal;
+	u32b f;
 
-	for (j = 0; j < MAX_PF_RADIUS; j++)
-	for (i = 0; i < MAX_PF_RADIUS; i++)
-		terrain[j][i] = -1;
+	/* Start and goal must be in the window */
+	path_window_init(w, y1, x1);
+	if (!path_window_has(w, y2, x2)) return (-1);
 
-	for (j = oy; j < ey; j++)
-		for (i = ox; i < ex; i++)
-			if (is_valid_pf(p_ptr, j, i))
-				terrain[j - oy][i - ox] = MAX_PF_LENGTH;
+	/* Count */
+	perf_path_queries++;
 
-	terrain[p_ptr->py - oy][p_ptr->px - ox] = 1;
-}
+	/* Trivial */
+	if ((y1 == y2) && (x1 == x2)) return (0);
 
-#define MARK_DISTANCE(c,d) if ((c <= MAX_PF_LENGTH) && (c > d)) { c = d; try_again = (TRUE); }
+	/* Keep the distances below PF_BLOCKED */
+	if (max > MAX_PF_LENGTH) max = MAX_PF_LENGTH;
 
-bool findpath(player_type *p_ptr, int y, int x)
-{
-	int i, j, k;
-	int dir = 10;
-	bool try_again;
-	int cur_distance;
+	C_WIPE(dist, PF_GRIDS, u16b);
+	C_WIPE(where, PF_GRIDS, s16b);
 
-	fill_terrain_info(p_ptr);
+	goal = PF_IDX(w, y2, x2);
 
-	terrain[p_ptr->py - oy][p_ptr->px - ox] = 1;
+	/* Open the start */
+	cur = PF_IDX(w, y1, x1);
+	dist[cur] = 1;
+	key[cur] = path_estimate(y1, x1, y2, x2);
+	heap[num++] = cur;
+	where[cur] = num;
 
-	if ((x >= ox) && (x < ex) && (y >= oy) && (y < ey))
+	while (num)
 	{
-		if ((cave[p_ptr->dun_depth][y][x].m_idx > 0) && (p_ptr->mon_los[cave[p_ptr->dun_depth][y][x].m_idx ]))
+		/* Take the best open grid */
+		cur = heap[0];
+		where[cur] = 0;
+
+		/* Sift the last one down from the top */
+		next = heap[--num];
+		for (i = 0; num; i = j)
 		{
-			terrain[y - oy][x - ox] = MAX_PF_LENGTH;
+			j = 2 * i + 1;
+			if (j >= num) break;
+			if ((j + 1 < num) && (key[heap[j + 1]] < key[heap[j]])) j++;
+			if (key[next] <= key[heap[j]]) break;
+			heap[i] = heap[j];
+			where[heap[i]] = i + 1;
 		}
-
-#if 0
-		else if (terrain[y-oy][x-ox] != MAX_PF_LENGTH)
+		if (num)
 		{
-		   bell();
-		   return (FALSE);
+			heap[i] = next;
+			where[next] = i + 1;
 		}
-#endif
 
-		terrain[y - oy][x - ox] = MAX_PF_LENGTH;
-	}
-	else
-	{
-		bell();
-		return (FALSE);
+		/* Done */
+		if (cur == goal) break;
+
+		/* Count */
+		perf_path_nodes++;
+
+		y = w->oy + cur / MAX_PF_RADIUS;
+		x = w->ox + cur % MAX_PF_RADIUS;
+
+		/* Look around */
+		for (k = 0; k < 8; k++)
+		{
+			d = ddd[k];
+			ny = y + ddy[d];
+			nx = x + ddx[d];
+
+			if (!path_window_has(w, ny, nx)) continue;
+
+			next = PF_IDX(w, ny, nx);
+
+			/* Blocked (only ask once) */
+			if (dist[next] == PF_BLOCKED) continue;
+			if (!dist[next] && !(*pass)(data, Depth, ny, nx))
+			{
+				dist[next] = PF_BLOCKED;
+				continue;
+			}
+
+			/* Already reached as quickly */
+			if (dist[next] && (dist[next] <= dist[cur] + 1)) continue;
+
+			/* Too far */
+			if (dist[cur] > max) continue;
+
+			dist[next] = dist[cur] + 1;
+			from[next] = d;
+			f = ((u32b)(dist[next] - 1) << 8) + path_estimate(ny, nx, y2, x2);
+			key[next] = f;
+
+			/* Open it, or move it up */
+			i = where[next] ? where[next] - 1 : num++;
+			while (i > 0)
+			{
+				j = (i - 1) / 2;
+				if (key[heap[j]] <= f) break;
+				heap[i] = heap[j];
+				where[heap[i]] = i + 1;
+				i = j;
+			}
+			heap[i] = next;
+			where[next] = i + 1;
+		}
 	}
 
-	if (terrain[y - oy][x - ox] == -1)
+	/* Failure */
+	if (!dist[goal] || (dist[goal] == PF_BLOCKED)) return (-1);
+
+	/* Walk back from the goal */
+	num = dist[goal] - 1;
+	y = y2;
+	x = x2;
+	for (i = num - 1; i >= 0; i--)
 	{
-		bell();
-		return (FALSE);
+		d = from[PF_IDX(w, y, x)];
+		path[i] = d;
+		y -= ddy[d];
+		x -= ddx[d];
 	}
 
+	return (num);
+}
+
+
+#ifdef DEBUG
+/*
+ * The old pathfinder, kept for comparison by the "pathtest" console
+ * command: relax the whole window over and over until nothing changes.
+ */
+#define MARK_DISTANCE(c,d) if ((c <= MAX_PF_LENGTH) && (c > d)) { c = d; try_again = (TRUE); }
+
+int path_find_naive(int Depth, int y1, int x1, int y2, int x2,
+	bool (*pass)(void *data, int Depth, int y, int x), void *data,
+	byte *path, int max)
+{
+	static int terrain[MAX_PF_RADIUS][MAX_PF_RADIUS];
+	static int dir_search[8] = {2,4,6,8,1,3,7,9};
+	int ox, oy, ex, ey;
+	int i, j, k, n;
+	int dir = 10;
+	bool try_again;
+	int cur_distance;
+
+	ox = MAX(x1 - MAX_PF_RADIUS / 2, 0);
+	oy = MAX(y1 - MAX_PF_RADIUS / 2, 0);
+	ex = MIN(x1 + MAX_PF_RADIUS / 2 - 1, DUNGEON_WID);
+	ey = MIN(y1 + MAX_PF_RADIUS / 2 - 1, DUNGEON_HGT);
+
+	if ((x2 < ox) || (x2 >= ex) || (y2 < oy) || (y2 >= ey)) return (-1);
+
+	for (j = 0; j < MAX_PF_RADIUS; j++)
+	for (i = 0; i < MAX_PF_RADIUS; i++)
+		terrain[j][i] = -1;
+
+	for (j = oy; j < ey; j++)
+		for (i = ox; i < ex; i++)
+			if ((*pass)(data, Depth, j, i))
+				terrain[j - oy][i - ox] = MAX_PF_LENGTH;
+
+	terrain[y1 - oy][x1 - ox] = 1;
 
-	/* 
-	 * And now starts the very naive and very 
-	 * inefficient pathfinding algorithm
-	 */
 	do
 	{
 		try_again = FALSE;
@@ -134,6 +271,8 @@ bool findpath(player_type *p_ptr, int y, int x)
 
 				if ((cur_distance > 0) && (cur_distance < MAX_PF_LENGTH))
 				{
+					perf_path_nodes++;
+
 					for (dir = 1; dir < 10; dir++)
 					{
 						if (dir == 5)
@@ -145,76 +284,113 @@ bool findpath(player_type *p_ptr, int y, int x)
 			}
 		}
 
-		if (terrain[y - oy][x - ox] < MAX_PF_LENGTH)
+		if (terrain[y2 - oy][x2 - ox] < MAX_PF_LENGTH)
 			try_again = (FALSE);
 
 	}
 	while (try_again);
 
-	/* Failure */
-	if (terrain[y - oy][x - ox] == MAX_PF_LENGTH)
-	{
-		bell();
-		return (FALSE);
-	}
+	if (terrain[y2 - oy][x2 - ox] >= MAX_PF_LENGTH) return (-1);
 
-	/* Success */
-	i = x;
-	j = y;
-
-	p_ptr->pf_result_index = 0;
+	n = terrain[y2 - oy][x2 - ox] - 1;
+	if (n > max) return (-1);
 
-	while ((i != p_ptr->px) || (j != p_ptr->py))
+	i = x2;
+	j = y2;
+	while (n--)
 	{
 		cur_distance = terrain[j - oy][i - ox] - 1;
 		for (k = 0; k < 8; k++)
 		{
 			dir = dir_search[k];
-
-			/* Paranoia -- stay in terrain[][] bounds */
-			if (j - oy + ddy[dir] < 0 ||
-			    j - oy + ddy[dir] >= MAX_PF_RADIUS ||
-			    i - ox + ddx[dir] < 0 ||
-			    i - ox + ddx[dir] >= MAX_PF_RADIUS)
-			{
-				/* Skip this direction */
-				dir = 5;
+			if (j - oy + ddy[dir] < 0 || j - oy + ddy[dir] >= MAX_PF_RADIUS ||
+			    i - ox + ddx[dir] < 0 || i - ox + ddx[dir] >= MAX_PF_RADIUS)
 				continue;
-			}
-
 			if (terrain[j - oy + ddy[dir]][i - ox + ddx[dir]] == cur_distance)
 				break;
 		}
+		if (k == 8) return (-1);
 
-		/* Should never happend */
-		if (dir == 10)
-		{
-			bell();
-			return (FALSE);
-		}
-
-		else if (dir == 5)
-		{
-			bell();
-			return (FALSE);
-		}
-
-		p_ptr->pf_result[p_ptr->pf_result_index++] = '0' + (char)(10 - dir);
+		path[n] = 10 - dir;
 		i += ddx[dir];
 		j += ddy[dir];
-
-		/* Paranoia -- stay in pf_result[MAX_PF_LENGTH] bounds */
-		if (p_ptr->pf_result_index >= MAX_PF_LENGTH)
-		{
-			bell();
-			return (FALSE);
-		}
 	}
 
-	p_ptr->pf_result_index--;
+	return (terrain[y2 - oy][x2 - ox] - 1);
+}
+#endif /* DEBUG */
+
+
+/*
+ * A player's pathfinding query
+ */
+typedef struct player_path player_path;
+
+struct player_path
+{
+	player_type *p_ptr;
+	int y, x;	/* Destination */
+};
+
+/*
+ * May the player's pathfinder step into (y, x)?
+ */
+static bool is_valid_pf(void *data, int Depth, int y, int x)
+{
+	player_path *pp = (player_path *)data;
+	player_type *p_ptr = pp->p_ptr;
+	cave_type *c_ptr;
+
+	/* Hack -- the destination is always allowed */
+	if ((y == pp->y) && (x == pp->x)) return (TRUE);
+
+	/* Unvisited means allowed */
+	if (!(p_ptr->cave_flag[y][x] & (CAVE_MARK))) return (TRUE);
+
+	/* Require open space */
+	if (!cave_floor_bold(Depth, y, x)) return (FALSE);
+
+	/* Hack -- don't step into traps */
+	c_ptr = &cave[Depth][y][x];
+	if ((p_ptr->cave_flag[y][x] & (CAVE_MARK)) /* Known location */
+	&& (c_ptr->feat >= FEAT_TRAP_HEAD) /* Visible trap */
+	&& (c_ptr->feat <= FEAT_TRAP_TAIL)) return (FALSE);
 
 	return (TRUE);
 }
 
+/*
+ * Plan a route for the player to (y, x), see "run_step()".
+ *
+ * "pf_result" holds the directions last step first, and
+ * "pf_result_index" points at the next one to take.
+ */
+bool findpath(player_type *p_ptr, int y, int x)
+{
+	player_path pp;
+	byte path[MAX_PF_LENGTH];
+	int i, n;
+
+	pp.p_ptr = p_ptr;
+	pp.y = y;
+	pp.x = x;
 
+	n = path_find(p_ptr->dun_depth, p_ptr->py, p_ptr->px, y, x,
+		is_valid_pf, &pp, path, MAX_PF_LENGTH - 1);
 
+	/* Failure */
+	if (n <= 0)
+	{
+		bell();
+		return (FALSE);
+	}
+
+	/* Success */
+	for (i = 0; i < n; i++)
+	{
+		p_ptr->pf_result[i] = '0' + (char)path[n - 1 - i];
+	}
+	p_ptr->pf_result_index = n - 1;
+
+	return (TRUE);
+}
@@ -4,6 +4,15 @@
 
 #include "mangband.h"
 #include "../common/md5.h"
+#include "../common/net-basics.h"
+#include "../common/net-imps.h"
+
+#if defined(HAVE_FORK) && defined(HAVE_SYS_WAIT_H)
+# define USE_SNAPSHOT
+# include <sys/wait.h>
+# include <unistd.h>
+# include <fcntl.h>
+#endif
 
 /*
  * Some "local" parameters, used to help write savefiles
@@ -18,10 +27,147 @@ static int xml_indent = 0L;
 static char xml_buf[32];
 static char *xml_prefix = xml_buf;
 
+/*
+ * Binary savefile writer, see "SAVEFILE_MAGIC" in "mdefines.h".
+ *
+ * The whole file is assembled in memory and written out at once,
+ * which also lets us patch section lengths after the fact.
+ */
+static bool save_binary = FALSE;	/* Current savefile is binary */
+static byte *bin_buf = NULL;	/* Output buffer (kept between saves) */
+static u32b bin_len = 0;
+static u32b bin_max = 0;
+static u32b bin_section[16];	/* Offsets of open section lengths */
+static int bin_depth = 0;
+
+/* Name dictionary (names are stored in the output buffer itself) */
+static u32b bin_name_off[SAVEFILE_NAMES];
+static u16b bin_name_len[SAVEFILE_NAMES];
+static u16b bin_name_hash[SAVEFILE_NAMES * 2];	/* 0 is empty, else index + 1 */
+static int bin_num_names = 0;
+
+/* Make room for "n" more bytes */
+static void bin_grow(u32b n)
+{
+	byte *old_buf = bin_buf;
+
+	if (bin_len + n <= bin_max) return;
+
+	/* Double the buffer */
+	while (bin_len + n > bin_max) bin_max = (bin_max ? bin_max * 2 : 64 * 1024);
+	bin_buf = C_RNEW(bin_max, byte);
+	if (old_buf)
+	{
+		memcpy(bin_buf, old_buf, bin_len);
+		FREE(old_buf);
+	}
+}
+
+/* Append raw bytes */
+static void bin_bytes(const byte *data, u32b n)
+{
+	bin_grow(n);
+	memcpy(bin_buf + bin_len, data, n);
+	bin_len += n;
+}
+
+/* Append a varint */
+static void bin_varint(huge value)
+{
+	bin_grow(10);
+	while (value >= 0x80)
+	{
+		bin_buf[bin_len++] = (byte)(value | 0x80);
+		value >>= 7;
+	}
+	bin_buf[bin_len++] = (byte)value;
+}
+
+/* Start a record, reusing the name from the dictionary when possible */
+static void bin_record(byte type, const char *name)
+{
+	u32b len = strlen(name);
+	u32b h = 5381;
+	int i, slot;
+
+	for (i = 0; i < len; i++) h = h * 33 + (byte)name[i];
+	slot = h & (SAVEFILE_NAMES * 2 - 1);
+
+	bin_grow(1);
+	bin_buf[bin_len++] = type;
+
+	/* Look the name up */
+	while ((i = bin_name_hash[slot]))
+	{
+		i--;
+		if (bin_name_len[i] == len && !memcmp(bin_buf + bin_name_off[i], name, len))
+		{
+			bin_varint(i + 1);
+			return;
+		}
+		slot = (slot + 1) & (SAVEFILE_NAMES * 2 - 1);
+	}
+
+	/* Define it */
+	bin_varint(0);
+	bin_varint(len);
+
+	/* Remember it, unless the dictionary is full (the loader agrees) */
+	if (bin_num_names < SAVEFILE_NAMES)
+	{
+		bin_name_off[bin_num_names] = bin_len;
+		bin_name_len[bin_num_names] = len;
+		bin_name_hash[slot] = ++bin_num_names;
+	}
+
+	bin_bytes((const byte *)name, len);
+}
+
+/* Begin a new savefile in the requested format */
+static void save_begin(bool binary)
+{
+	save_binary = binary;
+	xml_indent = 0;
+	if (!binary) return;
+
+	bin_len = 0;
+	bin_depth = 0;
+	bin_num_names = 0;
+	C_WIPE(bin_name_hash, SAVEFILE_NAMES * 2, u16b);
+
+	bin_bytes((const byte *)SAVEFILE_MAGIC, SAVEFILE_MAGIC_LEN);
+	bin_grow(1);
+	bin_buf[bin_len++] = SAVEFILE_BINARY_VERSION;
+}
+
+/* Finish the savefile, writing out the binary buffer */
+static bool save_end(void)
+{
+	bool ok = TRUE;
+
+	if (save_binary)
+	{
+		if (bin_depth) ok = FALSE;
+		else if (!file_write(file_handle, (char *)bin_buf, bin_len)) ok = FALSE;
+	}
+	save_binary = FALSE;
+
+	return (ok);
+}
+
 /* Start a section */
 static void start_section(char* name)
 {
 	int i;
+	if (save_binary)
+	{
+		bin_record(SREC_SECTION, name);
+		bin_grow(4);
+		if (bin_depth < 16) bin_section[bin_depth] = bin_len;
+		bin_depth++;
+		bin_len += 4;
+		return;
+	}
 	if(xml_indent == 0) xml_prefix[0] = '\0';
 	file_putf(file_handle, "%s<%s>\n", xml_prefix,name);
 	xml_indent += 2;
@@ -33,6 +179,18 @@ static void start_section(char* name)
 static void end_section(char* name)
 {
 	int i;
+	if (save_binary)
+	{
+		u32b off, len;
+		bin_record(SREC_END, name);
+		if (--bin_depth >= 16) return;
+
+		/* Patch the length of the section body (little endian) */
+		off = bin_section[bin_depth];
+		len = bin_len - off - 4;
+		for (i = 0; i < 4; i++) bin_buf[off + i] = (byte)(len >> (8 * i));
+		return;
+	}
 	xml_indent -= 2;
 	for(i = 0;i<xml_indent;i++) xml_buf[i] = ' ';
 	xml_buf[xml_indent] = '\0';
@@ -42,30 +200,65 @@ static void end_section(char* name)
 /* Write an integer */
 static void write_int(char* name, int value)
 {
+	if (save_binary)
+	{
+		/* Zigzag, so small negative numbers stay small */
+		u32b zz = ((u32b)value << 1) ^ (value < 0 ? 0xFFFFFFFFL : 0L);
+		bin_record(SREC_INT, name);
+		bin_varint(zz);
+		return;
+	}
 	file_putf(file_handle, "%s%s = %i\n", xml_prefix, name, value);
 }
 
 /* Write an unsigned integer value */
 static void write_uint(const char* name, unsigned int value)
 {
+	if (save_binary)
+	{
+		bin_record(SREC_UINT, name);
+		bin_varint(value);
+		return;
+	}
 	file_putf(file_handle, "%s%s = %u\n", xml_prefix, name, value);
 }
 
 /* Write an signed long value */
 static void write_huge(char* name, huge value)
 {
+	if (save_binary)
+	{
+		bin_record(SREC_HUGE, name);
+		bin_varint(value);
+		return;
+	}
 	file_putf(file_handle, "%s%s = %" PRIu64 "\n", xml_prefix,name, value);
 }
 
 /* Write an hturn */
 static void write_hturn(char* name, hturn *value)
 {
+	if (save_binary)
+	{
+		bin_record(SREC_HTURN, name);
+		bin_varint(value->era);
+		bin_varint(value->turn);
+		return;
+	}
 	file_putf(file_handle, "%s%s = %" PRIu64 " %" PRIu64 "\n", xml_prefix, name, value->era, value->turn);
 }
 
 /* Write a string */
 static void write_str(char* name, char* value)
 {
+	if (save_binary)
+	{
+		u32b len = strlen(value);
+		bin_record(SREC_STR, name);
+		bin_varint(len);
+		bin_bytes((const byte *)value, len);
+		return;
+	}
 	file_putf(file_handle, "%s%s = %s\n", xml_prefix, name, value);
 }
 
@@ -73,12 +266,23 @@ static void write_str(char* name, char* value)
 static void write_quark(char* name, u16b quark)
 {
 	char *value = quark ? (char*)quark_str(quark) : "";
+	if (save_binary)
+	{
+		write_str(name, value);
+		return;
+	}
 	file_putf(file_handle, "%s%s = %s\n", xml_prefix, name, value);
 }
 
 #if 0
 static void write_float(char* name, float value)
 {
+	if (save_binary)
+	{
+		bin_record(SREC_FLOAT, name);
+		bin_bytes((const byte *)&value, 4);
+		return;
+	}
 	file_putf(file_handle, "%s%s = %f\n", xml_prefix, name, value);
 }
 #endif
@@ -87,6 +291,46 @@ static void write_binary(char* name, char* data, int len)
 {
 	int i;
 	byte b;
+	if (save_binary)
+	{
+		int runs = 0;
+		b = 0;
+
+		/* Count the runs */
+		for (i = 0; i < len; i++)
+		{
+			if (!i || data[i] != data[i - 1] || ++b == 255)
+			{
+				runs++;
+				b = 0;
+			}
+		}
+
+		/* Store raw */
+		if (runs * 2 + 2 >= len)
+		{
+			bin_record(SREC_RAW, name);
+			bin_varint(len);
+			bin_bytes((const byte *)data, len);
+			return;
+		}
+
+		/* Store (count, byte) pairs */
+		bin_record(SREC_RLE, name);
+		bin_varint(len);
+		bin_varint(runs * 2);
+		bin_grow(runs * 2);
+		for (i = 0; i < len; i++)
+		{
+			if (!i || data[i] != data[i - 1] || bin_buf[bin_len - 2] == 255)
+			{
+				bin_buf[bin_len++] = 1;
+				bin_buf[bin_len++] = data[i];
+			}
+			else bin_buf[bin_len - 2]++;
+		}
+		return;
+	}
 	file_putf(file_handle, "%s%s = ", xml_prefix, name);
 	for(i=0;i<len;i++)
 	{
@@ -721,6 +965,33 @@ static void wr_dungeon(int Depth)
 		write_int("level_rand_x",level_rand_x[Depth]);
 	}
 
+	/*** Binary encoding of cave, one plane per section ***/
+	if (save_binary)
+	{
+		static char cave_plane[MAX_HGT * MAX_WID];
+
+		start_section("features");
+		for (y = 0; y < MAX_HGT; y++)
+		{
+			for (x = 0; x < MAX_WID; x++)
+				cave_plane[y * MAX_WID + x] = cave[Depth][y][x].feat;
+		}
+		write_binary("plane", cave_plane, MAX_HGT * MAX_WID);
+		end_section("features");
+
+		start_section("info");
+		for (y = 0; y < MAX_HGT; y++)
+		{
+			for (x = 0; x < MAX_WID; x++)
+				cave_plane[y * MAX_WID + x] = cave[Depth][y][x].info;
+		}
+		write_binary("plane", cave_plane, MAX_HGT * MAX_WID);
+		end_section("info");
+
+		end_section("dungeon_level");
+		return;
+	}
+
 	/*** Textual encoding of cave ***/
 	start_section("features");
 	for (y = 0; y < MAX_HGT; y++)
@@ -766,15 +1037,20 @@ bool wr_dungeon_special_ext(int Depth, cptr levelname)
 
 	if (fhandle)
 	{
+			/* Level files are always text, they are meant to be edited */
+			bool was_binary = save_binary;
+
 			/* swap out the main file pointer for our level file */
 			server_handle = file_handle;
 			file_handle = fhandle;
+			save_binary = FALSE;
 
 			/* save the level */
 			wr_dungeon(Depth);
 
 			/* swap the file pointers back */
 			file_handle = server_handle;
+			save_binary = was_binary;
 
 			/* close the level file */
 			file_close(fhandle);
@@ -797,6 +1073,20 @@ void wr_cave_memory(player_type *p_ptr)
 	write_int("max_height",MAX_HGT);
 	write_int("max_width",MAX_WID);
 
+	/* whole plane at once */
+	if (save_binary)
+	{
+		static char cave_plane[MAX_HGT * MAX_WID];
+		for (y = 0; y < MAX_HGT; y++)
+		{
+			for (x = 0; x < MAX_WID; x++)
+				cave_plane[y * MAX_WID + x] = p_ptr->cave_flag[y][x];
+		}
+		write_binary("plane", cave_plane, MAX_HGT * MAX_WID);
+		end_section("cave_memory");
+		return;
+	}
+
 	/* break the cave down into rows */
 	for (y = 0; y < MAX_HGT; y++)
 	{
@@ -1002,11 +1292,45 @@ static bool wr_savefile_new(player_type *p_ptr)
 }
 
 
+/*
+ * Background ("snapshot") saves
+ *
+ * The periodic save forks, and the child writes the server state and
+ * every player from its copy-on-write image of the game into ".snap"
+ * files while the main loop carries on.  Once the child is done, the
+ * server moves those files into place, except for savefiles which were
+ * written again in the meantime (e.g. by a player leaving the game),
+ * as those are newer than the snapshot.
+ */
+#ifdef USE_SNAPSHOT
+static pid_t snap_pid = 0;	/* Child process writing the snapshot */
+static cptr snap_file[MAX_PLAYERS + 1];	/* Savefiles in it, server first */
+static bool snap_stale[MAX_PLAYERS + 1];	/* Saved again since */
+static int snap_num = 0;
+static micro snap_stall;	/* Time the main loop spent starting it */
+#endif
+
+/* Note that a savefile is being written in the foreground */
+static void snapshot_stale(cptr name)
+{
+#ifdef USE_SNAPSHOT
+	int i;
+
+	if (!snap_pid) return;
+
+	for (i = 0; i < snap_num; i++)
+	{
+		if (streq(snap_file[i], name)) snap_stale[i] = TRUE;
+	}
+#endif
+}
+
+
 /*
  * Medium level player saver
  *
  */
-static bool save_player_aux(player_type *p_ptr, char *name)
+static bool save_player_aux(player_type *p_ptr, char *name, bool binary)
 {
 	bool	ok = FALSE;
 
@@ -1020,7 +1344,9 @@ static bool save_player_aux(player_type *p_ptr, char *name)
 	if (file_handle)
 	{
 		/* Write the savefile */
+		save_begin(binary);
 		if (wr_savefile_new(p_ptr)) ok = TRUE;
+		if (!save_end()) ok = FALSE;
 
 		/* Attempt to close it */
 		if (!file_close(file_handle)) ok = FALSE;
@@ -1050,6 +1376,9 @@ bool save_player(player_type *p_ptr)
 
 	char	safe[1024];
 
+	/* This is newer than any snapshot in progress */
+	snapshot_stale(p_ptr->savefile);
+
 
 #ifdef SET_UID
 
@@ -1077,7 +1406,7 @@ bool save_player(player_type *p_ptr)
 	file_delete(safe);
 
 	/* Attempt to save the player */
-	if (save_player_aux(p_ptr, safe))
+	if (save_player_aux(p_ptr, safe, cfg_binary_saves))
 	{
 		char temp[1024];
 
@@ -1416,6 +1745,11 @@ bool load_player(player_type *p_ptr)
 	return (FALSE);
 }
 
+/*
+ * Savefile index of each monster, see "wr_server_savefile()"
+ */
+static s16b save_m_idx[MAX_M_IDX];
+
 static bool wr_server_savefile(void)
 {
         int        i;
@@ -1538,23 +1872,38 @@ static bool wr_server_savefile(void)
 	end_section("dungeon_levels");
 
 	start_section("monsters");
-	/* Prepare to write the monsters */
-	compact_monsters(0);
+	/* Number the live monsters, the savefile has no holes */
+	for (tmp32u = 1, i = 1; i < m_max; i++)
+	{
+		save_m_idx[i] = (m_list[i].r_idx ? tmp32u++ : 0);
+	}
 	/* Note the number of monsters */
-	tmp32u = m_max;
 	write_int("max_monsters",tmp32u);
 	/* Dump the monsters */
-	for (i = 1; i < tmp32u; i++) wr_monster(&m_list[i]);
+	for (i = 1; i < m_max; i++)
+	{
+		if (m_list[i].r_idx) wr_monster(&m_list[i]);
+	}
 	end_section("monsters");
 
 	start_section("objects");
-	/* Prepare to write the objects */
-	compact_objects(0);
 	/* Note the number of objects */
-	tmp16u = o_max;
+	for (tmp16u = 1, i = 1; i < o_max; i++)
+	{
+		if (o_list[i].k_idx) tmp16u++;
+	}
 	write_int("max_objects",tmp16u);
-	/* Dump the objects */
-	for (i = 1; i < tmp16u; i++) wr_item(&o_list[i]);
+	/* Dump the objects, pointing them at the renumbered monsters */
+	for (i = 1; i < o_max; i++)
+	{
+		object_type forge;
+
+		if (!o_list[i].k_idx) continue;
+
+		COPY(&forge, &o_list[i], object_type);
+		forge.held_m_idx = save_m_idx[forge.held_m_idx];
+		wr_item(&forge);
+	}
 	end_section("objects");
 
 	start_section("houses");
@@ -1605,7 +1954,7 @@ static bool wr_server_savefile(void)
 }
 
 
-static bool save_server_aux(char *name)
+static bool save_server_aux(char *name, bool binary)
 {
         bool    ok = FALSE;
 
@@ -1620,7 +1969,9 @@ static bool save_server_aux(char *name)
         if (file_handle)
         {
                 /* Write the savefile */
+                save_begin(binary);
                 if (wr_server_savefile()) ok = TRUE;
+                if (!save_end()) ok = FALSE;
 
                 /* Attempt to close it */
                 if (!file_close(file_handle)) ok = FALSE;
@@ -1730,6 +2081,10 @@ bool save_server_info(void)
 	int result = FALSE;
 	char safe[1024];
 
+	/* This is newer than any snapshot in progress */
+	path_build(safe, 1024, ANGBAND_DIR_SAVE, "server");
+	snapshot_stale(safe);
+
 	/* New savefile */
 	path_build(safe, 1024, ANGBAND_DIR_SAVE, "server.new");
 
@@ -1737,7 +2092,7 @@ bool save_server_info(void)
 	file_delete(safe);
 
 	/* Attempt to save the server state */
-	if (save_server_aux(safe))
+	if (save_server_aux(safe, cfg_binary_saves))
 	{
 		char temp[1024];
 		char prev[1024];
@@ -1767,3 +2122,172 @@ bool save_server_info(void)
 	/* Return the result */
 	return (result);
 }
+
+
+/*
+ * Save a player or the server state to an arbitrary file, in the
+ * given format.  Used by the "savetest" console command.
+ */
+bool save_player_as(player_type *p_ptr, char *name, bool binary)
+{
+	return save_player_aux(p_ptr, name, binary);
+}
+
+bool save_server_as(char *name, bool binary)
+{
+	return save_server_aux(name, binary);
+}
+
+
+#ifdef USE_SNAPSHOT
+/*
+ * Write every savefile of the snapshot (runs in the child process)
+ */
+static bool snapshot_write(void)
+{
+	char buf[1024];
+	bool ok = TRUE;
+	int i, fd;
+
+	for (i = 0; i < snap_num; i++)
+	{
+		strnfmt(buf, sizeof(buf), "%s.snap", snap_file[i]);
+		file_delete(buf);
+
+		/* The server state comes first, then Players[1..] */
+		if (i ? !save_player_aux(Players[i], buf, cfg_binary_saves) : !save_server_aux(buf, cfg_binary_saves))
+		{
+			ok = FALSE;
+			continue;
+		}
+
+#ifdef HAVE_FSYNC
+		/* Make sure it hit the disk before it replaces anything */
+		if ((fd = open(buf, O_RDONLY)) >= 0)
+		{
+			fsync(fd);
+			close(fd);
+		}
+#endif
+	}
+
+	return (ok);
+}
+#endif
+
+/*
+ * Start saving the server state and every player in the background.
+ *
+ * Returns FALSE if the caller should save in the foreground instead.
+ */
+bool save_snapshot(void)
+{
+#ifdef USE_SNAPSHOT
+	char buf[1024];
+	pid_t pid;
+	int i;
+
+	if (!cfg_snapshot_saves) return (FALSE);
+
+	/* Still writing the previous one */
+	if (snap_pid)
+	{
+		plog("Snapshot save still in progress, skipping this one");
+		return (TRUE);
+	}
+
+	static_timer(4);
+
+	/* Remember what goes into the snapshot */
+	path_build(buf, 1024, ANGBAND_DIR_SAVE, "server");
+	snap_file[0] = string_make(buf);
+	for (i = 1; i <= NumPlayers; i++) snap_file[i] = string_make(Players[i]->savefile);
+	snap_num = NumPlayers + 1;
+	C_WIPE(snap_stale, snap_num, bool);
+
+	/* Don't let the child flush our buffered output a second time */
+	fflush(NULL);
+
+	pid = fork();
+
+	/* Child -- save and leave, without touching anything else */
+	if (pid == 0)
+	{
+		/* No panic saves or cleanup from this process */
+		server_saved = TRUE;
+		quit_aux = NULL;
+
+		/* Don't hold the sockets open while writing */
+		forget_network_server();
+
+		_exit(snapshot_write() ? 0 : 1);
+	}
+
+	/* Failure */
+	if (pid < 0)
+	{
+		plog("Can't fork, saving in the foreground");
+		for (i = 0; i < snap_num; i++) string_free(snap_file[i]);
+		snap_num = 0;
+		return (FALSE);
+	}
+
+	snap_pid = pid;
+	snap_stall = static_timer(4);
+	static_timer(3);
+
+	return (TRUE);
+#else
+	return (FALSE);
+#endif
+}
+
+/*
+ * Notice a finished snapshot save and move its files into place.
+ * With "wait", block until it finishes.
+ */
+void check_snapshot(bool wait)
+{
+#ifdef USE_SNAPSHOT
+	char buf[1024];
+	int i, status, num = 0;
+	bool ok;
+	pid_t pid;
+	micro took;
+
+	/* Nothing in progress */
+	if (!snap_pid) return;
+
+	/* Still running */
+	pid = waitpid(snap_pid, &status, wait ? 0 : WNOHANG);
+	if (!pid) return;
+
+	took = static_timer(3);
+	snap_pid = 0;
+	ok = (pid > 0 && WIFEXITED(status) && !WEXITSTATUS(status));
+
+	for (i = 0; i < snap_num; i++)
+	{
+		strnfmt(buf, sizeof(buf), "%s.snap", snap_file[i]);
+
+		/* Atomically replace the savefile, unless it is newer */
+		if (ok && !snap_stale[i] && file_move(buf, snap_file[i])) num++;
+		else file_delete(buf);
+
+		string_free(snap_file[i]);
+	}
+	snap_num = 0;
+
+	if (ok)
+	{
+		plog(format("Snapshot saved %d files in %ld ms, main loop stalled %ld usec",
+			num, (long)(took / 1000), (long)snap_stall));
+		return;
+	}
+
+	/* Try again the old way */
+	plog("Snapshot save failed, saving in the foreground");
+	save_server_info();
+	for (i = 1; i <= NumPlayers; i++) save_player(Players[i]);
+#endif
+}
@@ -1365,13 +1365,13 @@ bool detect_treasure(player_type *p_ptr)
 			if (o_ptr->tval == TV_GOLD)
 			{
 				/* Notice new items */
-				if (!(p_ptr->obj_vis[c_ptr->o_idx]))
+				if (!(bit_has(p_ptr->obj_vis, c_ptr->o_idx)))
 				{
 					/* Detect */
 					detect = TRUE;
 
 					/* Hack -- memorize the item */
-					p_ptr->obj_vis[c_ptr->o_idx] = TRUE;
+					bit_on(p_ptr->obj_vis, c_ptr->o_idx);
 
 					/* Redraw */
 					lite_spot(p_ptr, y, x);
@@ -1447,13 +1447,13 @@ bool detect_objects_magic(player_type *p_ptr)
 			    ((o_ptr->to_a > 0) || (o_ptr->to_h + o_ptr->to_d > 0)))
 			{
 				/* Note new items */
-				if (!(p_ptr->obj_vis[c_ptr->o_idx]))
+				if (!(bit_has(p_ptr->obj_vis, c_ptr->o_idx)))
 				{
 					/* Detect */
 					detect = TRUE;
 
 					/* Memorize the item */
-					p_ptr->obj_vis[c_ptr->o_idx] = TRUE;
+					bit_on(p_ptr->obj_vis, c_ptr->o_idx);
 
 					/* Redraw */
 					lite_spot(p_ptr, i, j);
@@ -1548,7 +1548,7 @@ bool detect_invisible(player_type *p_ptr, bool pause)
 			give_detect(p_ptr, i);
 
 			/* Skip visible monsters */
-			if (p_ptr->mon_vis[i]) continue;
+			if (bit_has(p_ptr->mon_vis, i)) continue;
 
 			/* Take note that they are invisible */
 			l_ptr->flags2 |= RF2_INVISIBLE;
@@ -1588,7 +1588,7 @@ bool detect_invisible(player_type *p_ptr, bool pause)
 			give_detect(p_ptr, 0 - i);
 
 			/* Skip visible players */
-			if (p_ptr->play_vis[0 - i]) continue;
+			if (bit_has(p_ptr->play_vis, i)) continue;
 
 			/* Trigger detect effects */
 			flag = TRUE;
@@ -1599,7 +1599,7 @@ bool detect_invisible(player_type *p_ptr, bool pause)
 	if (flag && pause)
 	{
 		/* Mega-Hack -- Fix the monsters and players */
-		update_monsters(FALSE);
+		update_monsters(p_ptr->dun_depth, FALSE);
 		update_players();
 		/* Handle Window stuff */
 		handle_stuff(p_ptr);
@@ -1683,7 +1683,7 @@ bool detect_evil(player_type *p_ptr)
 	if (flag)
 	{
 		/* Mega-Hack -- Fix the monsters */
-		update_monsters(FALSE);
+		update_monsters(p_ptr->dun_depth, FALSE);
 		/* Handle Window stuff */
 		handle_stuff(p_ptr);
 
@@ -1750,7 +1750,7 @@ bool detect_creatures(player_type *p_ptr, bool pause)
 			give_detect(p_ptr, i);
 
 			/* Skip visible monsters */
-			if (p_ptr->mon_vis[i]) continue;
+			if (bit_has(p_ptr->mon_vis, i)) continue;
 
 			flag = TRUE;
 		}
@@ -1780,7 +1780,7 @@ bool detect_creatures(player_type *p_ptr, bool pause)
 			give_detect(p_ptr, 0 - i);
 
 			/* Skip visible players */
-			if (p_ptr->play_vis[i]) continue;
+			if (bit_has(p_ptr->play_vis, i)) continue;
 
 			/* Trigger detect effects */
 			flag = TRUE;
@@ -1791,7 +1791,7 @@ bool detect_creatures(player_type *p_ptr, bool pause)
 	if (flag && pause)
 	{
 		/* Mega-Hack -- Fix the monsters and players */
-		update_monsters(FALSE);
+		update_monsters(p_ptr->dun_depth, FALSE);
 		update_players();
 		/* Handle Window stuff */
 		handle_stuff(p_ptr);
@@ -1831,7 +1831,7 @@ bool detection(player_type *p_ptr)
 	if (detected_creatures || detected_invis)
 	{
 		/* Mega-Hack -- Fix the monsters and players */
-		update_monsters(FALSE);
+		update_monsters(p_ptr->dun_depth, FALSE);
 		update_players();
 		/* Handle Window stuff */
 		handle_stuff(p_ptr);
@@ -1895,13 +1895,13 @@ bool detect_objects_normal(player_type *p_ptr)
 			if (o_ptr->tval == TV_GOLD) continue;
 
 			/* Note new objects */
-			if (!(p_ptr->obj_vis[c_ptr->o_idx]))
+			if (!(bit_has(p_ptr->obj_vis, c_ptr->o_idx)))
 			{
 				/* Detect */
 				detect = TRUE;
 
 				/* Hack -- memorize it */
-				p_ptr->obj_vis[c_ptr->o_idx] = TRUE;
+				bit_on(p_ptr->obj_vis, c_ptr->o_idx);
 
 				/* Redraw */
 				lite_spot(p_ptr, i, j);
@@ -4344,7 +4344,7 @@ static void cave_temp_room_lite(player_type *p_ptr)
 				m_ptr->csleep = 0;
 
 				/* Notice the "waking up" */
-				if (p_ptr->mon_vis[c_ptr->m_idx])
+				if (bit_has(p_ptr->mon_vis, c_ptr->m_idx))
 				{
 					char m_name[80];
 
@@ -4857,8 +4857,8 @@ bool alter_reality(player_type *p_ptr, bool power)
 				/* Saving throw: perception (harder if hostile) */
 				if (randint0(127) < q_ptr->skill_fos * (pvp_okay(p_ptr, q_ptr, 0) ? 6 : 4))
 				{
-					msg_format(p_ptr, "%s sustains reality.", (p_ptr->play_los[i] ? q_ptr->name : "Someone"));
-					msg_format(q_ptr, "You resist %s's attempt to alter reality.", (q_ptr->play_los[p_ptr->Ind] ? p_ptr->name : "someone") );
+					msg_format(p_ptr, "%s sustains reality.", (bit_has(p_ptr->play_los, i) ? q_ptr->name : "Someone"));
+					msg_format(q_ptr, "You resist %s's attempt to alter reality.", (bit_has(q_ptr->play_los, p_ptr->Ind) ? p_ptr->name : "someone") );
 					return (FALSE);
 				}
 			}
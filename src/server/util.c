@@ -1389,34 +1389,165 @@ char inkey(int Ind)
  * Note that "quark zero" is NULL and should not be "dereferenced".
  */
 
+/*
+ * Hash a string for the "quark" index
+ */
+static u32b quark_hash(cptr str)
+{
+	u32b h = 5381;
+
+	while (*str) h = (h * 33) ^ (byte)(*str++);
+
+	return (h & (QUARK_HASH - 1));
+}
+
+/*
+ * Find the hash index slot holding "str", or the empty slot where it belongs.
+ *
+ * The hash index is never more than half full, so this always stops.
+ */
+static u32b quark_slot(cptr str)
+{
+	u32b h = quark_hash(str);
+
+	while (quark__hash[h] && !streq(quark__str[quark__hash[h]], str))
+	{
+		h = (h + 1) & (QUARK_HASH - 1);
+	}
+
+	return (h);
+}
+
 /*
  * Add a new "quark" to the set of quarks.
  */
 s16b quark_add(cptr str)
 {
 	int i;
+	u32b h = quark_slot(str);
 
 	/* Look for an existing quark */
-	for (i = 1; i < quark__num; i++)
-	{
-		/* Check for equality */
-		if (streq(quark__str[i], str)) return (i);
-	}
+	if (quark__hash[h]) return (quark__hash[h]);
+
+	/* Reuse a freed quark */
+	if (quark__free_num) i = quark__free[--quark__free_num];
 
 	/* Paranoia -- Require room */
-	if (quark__num == QUARK_MAX) return (0);
+	else if (quark__num == QUARK_MAX) return (0);
 
 	/* New maximal quark */
-	quark__num = i + 1;
+	else
+	{
+		i = MAX(quark__num, 1);
+		quark__num = i + 1;
+	}
 
 	/* Add a new quark */
 	quark__str[i] = string_make(str);
+	quark__hash[h] = i;
 
 	/* Return the index */
 	return (i);
 }
 
 
+/*
+ * Mark the quarks referenced by a player's objects and history
+ */
+static void quark_mark_player(bool *used, player_type *p_ptr)
+{
+	history_event *evt;
+	int j;
+
+	if (!p_ptr) return;
+
+	if (p_ptr->inventory)
+	{
+		for (j = 0; j < INVEN_TOTAL; j++)
+		{
+			object_type *o_ptr = &p_ptr->inventory[j];
+
+			used[o_ptr->note] = used[o_ptr->owner_name] = used[o_ptr->origin_player] = TRUE;
+		}
+	}
+
+	for (evt = p_ptr->charhist; evt; evt = evt->next) used[evt->message] = TRUE;
+}
+
+/*
+ * Free every quark which is not referenced by anything in the game.
+ *
+ * Only the objects in "o_list[]", the stores, the players and
+ * the artifacts are checked, so this must not be called while a quark is
+ * held anywhere else (for example, by an object on the stack).  Freed
+ * indexes are handed out again by "quark_add()".
+ *
+ * Returns the number of quarks freed.
+ */
+int quark_compact(void)
+{
+	bool *used;
+	int i, j, num = 0;
+
+	C_MAKE(used, QUARK_MAX, bool);
+
+	/* Objects on the floor (and in houses) */
+	for (i = 1; i < o_max; i++)
+	{
+		object_type *o_ptr = &o_list[i];
+
+		if (!o_ptr->k_idx) continue;
+		used[o_ptr->note] = used[o_ptr->owner_name] = used[o_ptr->origin_player] = TRUE;
+	}
+
+	/* Objects in stores */
+	for (i = 0; i < MAX_STORES; i++)
+	{
+		for (j = 0; j < store[i].stock_num; j++)
+		{
+			object_type *o_ptr = &store[i].stock[j];
+
+			used[o_ptr->note] = used[o_ptr->owner_name] = used[o_ptr->origin_player] = TRUE;
+		}
+	}
+
+	/* Objects and history of every player in the game (link-dead ones
+	 * included, they have no connection but keep their slot) */
+	for (i = 1; i <= NumPlayers; i++) quark_mark_player(used, Players[i]);
+
+	/* And of those still logging in */
+	for (i = 0; i < players->num; i++) quark_mark_player(used, players->list[i]->data2);
+
+	/* Artifact owners */
+	for (i = 0; i < z_info->a_max; i++) used[a_info[i].owner_name] = TRUE;
+
+	/* Free the rest, and rebuild the hash index */
+	C_WIPE(quark__hash, QUARK_HASH, s16b);
+	quark__free_num = 0;
+	for (i = 1; i < quark__num; i++)
+	{
+		if (quark__str[i] && !used[i])
+		{
+			string_free(quark__str[i]);
+			quark__str[i] = NULL;
+			num++;
+		}
+
+		if (quark__str[i]) quark__hash[quark_slot(quark__str[i])] = i;
+	}
+
+	/* Hand out the lowest indexes first */
+	for (i = quark__num - 1; i >= 1; i--)
+	{
+		if (!quark__str[i]) quark__free[quark__free_num++] = i;
+	}
+
+	FREE(used);
+
+	return (num);
+}
+
+
 /*
  * This function looks up a quark
  */
@@ -1430,6 +1561,9 @@ cptr quark_str(s16b i)
 	/* Access the quark */
 	q = quark__str[i];
 
+	/* Freed by "quark_compact()" */
+	if (i && !q) q = "";
+
 	/* Return the quark */
 	return (q);
 }
@@ -2070,7 +2204,7 @@ void msg_format_monster(int m_idx, player_type *q_ptr, u16b type, cptr fmt_vis,
 		    !(m_ptr->closest_player == qq_ptr->Ind)) continue;
 
 		/* Can he see this monster? */
-		if (qq_ptr->mon_vis[m_idx])
+		if (bit_has(qq_ptr->mon_vis, m_idx))
 		{
 			/* Send "normal" message */
 			msg_print_aux(qq_ptr, buf_vis, type);
@@ -2094,7 +2228,9 @@ void msg_format_complex_far(player_type *p_ptr, player_type *q_ptr, u16b type, c
 {
 	va_list vp;
 
-	int Depth, y, x, i;
+	int Depth, y, x;
+
+	player_type *qq_ptr;
 
 	char buf[1024];
 	char buf_vis[1024];
@@ -2116,11 +2252,10 @@ void msg_format_complex_far(player_type *p_ptr, player_type *q_ptr, u16b type, c
 	y = p_ptr->py;
 	x = p_ptr->px;
 
-	/* Check each player */
-	for (i = 1; i <= NumPlayers; i++)
+	/* Check each player on this depth */
+	for (qq_ptr = player_roster(Depth); qq_ptr; qq_ptr = qq_ptr->roster_next)
 	{
-		/* Check this player */
-		player_type *qq_ptr = Players[i];
+		perf_fanout_players++;
 
 		/* Don't send the message to the player who caused it */
 		if (same_player(qq_ptr, p_ptr)) continue;
@@ -2128,9 +2263,6 @@ void msg_format_complex_far(player_type *p_ptr, player_type *q_ptr, u16b type, c
 		/* Don't send the message to the second ignoree */
 		if (same_player(qq_ptr, q_ptr)) continue;
 
-		/* Make sure this player is at this depth */
-		if (qq_ptr->dun_depth != Depth) continue;
-
 		/* Can he see this player? */
 		if (qq_ptr->cave_flag[y][x] & CAVE_VIEW)
 		{
@@ -2157,27 +2289,25 @@ void msg_format_complex_far(player_type *p_ptr, player_type *q_ptr, u16b type, c
  */
 void msg_print_complex_near(player_type *p_ptr, player_type *q_ptr, u16b type, cptr msg)
 {
-	int Depth, y, x, i;
+	int Depth, y, x;
+
+	player_type *qq_ptr;
 
 	/* Extract player's location */
 	Depth = p_ptr->dun_depth;
 	y = p_ptr->py;
 	x = p_ptr->px;
 
-	/* Check each player */
-	for (i = 1; i <= NumPlayers; i++)
+	/* Check each player on this depth */
+	for (qq_ptr = player_roster(Depth); qq_ptr; qq_ptr = qq_ptr->roster_next)
 	{
-		/* Check this player */
-		player_type *qq_ptr = Players[i];
+		perf_fanout_players++;
 
 		/* Don't send the message to the player who caused it */
 		if (same_player(qq_ptr, p_ptr)) continue;
 
 		/* Don't send the message to the second ignoree */
 		if (same_player(qq_ptr, q_ptr)) continue;
-		
-		/* Make sure this player is at this depth */
-		if (qq_ptr->dun_depth != Depth) continue;
 
 		/* Can he see this player? */
 		if (qq_ptr->cave_flag[y][x] & CAVE_VIEW)
@@ -3378,3 +3508,41 @@ bool ask_for(player_type *p_ptr, char query, char *buf)
 {
 	return askfor_aux(p_ptr, query, buf, 0, 0, "", "", TERM_DARK, TERM_WHITE);
 }
+
+
+/*
+ * Return the index of the first entry of an allocation table (which is
+ * sorted by level) whose level exceeds "level".
+ */
+int alloc_level_end(alloc_entry *table, int size, int level)
+{
+	int lo = 0, hi = size;
+
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (table[mid].level > level) hi = mid;
+		else lo = mid + 1;
+	}
+
+	return (lo);
+}
+
+/*
+ * Return the index of the first entry in "table[lo..hi)" whose running
+ * "total" exceeds "value".  This is the entry a linear walk, subtracting
+ * each probability from "value", would have stopped at.
+ */
+int alloc_pick(alloc_entry *table, int lo, int hi, u32b value)
+{
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+
+		if (table[mid].total > value) hi = mid;
+		else lo = mid + 1;
+	}
+
+	return (lo);
+}
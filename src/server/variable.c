@@ -155,17 +155,35 @@ bool scan_objects;		/* Hack -- optimize multi-hued code, etc */
 /*s16b inven_cnt;*/			/* Number of items in inventory */
 /*s16b equip_cnt;*/			/* Number of items in equipment */
 
-s32b o_nxt = 1;			/* Object free scanner */
-s32b m_nxt = 1;			/* Monster free scanner */
-
 s32b o_max = 1;			/* Object heap size */
 s32b m_max = 1;			/* Monster heap size */
 
-s32b o_top = 0;			/* Object top size */
-s32b m_top = 0;			/* Monster top size */
+s32b o_top = 0;			/* Number of live objects */
+s32b m_top = 0;			/* Number of live monsters */
+
+s32b o_free_num = 0;		/* Number of free object indexes */
+s32b m_free_num = 0;		/* Number of free monster indexes */
 
 s32b p_max = 0;			/* Player heap size */ 
 
+/*
+ * Work counters, reported (and reset) by the "debug" console command
+ */
+u32b perf_turns;		/* Game turns played */
+u32b perf_turn_usec;		/* Time spent in "dungeon()" */
+u32b perf_mon_process;		/* Monsters considered by "process_monsters()" */
+u32b perf_mon_updates;		/* Monsters refreshed by "update_monsters()" */
+u32b perf_obj_process;		/* Objects considered by "process_objects()" */
+u32b perf_lvl_checks;		/* Levels checked for deallocation */
+u32b perf_fanouts;		/* Calls which notify every player on a level */
+u32b perf_fanout_players;	/* Players looked at by those calls */
+u32b perf_fanout_scan;		/* Players a scan of "Players[]" would have looked at */
+u32b perf_bonus_hits;		/* "calc_bonuses()" calls skipped, nothing changed */
+u32b perf_bonus_partial;	/* "calc_bonuses()" calls which reused the equipment */
+u32b perf_bonus_misses;		/* "calc_bonuses()" calls which walked the equipment */
+u32b perf_path_queries;		/* Calls to "path_find()" */
+u32b perf_path_nodes;		/* Grids expanded by those */
+
 /*
  * Server options, set in mangband.cfg
  */
@@ -198,6 +216,9 @@ s16b cfg_max_townies = 100;
 s16b cfg_max_trees = 100;
 s16b cfg_max_houses = 0;
 bool cfg_chardump_color = FALSE;
+bool cfg_binary_saves = TRUE;
+bool cfg_snapshot_saves = TRUE;
+s16b cfg_compress_level = 0;
 s16b cfg_pvp_hostility = 2;
 bool cfg_pvp_notify = FALSE;
 s16b cfg_pvp_safehostility = 3;
@@ -365,6 +386,17 @@ s16b quark__num;
  */
 cptr *quark__str;
 
+/*
+ * The quark indexes, by hash of their string [QUARK_HASH]
+ */
+s16b *quark__hash;
+
+/*
+ * The unused quark indexes below "quark__num" [QUARK_MAX]
+ */
+s16b *quark__free;
+s16b quark__free_num;
+
 
 /*
  * The next "free" index to use
@@ -418,14 +450,46 @@ u32b window_mask[8];*/
 
 
 /*
- * The array of indexes of "live" objects
+ * The free object indexes below "o_max", see "o_pop()"
  */
-s16b o_fast[MAX_O_IDX];
+s16b o_free[MAX_O_IDX];
+u32b o_freed[BIT_WORDS(MAX_O_IDX)];
 
 /*
- * The array of indexes of "live" monsters
+ * The first "live" object on each level, see "link_object()"
  */
-s16b m_fast[MAX_M_IDX];
+s16b o_on_world[MAX_DEPTH + MAX_WILD];
+s16b *o_on_depth=&(o_on_world[MAX_WILD]);
+
+/*
+ * The free monster indexes below "m_max", see "m_pop()"
+ */
+s16b m_free[MAX_M_IDX];
+u32b m_freed[BIT_WORDS(MAX_M_IDX)];
+
+/*
+ * The first "live" monster on each level, see "link_monster()"
+ */
+s16b m_on_world[MAX_DEPTH + MAX_WILD];
+s16b *m_on_depth=&(m_on_world[MAX_WILD]);
+
+/*
+ * The number of "live" monsters on each level
+ */
+s16b m_num_world[MAX_DEPTH + MAX_WILD];
+s16b *m_num_depth=&(m_num_world[MAX_WILD]);
+
+/*
+ * The first player in the game on each level, see "player_roster_add()"
+ */
+player_type *p_on_world[MAX_DEPTH + MAX_WILD];
+player_type **p_on_depth=&(p_on_world[MAX_WILD]);
+
+/*
+ * Levels with players on them (sorted), see "update_active_depths()"
+ */
+s16b active_depths[MAX_PLAYERS];
+int num_active_depths;
 
 
 /*
@@ -439,6 +503,10 @@ s16b m_fast[MAX_M_IDX];
 */ 
 cave_type **world[MAX_DEPTH+MAX_WILD]; 
 cave_type ***cave = &world[MAX_WILD];
+
+/* Monster flow towards the players, on each level */
+flow_type *flow_world[MAX_DEPTH+MAX_WILD];
+flow_type **level_flow = &flow_world[MAX_WILD];
 wilderness_type world_info[MAX_WILD+1];
 wilderness_type *wild_info=&(world_info[MAX_WILD]);
 
@@ -1358,6 +1358,7 @@ static void wild_add_dwelling(int Depth, int x, int y)
 			houses[num_houses].door_x = door_x;
 			houses[num_houses].owned[0] = '\0';
 			num_houses++;
+			house_index_add(num_houses - 1);
 		}
 		else
 		{
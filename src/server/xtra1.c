@@ -1187,7 +1187,7 @@ static void cursor_redraw(player_type *p_ptr)
 		}
 
 		/* Tracking an unseen player */
-		else if (!p_ptr->play_vis[0 - p_ptr->cursor_who])
+		else if (!bit_has(p_ptr->play_vis, 0 - p_ptr->cursor_who))
 		{
 			/* Should not be possible */
 			vis = 0;
@@ -1210,7 +1210,7 @@ static void cursor_redraw(player_type *p_ptr)
 	}
 
 	/* Tracking an unseen monster */
-	else if (!p_ptr->mon_vis[p_ptr->cursor_who])
+	else if (!bit_has(p_ptr->mon_vis, p_ptr->cursor_who))
 	{
 		/* Reset cursor */
 		vis = 0;
@@ -1305,7 +1305,7 @@ static void health_redraw(player_type *p_ptr)
 		}
 
 		/* Tracking an unseen player */
-		else if (!p_ptr->play_vis[0 - p_ptr->health_who])
+		else if (!bit_has(p_ptr->play_vis, 0 - p_ptr->health_who))
 		{
 			/* Indicate that the player health is "unknown" */
 			attr = TERM_WHITE;
@@ -1352,7 +1352,7 @@ static void health_redraw(player_type *p_ptr)
 	}
 
 	/* Tracking an unseen monster */
-	else if (!p_ptr->mon_vis[p_ptr->health_who])
+	else if (!bit_has(p_ptr->mon_vis, p_ptr->health_who))
 	{
 		/* Indicate that the monster health is "unknown" */
 		attr = TERM_WHITE;
@@ -2126,6 +2126,269 @@ static int weight_limit(player_type *p_ptr)
 }
 
 
+/*
+ * Sum up what the worn equipment adds to the player.
+ *
+ * See "calc_bonuses()", which applies the result.
+ */
+static void calc_equip_bonus(player_type *p_ptr, player_equip_bonus *eb)
+{
+	int			i;
+
+	object_type		*o_ptr;
+	object_kind		*k_ptr;
+	ego_item_type 		*e_ptr;
+
+	u32b		f1, f2, f3;
+
+	/* Start from nothing */
+	WIPE(eb, player_equip_bonus);
+
+	/* Scan the usable inventory */
+	for (i = INVEN_WIELD; i < INVEN_TOTAL; i++)
+	{
+		o_ptr = &p_ptr->inventory[i];
+		k_ptr = &k_info[o_ptr->k_idx];
+		e_ptr = &e_info[o_ptr->name2];
+
+		/* Skip missing items */
+		if (!o_ptr->k_idx) continue;
+
+		/* Extract the item flags */
+        object_flags(o_ptr, &f1, &f2, &f3);
+
+		/* Hack -- first add any "base bonuses" of the item.  A new
+		 * feature in MAngband 0.7.0 is that the magnitude of the
+		 * base bonuses is stored in bpval instead of pval, making the
+		 * magnitude of "base bonuses" and "ego bonuses" independent 
+		 * from each other.
+		 * An example of an item that uses this independency is an
+		 * Orcish Shield of the Avari that gives +1 to STR and +3 to
+		 * CON. (base bonus from the shield +1 STR,CON, ego bonus from
+		 * the Avari +2 CON).  
+		 * Of course, the proper fix would be to redesign the object
+		 * type so that each of the ego bonuses has its own independent
+		 * parameter.
+		 */
+		/* NOTE: Randarts totally ignore "bpval"! */
+		/* If we have any base bonuses to add, add them */
+		if ((k_ptr->flags1 & TR1_PVAL_MASK) && !randart_p(o_ptr))
+		{
+			/* Affect stats */
+			if (k_ptr->flags1 & TR1_STR) eb->stat_add[A_STR] += o_ptr->bpval;
+			if (k_ptr->flags1 & TR1_INT) eb->stat_add[A_INT] += o_ptr->bpval;
+			if (k_ptr->flags1 & TR1_WIS) eb->stat_add[A_WIS] += o_ptr->bpval;
+			if (k_ptr->flags1 & TR1_DEX) eb->stat_add[A_DEX] += o_ptr->bpval;
+			if (k_ptr->flags1 & TR1_CON) eb->stat_add[A_CON] += o_ptr->bpval;
+			if (k_ptr->flags1 & TR1_CHR) eb->stat_add[A_CHR] += o_ptr->bpval;
+
+			/* Affect stealth */
+			if (k_ptr->flags1 & TR1_STEALTH) eb->skill_stl += o_ptr->bpval;
+
+			/* Affect searching ability (factor of five) */
+			if (k_ptr->flags1 & TR1_SEARCH) eb->skill_srh += (o_ptr->bpval * 5);
+
+			/* Affect searching frequency (factor of five) */
+			if (k_ptr->flags1 & TR1_SEARCH) eb->skill_fos += (o_ptr->bpval * 5);
+
+			/* Affect infravision */
+			if (k_ptr->flags1 & TR1_INFRA) eb->see_infra += o_ptr->bpval;
+
+			/* Affect digging (factor of 20) */
+			if (k_ptr->flags1 & TR1_TUNNEL) eb->skill_dig += (o_ptr->bpval * 20);
+
+			/* Affect speed */
+			if (k_ptr->flags1 & TR1_SPEED) eb->pspeed += o_ptr->bpval;
+
+			/* Affect blows */
+			if (k_ptr->flags1 & TR1_BLOWS) eb->extra_blows += o_ptr->bpval;
+		}
+
+		/* Next, add our ego bonuses */
+		/* Hack -- clear out any pval bonuses that are in the base item
+		 * bonus but not the ego bonus so we don't add them twice.
+		*/
+		if (o_ptr->name2)
+		{
+			f1 &= ~(k_ptr->flags1 & TR1_PVAL_MASK & ~e_ptr->flags1);
+		}
+
+
+		/* Affect stats */
+		if (f1 & TR1_STR) eb->stat_add[A_STR] += o_ptr->pval;
+		if (f1 & TR1_INT) eb->stat_add[A_INT] += o_ptr->pval;
+		if (f1 & TR1_WIS) eb->stat_add[A_WIS] += o_ptr->pval;
+		if (f1 & TR1_DEX) eb->stat_add[A_DEX] += o_ptr->pval;
+		if (f1 & TR1_CON) eb->stat_add[A_CON] += o_ptr->pval;
+		if (f1 & TR1_CHR) eb->stat_add[A_CHR] += o_ptr->pval;
+
+		/* Affect stealth */
+		if (f1 & TR1_STEALTH) eb->skill_stl += o_ptr->pval;
+
+		/* Affect searching ability (factor of five) */
+		if (f1 & TR1_SEARCH) eb->skill_srh += (o_ptr->pval * 5);
+
+		/* Affect searching frequency (factor of five) */
+		if (f1 & TR1_SEARCH) eb->skill_fos += (o_ptr->pval * 5);
+
+		/* Affect infravision */
+		if (f1 & TR1_INFRA) eb->see_infra += o_ptr->pval;
+
+		/* Affect digging (factor of 20) */
+		if (f1 & TR1_TUNNEL) eb->skill_dig += (o_ptr->pval * 20);
+
+		/* Affect speed */
+		if (f1 & TR1_SPEED) eb->pspeed += o_ptr->pval;
+
+		/* Affect blows */
+		if (f1 & TR1_BLOWS) eb->extra_blows += o_ptr->pval;
+
+		/* Boost shots */
+		if (f1 & TR1_SHOTS) eb->extra_shots++;
+
+		/* Count the lights */
+		if (f3 & TR3_LITE) eb->lite++;
+
+		/* Remember the flags */
+		eb->f1 |= f1;
+		eb->f2 |= f2;
+		eb->f3 |= f3;
+
+		/* Modify the base armor class */
+		eb->ac += o_ptr->ac;
+
+		/* The base armor class is always known */
+		eb->dis_ac += o_ptr->ac;
+
+		/* Apply the bonuses to armor class */
+		eb->to_a += o_ptr->to_a;
+
+		/* Apply the mental bonuses to armor class, if known */
+		if (object_known_p(p_ptr, o_ptr)) eb->dis_to_a += o_ptr->to_a;
+
+		/* Hack -- do not apply "weapon" bonuses */
+		if (i == INVEN_WIELD) continue;
+
+		/* Hack -- do not apply "bow" bonuses */
+		if (i == INVEN_BOW) continue;
+
+		/* Apply the bonuses to hit/damage */
+		eb->to_h += o_ptr->to_h;
+		eb->to_d += o_ptr->to_d;
+
+		/* Apply the mental bonuses tp hit/damage, if known */
+		if (object_known_p(p_ptr, o_ptr)) eb->dis_to_h += o_ptr->to_h;
+		if (object_known_p(p_ptr, o_ptr)) eb->dis_to_d += o_ptr->to_d;
+	}
+
+
+}
+
+
+/*
+ * Mix one value into a "calc_bonuses()" input hash.  The hash is made of
+ * two independent halves, so an old "state" is only reused by mistake if
+ * both of them collide at once.
+ */
+static void bonus_hash_mix(u32b *h, s32b v)
+{
+	h[0] ^= (u32b)v;
+	h[0] *= 0x01000193L;
+	h[0] ^= (h[0] >> 15);
+
+	h[1] += (u32b)v;
+	h[1] *= 0x5BD1E995L;
+	h[1] ^= (h[1] >> 13);
+}
+
+
+/*
+ * Hash everything about the worn equipment that "calc_equip_bonus()"
+ * looks at.
+ */
+static void calc_equip_hash(player_type *p_ptr, u32b *h)
+{
+	int i;
+
+	h[0] = 0x811C9DC5L;
+	h[1] = 0x9E3779B9L;
+
+	for (i = INVEN_WIELD; i < INVEN_TOTAL; i++)
+	{
+		object_type *o_ptr = &p_ptr->inventory[i];
+
+		bonus_hash_mix(h, o_ptr->k_idx);
+
+		/* Skip missing items */
+		if (!o_ptr->k_idx) continue;
+
+		bonus_hash_mix(h, (o_ptr->tval << 8) | o_ptr->sval);
+		bonus_hash_mix(h, o_ptr->bpval);
+		bonus_hash_mix(h, o_ptr->pval);
+		bonus_hash_mix(h, (o_ptr->name1 << 8) | o_ptr->name2);
+		bonus_hash_mix(h, o_ptr->name3);
+		bonus_hash_mix(h, (o_ptr->xtra1 << 8) | o_ptr->xtra2);
+		bonus_hash_mix(h, o_ptr->to_h);
+		bonus_hash_mix(h, o_ptr->to_d);
+		bonus_hash_mix(h, o_ptr->to_a);
+		bonus_hash_mix(h, o_ptr->ac);
+		bonus_hash_mix(h, o_ptr->weight);
+
+		/* The "displayed" bonuses depend on what the player knows */
+		bonus_hash_mix(h, object_known_p(p_ptr, o_ptr));
+	}
+
+	/* Zero means "never summed up" */
+	if (!h[0] && !h[1]) h[0] = 1;
+}
+
+
+/*
+ * Hash everything else "calc_bonuses()" looks at.  Timed effects
+ * only count by whether they are active, since that is all that
+ * matters to the bonuses.
+ */
+static void calc_bonus_hash(player_type *p_ptr, const u32b *equip_hash, u32b *h)
+{
+	int i;
+
+	h[0] = equip_hash[0];
+	h[1] = equip_hash[1];
+
+	bonus_hash_mix(h, (p_ptr->prace << 8) | p_ptr->pclass);
+	bonus_hash_mix(h, p_ptr->lev);
+	bonus_hash_mix(h, p_ptr->ghost);
+	bonus_hash_mix(h, p_ptr->fruit_bat);
+	bonus_hash_mix(h, p_ptr->maximize);
+	bonus_hash_mix(h, is_dm_p(p_ptr));
+	bonus_hash_mix(h, option_p(p_ptr,UNSETH_BONUS));
+
+	for (i = 0; i < A_MAX; i++)
+	{
+		bonus_hash_mix(h, p_ptr->stat_max[i]);
+		bonus_hash_mix(h, p_ptr->stat_cur[i]);
+	}
+
+	bonus_hash_mix(h, (p_ptr->stun > 50) ? 2 : (p_ptr->stun ? 1 : 0));
+	bonus_hash_mix(h,
+		(p_ptr->invuln ? 0x001 : 0) |
+		(p_ptr->blessed ? 0x002 : 0) |
+		(p_ptr->shield ? 0x004 : 0) |
+		(p_ptr->hero ? 0x008 : 0) |
+		(p_ptr->shero ? 0x010 : 0) |
+		(p_ptr->fast ? 0x020 : 0) |
+		(p_ptr->slow ? 0x040 : 0) |
+		(p_ptr->tim_invis ? 0x080 : 0) |
+		(p_ptr->tim_infra ? 0x100 : 0) |
+		((p_ptr->food >= PY_FOOD_MAX) ? 0x200 : 0) |
+		(p_ptr->searching ? 0x400 : 0));
+	bonus_hash_mix(h, p_ptr->total_weight);
+
+	/* Zero means "never calculated" */
+	if (!h[0] && !h[1]) h[0] = 1;
+}
+
+
 /*
  * Calculate the players current "state", taking into account
  * not only race/class intrinsics, but also objects being worn
@@ -2164,12 +2427,29 @@ static void calc_bonuses(player_type *p_ptr)
 	int			extra_blows;
 	int			extra_shots;
 
+	u32b		equip_hash[2], bonus_hash[2];
+
+	player_equip_bonus	*eb = &p_ptr->equip_bonus;
+
 	object_type		*o_ptr;
-	object_kind		*k_ptr;
-	ego_item_type 		*e_ptr;
 
 	u32b		f1, f2, f3;
 
+	/*** Check inputs ***/
+
+	/* Hash the equipment, and then everything else */
+	calc_equip_hash(p_ptr, equip_hash);
+	calc_bonus_hash(p_ptr, equip_hash, bonus_hash);
+
+	/* Nothing has changed, the old "state" is still good */
+	if ((bonus_hash[0] == p_ptr->bonus_hash[0]) && (bonus_hash[1] == p_ptr->bonus_hash[1]))
+	{
+		perf_bonus_hits++;
+		return;
+	}
+	p_ptr->bonus_hash[0] = bonus_hash[0];
+	p_ptr->bonus_hash[1] = bonus_hash[1];
+
 	/*** Memorize ***/
 
 	/* Save the old speed */
@@ -2387,189 +2667,95 @@ static void calc_bonuses(player_type *p_ptr)
 
 	/*** Analyze equipment ***/
 
-	/* Scan the usable inventory */
-	for (i = INVEN_WIELD; i < INVEN_TOTAL; i++)
-	{
-		o_ptr = &p_ptr->inventory[i];
-		k_ptr = &k_info[o_ptr->k_idx];
-		e_ptr = &e_info[o_ptr->name2];
-
-		/* Skip missing items */
-		if (!o_ptr->k_idx) continue;
-
-		/* Extract the item flags */
-        object_flags(o_ptr, &f1, &f2, &f3);
-
-		/* Hack -- first add any "base bonuses" of the item.  A new
-		 * feature in MAngband 0.7.0 is that the magnitude of the
-		 * base bonuses is stored in bpval instead of pval, making the
-		 * magnitude of "base bonuses" and "ego bonuses" independent 
-		 * from each other.
-		 * An example of an item that uses this independency is an
-		 * Orcish Shield of the Avari that gives +1 to STR and +3 to
-		 * CON. (base bonus from the shield +1 STR,CON, ego bonus from
-		 * the Avari +2 CON).  
-		 * Of course, the proper fix would be to redesign the object
-		 * type so that each of the ego bonuses has its own independent
-		 * parameter.
-		 */
-		/* NOTE: Randarts totally ignore "bpval"! */
-		/* If we have any base bonuses to add, add them */
-		if ((k_ptr->flags1 & TR1_PVAL_MASK) && !randart_p(o_ptr))
-		{
-			/* Affect stats */
-			if (k_ptr->flags1 & TR1_STR) p_ptr->stat_add[A_STR] += o_ptr->bpval;
-			if (k_ptr->flags1 & TR1_INT) p_ptr->stat_add[A_INT] += o_ptr->bpval;
-			if (k_ptr->flags1 & TR1_WIS) p_ptr->stat_add[A_WIS] += o_ptr->bpval;
-			if (k_ptr->flags1 & TR1_DEX) p_ptr->stat_add[A_DEX] += o_ptr->bpval;
-			if (k_ptr->flags1 & TR1_CON) p_ptr->stat_add[A_CON] += o_ptr->bpval;
-			if (k_ptr->flags1 & TR1_CHR) p_ptr->stat_add[A_CHR] += o_ptr->bpval;
-
-			/* Affect stealth */
-			if (k_ptr->flags1 & TR1_STEALTH) p_ptr->skill_stl += o_ptr->bpval;
-
-			/* Affect searching ability (factor of five) */
-			if (k_ptr->flags1 & TR1_SEARCH) p_ptr->skill_srh += (o_ptr->bpval * 5);
-
-			/* Affect searching frequency (factor of five) */
-			if (k_ptr->flags1 & TR1_SEARCH) p_ptr->skill_fos += (o_ptr->bpval * 5);
-
-			/* Affect infravision */
-			if (k_ptr->flags1 & TR1_INFRA) p_ptr->see_infra += o_ptr->bpval;
-
-			/* Affect digging (factor of 20) */
-			if (k_ptr->flags1 & TR1_TUNNEL) p_ptr->skill_dig += (o_ptr->bpval * 20);
-
-			/* Affect speed */
-			if (k_ptr->flags1 & TR1_SPEED) p_ptr->pspeed += o_ptr->bpval;
-
-			/* Affect blows */
-			if (k_ptr->flags1 & TR1_BLOWS) extra_blows += o_ptr->bpval;
-		}
-
-		/* Next, add our ego bonuses */
-		/* Hack -- clear out any pval bonuses that are in the base item
-		 * bonus but not the ego bonus so we don't add them twice.
-		*/
-		if (o_ptr->name2)
-		{
-			f1 &= ~(k_ptr->flags1 & TR1_PVAL_MASK & ~e_ptr->flags1);
-		}
-
-
-		/* Affect stats */
-		if (f1 & TR1_STR) p_ptr->stat_add[A_STR] += o_ptr->pval;
-		if (f1 & TR1_INT) p_ptr->stat_add[A_INT] += o_ptr->pval;
-		if (f1 & TR1_WIS) p_ptr->stat_add[A_WIS] += o_ptr->pval;
-		if (f1 & TR1_DEX) p_ptr->stat_add[A_DEX] += o_ptr->pval;
-		if (f1 & TR1_CON) p_ptr->stat_add[A_CON] += o_ptr->pval;
-		if (f1 & TR1_CHR) p_ptr->stat_add[A_CHR] += o_ptr->pval;
-
-		/* Affect stealth */
-		if (f1 & TR1_STEALTH) p_ptr->skill_stl += o_ptr->pval;
-
-		/* Affect searching ability (factor of five) */
-		if (f1 & TR1_SEARCH) p_ptr->skill_srh += (o_ptr->pval * 5);
-
-		/* Affect searching frequency (factor of five) */
-		if (f1 & TR1_SEARCH) p_ptr->skill_fos += (o_ptr->pval * 5);
-
-		/* Affect infravision */
-		if (f1 & TR1_INFRA) p_ptr->see_infra += o_ptr->pval;
-
-		/* Affect digging (factor of 20) */
-		if (f1 & TR1_TUNNEL) p_ptr->skill_dig += (o_ptr->pval * 20);
-
-		/* Affect speed */
-		if (f1 & TR1_SPEED) p_ptr->pspeed += o_ptr->pval;
-
-		/* Affect blows */
-		if (f1 & TR1_BLOWS) extra_blows += o_ptr->pval;
-
-		/* Hack -- cause earthquakes */
-		if (f3 & TR3_IMPACT) p_ptr->impact = TRUE;
-
-		/* Boost shots */
-		if (f1 & TR1_SHOTS) extra_shots++;
-
-		/* Various flags */
-		if (f3 & TR3_AGGRAVATE) p_ptr->aggravate = TRUE;
-		if (f3 & TR3_TELEPORT) p_ptr->teleport = TRUE;
-		if (f3 & TR3_DRAIN_EXP) p_ptr->exp_drain = TRUE;
-		if (f3 & TR3_BLESSED) p_ptr->bless_blade = TRUE;
-		if (f1 & TR1_MIGHT) p_ptr->xtra_might = TRUE;
-		if (f3 & TR3_SLOW_DIGEST) p_ptr->slow_digest = TRUE;
-		if (f3 & TR3_REGEN) p_ptr->regenerate = TRUE;
-		if (f3 & TR3_LITE) p_ptr->lite += 1;
-		if (f3 & TR3_SEE_INVIS) p_ptr->see_inv = TRUE;
-		if (f3 & TR3_FEATHER) p_ptr->feather_fall = TRUE;
-		if (f2 & TR2_RES_FEAR) p_ptr->resist_fear = TRUE;
-		if (f3 & TR3_FREE_ACT) p_ptr->free_act = TRUE;
-		if (f3 & TR3_HOLD_LIFE) p_ptr->hold_life = TRUE;
-
-		/* telepathy */
-		if (f3 & TR3_TELEPATHY)
-			p_ptr->telepathy = TR3_TELEPATHY;
-		else if (p_ptr->telepathy != TR3_TELEPATHY)
-			p_ptr->telepathy |= f3;
-
-		/* Immunity flags */
-		if (f2 & TR2_IM_FIRE) p_ptr->immune_fire = TRUE;
-		if (f2 & TR2_IM_ACID) p_ptr->immune_acid = TRUE;
-		if (f2 & TR2_IM_COLD) p_ptr->immune_cold = TRUE;
-		if (f2 & TR2_IM_ELEC) p_ptr->immune_elec = TRUE;
-
-		/* Resistance flags */
-		if (f2 & TR2_RES_ACID) p_ptr->resist_acid = TRUE;
-		if (f2 & TR2_RES_ELEC) p_ptr->resist_elec = TRUE;
-		if (f2 & TR2_RES_FIRE) p_ptr->resist_fire = TRUE;
-		if (f2 & TR2_RES_COLD) p_ptr->resist_cold = TRUE;
-		if (f2 & TR2_RES_POIS) p_ptr->resist_pois = TRUE;
-		if (f2 & TR2_RES_CONFU) p_ptr->resist_conf = TRUE;
-		if (f2 & TR2_RES_SOUND) p_ptr->resist_sound = TRUE;
-		if (f2 & TR2_RES_LITE) p_ptr->resist_lite = TRUE;
-		if (f2 & TR2_RES_DARK) p_ptr->resist_dark = TRUE;
-		if (f2 & TR2_RES_CHAOS) p_ptr->resist_chaos = TRUE;
-		if (f2 & TR2_RES_DISEN) p_ptr->resist_disen = TRUE;
-		if (f2 & TR2_RES_SHARD) p_ptr->resist_shard = TRUE;
-		if (f2 & TR2_RES_NEXUS) p_ptr->resist_nexus = TRUE;
-		if (f2 & TR2_RES_BLIND) p_ptr->resist_blind = TRUE;
-		if (f2 & TR2_RES_NETHR) p_ptr->resist_neth = TRUE;
-
-		/* Sustain flags */
-		if (f2 & TR2_SUST_STR) p_ptr->sustain_str = TRUE;
-		if (f2 & TR2_SUST_INT) p_ptr->sustain_int = TRUE;
-		if (f2 & TR2_SUST_WIS) p_ptr->sustain_wis = TRUE;
-		if (f2 & TR2_SUST_DEX) p_ptr->sustain_dex = TRUE;
-		if (f2 & TR2_SUST_CON) p_ptr->sustain_con = TRUE;
-		if (f2 & TR2_SUST_CHR) p_ptr->sustain_chr = TRUE;
-
-		/* Modify the base armor class */
-		p_ptr->ac += o_ptr->ac;
-
-		/* The base armor class is always known */
-		p_ptr->dis_ac += o_ptr->ac;
-
-		/* Apply the bonuses to armor class */
-		p_ptr->to_a += o_ptr->to_a;
-
-		/* Apply the mental bonuses to armor class, if known */
-		if (object_known_p(p_ptr, o_ptr)) p_ptr->dis_to_a += o_ptr->to_a;
-
-		/* Hack -- do not apply "weapon" bonuses */
-		if (i == INVEN_WIELD) continue;
+	/* Sum up the equipment, unless it is the same as last time */
+	if ((equip_hash[0] != p_ptr->equip_hash[0]) || (equip_hash[1] != p_ptr->equip_hash[1]))
+	{
+		calc_equip_bonus(p_ptr, eb);
+		p_ptr->equip_hash[0] = equip_hash[0];
+		p_ptr->equip_hash[1] = equip_hash[1];
+		perf_bonus_misses++;
+	}
+	else perf_bonus_partial++;
+
+	/* Affect stats */
+	for (i = 0; i < A_MAX; i++) p_ptr->stat_add[i] += eb->stat_add[i];
+
+	/* Affect skills, infravision and speed */
+	p_ptr->skill_stl += eb->skill_stl;
+	p_ptr->skill_srh += eb->skill_srh;
+	p_ptr->skill_fos += eb->skill_fos;
+	p_ptr->skill_dig += eb->skill_dig;
+	p_ptr->see_infra += eb->see_infra;
+	p_ptr->pspeed += eb->pspeed;
+
+	/* Affect blows and shots */
+	extra_blows = eb->extra_blows;
+	extra_shots = eb->extra_shots;
+
+	/* Hack -- cause earthquakes */
+	if (eb->f3 & TR3_IMPACT) p_ptr->impact = TRUE;
+
+	/* Various flags */
+	if (eb->f3 & TR3_AGGRAVATE) p_ptr->aggravate = TRUE;
+	if (eb->f3 & TR3_TELEPORT) p_ptr->teleport = TRUE;
+	if (eb->f3 & TR3_DRAIN_EXP) p_ptr->exp_drain = TRUE;
+	if (eb->f3 & TR3_BLESSED) p_ptr->bless_blade = TRUE;
+	if (eb->f1 & TR1_MIGHT) p_ptr->xtra_might = TRUE;
+	if (eb->f3 & TR3_SLOW_DIGEST) p_ptr->slow_digest = TRUE;
+	if (eb->f3 & TR3_REGEN) p_ptr->regenerate = TRUE;
+	p_ptr->lite += eb->lite;
+	if (eb->f3 & TR3_SEE_INVIS) p_ptr->see_inv = TRUE;
+	if (eb->f3 & TR3_FEATHER) p_ptr->feather_fall = TRUE;
+	if (eb->f2 & TR2_RES_FEAR) p_ptr->resist_fear = TRUE;
+	if (eb->f3 & TR3_FREE_ACT) p_ptr->free_act = TRUE;
+	if (eb->f3 & TR3_HOLD_LIFE) p_ptr->hold_life = TRUE;
+
+	/* telepathy */
+	if (eb->f3 & TR3_TELEPATHY)
+		p_ptr->telepathy = TR3_TELEPATHY;
+	else if (p_ptr->telepathy != TR3_TELEPATHY)
+		p_ptr->telepathy |= eb->f3;
 
-		/* Hack -- do not apply "bow" bonuses */
-		if (i == INVEN_BOW) continue;
+	/* Immunity flags */
+	if (eb->f2 & TR2_IM_FIRE) p_ptr->immune_fire = TRUE;
+	if (eb->f2 & TR2_IM_ACID) p_ptr->immune_acid = TRUE;
+	if (eb->f2 & TR2_IM_COLD) p_ptr->immune_cold = TRUE;
+	if (eb->f2 & TR2_IM_ELEC) p_ptr->immune_elec = TRUE;
 
-		/* Apply the bonuses to hit/damage */
-		p_ptr->to_h += o_ptr->to_h;
-		p_ptr->to_d += o_ptr->to_d;
+	/* Resistance flags */
+	if (eb->f2 & TR2_RES_ACID) p_ptr->resist_acid = TRUE;
+	if (eb->f2 & TR2_RES_ELEC) p_ptr->resist_elec = TRUE;
+	if (eb->f2 & TR2_RES_FIRE) p_ptr->resist_fire = TRUE;
+	if (eb->f2 & TR2_RES_COLD) p_ptr->resist_cold = TRUE;
+	if (eb->f2 & TR2_RES_POIS) p_ptr->resist_pois = TRUE;
+	if (eb->f2 & TR2_RES_CONFU) p_ptr->resist_conf = TRUE;
+	if (eb->f2 & TR2_RES_SOUND) p_ptr->resist_sound = TRUE;
+	if (eb->f2 & TR2_RES_LITE) p_ptr->resist_lite = TRUE;
+	if (eb->f2 & TR2_RES_DARK) p_ptr->resist_dark = TRUE;
+	if (eb->f2 & TR2_RES_CHAOS) p_ptr->resist_chaos = TRUE;
+	if (eb->f2 & TR2_RES_DISEN) p_ptr->resist_disen = TRUE;
+	if (eb->f2 & TR2_RES_SHARD) p_ptr->resist_shard = TRUE;
+	if (eb->f2 & TR2_RES_NEXUS) p_ptr->resist_nexus = TRUE;
+	if (eb->f2 & TR2_RES_BLIND) p_ptr->resist_blind = TRUE;
+	if (eb->f2 & TR2_RES_NETHR) p_ptr->resist_neth = TRUE;
 
-		/* Apply the mental bonuses tp hit/damage, if known */
-		if (object_known_p(p_ptr, o_ptr)) p_ptr->dis_to_h += o_ptr->to_h;
-		if (object_known_p(p_ptr, o_ptr)) p_ptr->dis_to_d += o_ptr->to_d;
-	}
+	/* Sustain flags */
+	if (eb->f2 & TR2_SUST_STR) p_ptr->sustain_str = TRUE;
+	if (eb->f2 & TR2_SUST_INT) p_ptr->sustain_int = TRUE;
+	if (eb->f2 & TR2_SUST_WIS) p_ptr->sustain_wis = TRUE;
+	if (eb->f2 & TR2_SUST_DEX) p_ptr->sustain_dex = TRUE;
+	if (eb->f2 & TR2_SUST_CON) p_ptr->sustain_con = TRUE;
+	if (eb->f2 & TR2_SUST_CHR) p_ptr->sustain_chr = TRUE;
+
+	/* Armor class and bonuses to hit/damage */
+	p_ptr->ac += eb->ac;
+	p_ptr->dis_ac += eb->dis_ac;
+	p_ptr->to_a += eb->to_a;
+	p_ptr->dis_to_a += eb->dis_to_a;
+	p_ptr->to_h += eb->to_h;
+	p_ptr->dis_to_h += eb->dis_to_h;
+	p_ptr->to_d += eb->to_d;
+	p_ptr->dis_to_d += eb->dis_to_d;
 
 
 	/*** Handle stats ***/
@@ -3218,7 +3404,7 @@ void update_stuff(player_type *p_ptr)
 	if (p_ptr->update & PU_FLOW)
 	{
 		p_ptr->update &= ~(PU_FLOW);
-		update_flow();
+		forget_flow(p_ptr->dun_depth);
 	}
 
 
@@ -3226,14 +3412,14 @@ void update_stuff(player_type *p_ptr)
 	{
 		p_ptr->update &= ~(PU_DISTANCE);
 		p_ptr->update &= ~(PU_MONSTERS);
-		update_monsters(TRUE);
+		update_monsters(p_ptr->dun_depth, TRUE);
 		update_players();
 	}
 
 	if (p_ptr->update & PU_MONSTERS)
 	{
 		p_ptr->update &= ~(PU_MONSTERS);
-		update_monsters(FALSE);
+		update_monsters(p_ptr->dun_depth, FALSE);
 		update_players();
 	}
 }
@@ -3572,4 +3758,7 @@ void handle_stuff(player_type *p_ptr)
 
 	/* Window stuff */
 	if (p_ptr->window) window_stuff(p_ptr);
+
+	/* Send the changed map grids */
+	stream_flush_tiles(p_ptr);
 }
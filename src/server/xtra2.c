@@ -2159,7 +2159,7 @@ void monster_death(player_type *p_ptr, int m_idx)
 		q_ptr = Players[i];
 		if (q_ptr->in_hack)
 		{
-			bool visible = (q_ptr->mon_vis[m_idx] || unique);
+			bool visible = (bit_has(q_ptr->mon_vis, m_idx) || unique);
 
 			/* Take note of the killer (message) */
 			if (unique && !same_player(q_ptr, p_ptr))
@@ -2616,12 +2616,9 @@ void player_funeral(player_type *p_ptr, char *reason)
 	int i;
 
 	/* Disown any houses he owns */
-	for(i=0; i< num_houses; i++)
+	for (i = next_house_owned(p_ptr, -1); i >= 0; i = next_house_owned(p_ptr, i))
 	{
-		if (house_owned_by(p_ptr, i))
-		{
-			disown_house(i);
-		}
+		disown_house(i);
 	}
 
 	/* Remove him from his party -APD- */
@@ -2938,7 +2935,7 @@ bool mon_take_hit(player_type *p_ptr, int m_idx, int dam, bool *fear, cptr note)
 	if (m_idx == 0) return TRUE;
 
 	/* Remember that he hurt it */
-	p_ptr->mon_hrt[m_idx] = TRUE;
+	bit_on(p_ptr->mon_hrt, m_idx);
 
 	/* Redraw (later) if needed */
 	update_health(m_idx);
@@ -2981,7 +2978,7 @@ bool mon_take_hit(player_type *p_ptr, int m_idx, int dam, bool *fear, cptr note)
 		}
 
 		/* Death by physical attack -- invisible monster */
-		else if (!p_ptr->mon_vis[m_idx])
+		else if (!bit_has(p_ptr->mon_vis, m_idx))
 		{
 			msg_format_near(p_ptr, "%s has killed %s.", p_ptr->name, m_name);
 			msg_format(p_ptr, "You have killed %s.", m_name);
@@ -3052,7 +3049,7 @@ bool mon_take_hit(player_type *p_ptr, int m_idx, int dam, bool *fear, cptr note)
 		//if (r_ptr->flags1 & RF1_UNIQUE) r_ptr->max_num = 0;
 
 		/* Recall even invisible uniques or winners */
-		if (p_ptr->mon_vis[m_idx] || (r_ptr->flags1 & RF1_UNIQUE))
+		if (bit_has(p_ptr->mon_vis, m_idx) || (r_ptr->flags1 & RF1_UNIQUE))
 		{
 			/* Count kills by all players */
 			if (r_ptr->r_tkills < MAX_SHORT) r_ptr->r_tkills++;
@@ -3544,7 +3541,7 @@ bool target_able(player_type *p_ptr, int m_idx)
 		m_ptr = &m_list[m_idx];
 
 		/* Monster must be visible */
-		if (!p_ptr->mon_vis[m_idx]) return (FALSE);
+		if (!bit_has(p_ptr->mon_vis, m_idx)) return (FALSE);
 
 		/* Monster must be projectable */
 		if (!projectable(p_ptr->dun_depth, p_ptr->py, p_ptr->px, m_ptr->fy, m_ptr->fx)) return (FALSE);
@@ -3829,21 +3826,21 @@ static bool target_set_interactive_accept(player_type *p_ptr, int y, int x)
 	if (c_ptr->m_idx < 0)
 	{
 		/* Visible monsters */
-		if (p_ptr->play_vis[0 - c_ptr->m_idx]) return (TRUE);
+		if (bit_has(p_ptr->play_vis, 0 - c_ptr->m_idx)) return (TRUE);
 	}
 	
 	/* Visible monsters */
 	if (c_ptr->m_idx > 0)
 	{
 		/* Visible monsters */
-		if (p_ptr->mon_vis[c_ptr->m_idx]) return (TRUE);
+		if (bit_has(p_ptr->mon_vis, c_ptr->m_idx)) return (TRUE);
 	}
 	
 	/* Objects */
 	if (c_ptr->o_idx)
 	{
 		/* Memorized object */
-		if (p_ptr->obj_vis[c_ptr->o_idx]) return (TRUE);	
+		if (bit_has(p_ptr->obj_vis, c_ptr->o_idx)) return (TRUE);	
 	}
 #if 0
 	/* Scan all objects in the grid */
@@ -4067,7 +4064,7 @@ static void target_set_interactive_aux(player_type *p_ptr, int y, int x, int mod
 	}
 
 	/* Visible player */
-	else if (m_idx < 0 && p_ptr->play_vis[0 - m_idx])
+	else if (m_idx < 0 && bit_has(p_ptr->play_vis, 0 - m_idx))
 	{
 		player_type *q_ptr = Players[0 - m_idx];
 	
@@ -4104,7 +4101,7 @@ static void target_set_interactive_aux(player_type *p_ptr, int y, int x, int mod
 	}
 
 	/* Visible monster */
-	else if (m_idx > 0 && p_ptr->mon_vis[m_idx])
+	else if (m_idx > 0 && bit_has(p_ptr->mon_vis, m_idx))
 	{
 		monster_type *m_ptr = &m_list[m_idx];
 		char m_name[80];
@@ -4140,7 +4137,7 @@ static void target_set_interactive_aux(player_type *p_ptr, int y, int x, int mod
 	}
 
 	/* Visible Object */
-	else if (o_idx > 0 && p_ptr->obj_vis[o_idx])
+	else if (o_idx > 0 && bit_has(p_ptr->obj_vis, o_idx))
 	{
 		object_type *o_ptr = &o_list[o_idx];
 		
@@ -5122,7 +5119,7 @@ bool monsters_in_los(player_type *p_ptr)
 	for (i = 1; i < m_max; i++)
 	{
 		/* Check this monster */
-		if ((p_ptr->mon_los[i] && !m_list[i].csleep))
+		if ((bit_has(p_ptr->mon_los, i) && !m_list[i].csleep))
 		{
 			los = TRUE;
 			break;
@@ -5137,7 +5134,7 @@ bool monsters_in_los(player_type *p_ptr)
 		if (p_ptr->conn <= -1) break; /* Can't check hostility */
 
 		/* Check this player */
-		if ((p_ptr->play_los[i]) && !q_ptr->paralyzed)
+		if ((bit_has(p_ptr->play_los, i)) && !q_ptr->paralyzed)
 		{
 			if (check_hostile(p_ptr, q_ptr))
 			{